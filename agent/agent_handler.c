@@ -566,6 +566,51 @@ netsnmp_call_handler(netsnmp_mib_handler *next_handler,
     return ret;
 }
 
+/*
+ * Counts a handler call and files its duration in the latency histogram
+ * of the registration (see netsnmp_handler_stats).
+ */
+static void
+_handler_stats_record(netsnmp_handler_registration *reginfo, int mode,
+                      const struct timeval *start, const struct timeval *end)
+{
+    netsnmp_handler_stats *stats = reginfo->stats;
+    u_long          usec;
+    int             kind, bucket;
+
+    switch (mode) {
+    case MODE_GET:
+        kind = NETSNMP_HANDLER_STATS_GET;
+        break;
+    case MODE_GETNEXT:
+        kind = NETSNMP_HANDLER_STATS_GETNEXT;
+        break;
+    case MODE_GETBULK:
+        kind = NETSNMP_HANDLER_STATS_GETBULK;
+        break;
+    default:
+        kind = NETSNMP_HANDLER_STATS_SET;
+        break;
+    }
+
+    if (!stats) {
+        stats = reginfo->stats = SNMP_MALLOC_TYPEDEF(netsnmp_handler_stats);
+        if (!stats)
+            return;
+    }
+
+    usec = (end->tv_sec - start->tv_sec) * 1000000 +
+        end->tv_usec - start->tv_usec;
+    for (bucket = 0; usec >> bucket &&
+         bucket < NETSNMP_HANDLER_STATS_BUCKETS - 1; bucket++)
+        ;
+
+    stats->calls[kind]++;
+    stats->buckets[kind][bucket]++;
+    if (usec > stats->max_usec[kind])
+        stats->max_usec[kind] = usec;
+}
+
 /** @private
  *  Calls all the MIB Handlers in registration struct for a given mode.
  *
@@ -577,6 +622,7 @@ netsnmp_call_handlers(netsnmp_handler_registration *reginfo,
                       netsnmp_request_info *requests)
 {
     netsnmp_request_info *request;
+    struct timeval  start, end;
     int             status;
 
     if (reginfo == NULL || reqinfo == NULL || requests == NULL) {
@@ -628,7 +674,15 @@ netsnmp_call_handlers(netsnmp_handler_registration *reginfo,
         request->processed = 0;
     }
 
+    if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_NO_HANDLER_STATS))
+        return netsnmp_call_handler(reginfo->handler, reginfo, reqinfo,
+                                    requests);
+
+    netsnmp_get_monotonic_clock(&start);
     status = netsnmp_call_handler(reginfo->handler, reginfo, reqinfo, requests);
+    netsnmp_get_monotonic_clock(&end);
+    _handler_stats_record(reginfo, reqinfo->mode, &start, &end);
 
     return status;
 }
@@ -786,6 +840,7 @@ netsnmp_handler_registration_free(netsnmp_handler_registration *reginfo)
         SNMP_FREE(reginfo->handlerName);
         SNMP_FREE(reginfo->contextName);
         SNMP_FREE(reginfo->rootoid);
+        SNMP_FREE(reginfo->stats);
         reginfo->rootoid_len = 0;
         SNMP_FREE(reginfo);
     }
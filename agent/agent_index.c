@@ -57,14 +57,224 @@ netsnmp_feature_child_of(remove_index, agent_index_all);
          * Initial support for index allocation
          */
 
+/*
+ * The indexes allocated under one OID are listed in value order, except
+ * that a generated string or OID index which wraps round goes at the end:
+ * new values are always generated from the last entry.  They are also
+ * indexed by value, and those released for reuse are kept apart in
+ * 'unused', so that no request has to walk the list.  The allocations of
+ * each session are threaded together, to be released when it closes.
+ */
 struct snmp_index {
     netsnmp_variable_list *varbind;     /* or pointer to var_list ? */
     int             allocated;
     netsnmp_session *session;
-    struct snmp_index *next_oid;
-    struct snmp_index *prev_oid;
+    struct snmp_index_oid *oid;         /* the OID it is allocated under */
     struct snmp_index *next_idx;
-}              *snmp_index_head = NULL;
+    struct snmp_index *prev_idx;
+    struct snmp_index *next_sess;       /* allocations by the same session */
+    struct snmp_index *prev_sess;
+};
+
+struct snmp_index_oid {
+    oid            *name;
+    size_t          name_length;
+    u_char          type;
+    struct snmp_index *first;
+    struct snmp_index *last;
+    netsnmp_container *values;          /* every entry, by value */
+    netsnmp_container *unused;          /* unallocated entries, by value */
+};
+
+struct snmp_index_session {
+    netsnmp_session *session;
+    struct snmp_index *first;
+};
+
+static netsnmp_container *snmp_index_oids;      /* snmp_index_oid by OID */
+static netsnmp_container *snmp_index_sessions;  /* snmp_index_session */
+
+static int
+_index_oid_compare(const void *lhs, const void *rhs)
+{
+    const struct snmp_index_oid *l = (const struct snmp_index_oid *) lhs;
+    const struct snmp_index_oid *r = (const struct snmp_index_oid *) rhs;
+
+    return snmp_oid_compare(l->name, l->name_length,
+                            r->name, r->name_length);
+}
+
+static int
+_index_value_compare(const void *lhs, const void *rhs)
+{
+    const netsnmp_variable_list *l = ((const struct snmp_index *) lhs)->varbind;
+    const netsnmp_variable_list *r = ((const struct snmp_index *) rhs)->varbind;
+    int             res;
+
+    switch (l->type) {
+    case ASN_INTEGER:
+        return (*l->val.integer > *r->val.integer) -
+            (*l->val.integer < *r->val.integer);
+    case ASN_OCTET_STR:
+        res = memcmp(l->val.string, r->val.string,
+                     SNMP_MIN(l->val_len, r->val_len));
+        if (res)
+            return res;
+        return (l->val_len > r->val_len) - (l->val_len < r->val_len);
+    case ASN_OBJECT_ID:
+        return snmp_oid_compare(l->val.objid, l->val_len / sizeof(oid),
+                                r->val.objid, r->val_len / sizeof(oid));
+    }
+    return 0;
+}
+
+static int
+_index_session_compare(const void *lhs, const void *rhs)
+{
+    const netsnmp_session *l = ((const struct snmp_index_session *) lhs)->session;
+    const netsnmp_session *r = ((const struct snmp_index_session *) rhs)->session;
+
+    return (l > r) - (l < r);
+}
+
+static u_int
+_index_session_hash(const void *data)
+{
+    const struct snmp_index_session *s =
+        (const struct snmp_index_session *) data;
+
+    return netsnmp_hash_mem(&s->session, sizeof(s->session), 0);
+}
+
+static struct snmp_index_oid *
+_index_find_oid(netsnmp_variable_list * varbind)
+{
+    struct snmp_index_oid probe;
+
+    if (NULL == snmp_index_oids)
+        return NULL;
+    probe.name = varbind->name;
+    probe.name_length = varbind->name_length;
+    return (struct snmp_index_oid *) CONTAINER_FIND(snmp_index_oids, &probe);
+}
+
+static struct snmp_index_oid *
+_index_new_oid(netsnmp_variable_list * varbind)
+{
+    struct snmp_index_oid *idxoid;
+
+    if (NULL == snmp_index_oids) {
+        snmp_index_oids = netsnmp_container_find("agent_index:binary_array");
+        if (NULL == snmp_index_oids)
+            return NULL;
+        snmp_index_oids->compare = _index_oid_compare;
+    }
+
+    idxoid = SNMP_MALLOC_STRUCT(snmp_index_oid);
+    if (NULL == idxoid)
+        return NULL;
+    idxoid->name = snmp_duplicate_objid(varbind->name, varbind->name_length);
+    idxoid->name_length = varbind->name_length;
+    idxoid->type = varbind->type;
+    idxoid->values = netsnmp_container_find("agent_index:table_container");
+    idxoid->unused = netsnmp_container_find("agent_index:table_container");
+    if (idxoid->values)
+        idxoid->values->compare = _index_value_compare;
+    if (idxoid->unused)
+        idxoid->unused->compare = _index_value_compare;
+    if (NULL == idxoid->name || NULL == idxoid->values ||
+        NULL == idxoid->unused ||
+        CONTAINER_INSERT(snmp_index_oids, idxoid) != 0) {
+        if (idxoid->values)
+            CONTAINER_FREE(idxoid->values);
+        if (idxoid->unused)
+            CONTAINER_FREE(idxoid->unused);
+        SNMP_FREE(idxoid->name);
+        free(idxoid);
+        return NULL;
+    }
+    return idxoid;
+}
+
+/*
+ * called once the last entry of an OID has gone
+ */
+static void
+_index_free_oid(struct snmp_index_oid *idxoid)
+{
+    CONTAINER_REMOVE(snmp_index_oids, idxoid);
+    CONTAINER_FREE(idxoid->values);
+    CONTAINER_FREE(idxoid->unused);
+    free(idxoid->name);
+    free(idxoid);
+}
+
+/*
+ * marks an entry as allocated to a session
+ */
+static int
+_index_claim(struct snmp_index *entry, netsnmp_session * ss)
+{
+    struct snmp_index_session *sess, probe;
+
+    if (NULL == snmp_index_sessions) {
+        snmp_index_sessions = netsnmp_container_find("agent_index:hash");
+        if (NULL == snmp_index_sessions)
+            return -1;
+        snmp_index_sessions->compare = _index_session_compare;
+        netsnmp_container_hash_set_func(snmp_index_sessions,
+                                        _index_session_hash);
+    }
+
+    probe.session = ss;
+    sess = (struct snmp_index_session *)
+        CONTAINER_FIND(snmp_index_sessions, &probe);
+    if (NULL == sess) {
+        sess = SNMP_MALLOC_STRUCT(snmp_index_session);
+        if (NULL == sess)
+            return -1;
+        sess->session = ss;
+        if (CONTAINER_INSERT(snmp_index_sessions, sess) != 0) {
+            free(sess);
+            return -1;
+        }
+    }
+
+    entry->allocated = 1;
+    entry->session = ss;
+    entry->prev_sess = NULL;
+    entry->next_sess = sess->first;
+    if (sess->first)
+        sess->first->prev_sess = entry;
+    sess->first = entry;
+    return 0;
+}
+
+/*
+ * undoes _index_claim(), leaving the entry unallocated
+ */
+static void
+_index_release(struct snmp_index *entry)
+{
+    struct snmp_index_session *sess, probe;
+
+    if (entry->prev_sess)
+        entry->prev_sess->next_sess = entry->next_sess;
+    else {
+        probe.session = entry->session;
+        sess = (struct snmp_index_session *)
+            CONTAINER_FIND(snmp_index_sessions, &probe);
+        if (sess && NULL == (sess->first = entry->next_sess)) {
+            CONTAINER_REMOVE(snmp_index_sessions, sess);
+            free(sess);
+        }
+    }
+    if (entry->next_sess)
+        entry->next_sess->prev_sess = entry->prev_sess;
+    entry->next_sess = entry->prev_sess = NULL;
+    entry->allocated = 0;
+    entry->session = NULL;
+}
 
 /*
  * The caller is responsible for free()ing the memory returned by
@@ -158,9 +368,10 @@ register_index(netsnmp_variable_list * varbind, int flags,
                netsnmp_session * ss)
 {
     netsnmp_variable_list *rv = NULL;
-    struct snmp_index *new_index, *idxptr, *idxptr2;
-    struct snmp_index *prev_oid_ptr, *prev_idx_ptr;
-    int             res, res2, i;
+    struct snmp_index *new_index, *entry, *prev_idx_ptr, *next_idx_ptr;
+    struct snmp_index_oid *idxoid;
+    struct snmp_index probe;
+    int             i;
 
     DEBUGMSGTL(("register_index", "register "));
     DEBUGMSGVAR(("register_index", varbind));
@@ -175,79 +386,56 @@ register_index(netsnmp_variable_list * varbind, int flags,
     /*
      * Look for the requested OID entry 
      */
-    prev_oid_ptr = NULL;
     prev_idx_ptr = NULL;
-    res = 1;
-    res2 = 1;
-    for (idxptr = snmp_index_head; idxptr != NULL;
-         prev_oid_ptr = idxptr, idxptr = idxptr->next_oid) {
-        if ((res = snmp_oid_compare(varbind->name, varbind->name_length,
-                                    idxptr->varbind->name,
-                                    idxptr->varbind->name_length)) <= 0)
-            break;
-    }
+    next_idx_ptr = NULL;
+    probe.varbind = varbind;
+    idxoid = _index_find_oid(varbind);
 
     /*
      * Found the OID - now look at the registered indices 
      */
-    if (res == 0 && idxptr) {
-        if (varbind->type != idxptr->varbind->type)
+    if (idxoid) {
+        if (varbind->type != idxoid->type)
             return NULL;        /* wrong type */
 
         /*
          * If we've been asked for an arbitrary new value,
-         *      then find the end of the list.
+         *      then use the end of the list.
          * If we've been asked for any arbitrary value,
-         *      then look for an unused entry, and use that.
+         *      then take an unused entry, if there is one.
          *      If there aren't any, continue as for new.
-         * Otherwise, locate the given value in the (sorted)
-         *      list of already allocated values
+         * Otherwise, look the given value up among the
+         *      already allocated values
          */
         if (flags & ALLOCATE_ANY_INDEX) {
-            for (idxptr2 = idxptr; idxptr2 != NULL;
-                 prev_idx_ptr = idxptr2, idxptr2 = idxptr2->next_idx) {
-
-                if (flags == ALLOCATE_ANY_INDEX && !(idxptr2->allocated)) {
-                    if ((rv =
-                         snmp_clone_varbind(idxptr2->varbind)) != NULL) {
-                        idxptr2->session = ss;
-                        idxptr2->allocated = 1;
+            entry = NULL;
+            if (flags == ALLOCATE_ANY_INDEX)
+                entry = (struct snmp_index *) CONTAINER_FIRST(idxoid->unused);
+            if (entry) {
+                if ((rv = snmp_clone_varbind(entry->varbind)) != NULL) {
+                    CONTAINER_REMOVE(idxoid->unused, entry);
+                    if (_index_claim(entry, ss) != 0) {
+                        CONTAINER_INSERT(idxoid->unused, entry);
+                        snmp_free_varbind(rv);
+                        rv = NULL;
                     }
-                    return rv;
                 }
+                return rv;
             }
+            prev_idx_ptr = idxoid->last;
         } else {
-            for (idxptr2 = idxptr; idxptr2 != NULL;
-                 prev_idx_ptr = idxptr2, idxptr2 = idxptr2->next_idx) {
-                switch (varbind->type) {
-                case ASN_INTEGER:
-                    res2 =
-                        (*varbind->val.integer -
-                         *idxptr2->varbind->val.integer);
-                    break;
-                case ASN_OCTET_STR:
-                    i = SNMP_MIN(varbind->val_len,
-                                 idxptr2->varbind->val_len);
-                    res2 =
-                        memcmp(varbind->val.string,
-                               idxptr2->varbind->val.string, i);
-                    break;
-                case ASN_OBJECT_ID:
-                    res2 =
-                        snmp_oid_compare(varbind->val.objid,
-                                         varbind->val_len / sizeof(oid),
-                                         idxptr2->varbind->val.objid,
-                                         idxptr2->varbind->val_len /
-                                         sizeof(oid));
-                    break;
-                default:
-                    return NULL;        /* wrong type */
-                }
-                if (res2 <= 0)
-                    break;
+            switch (varbind->type) {
+            case ASN_INTEGER:
+            case ASN_OCTET_STR:
+            case ASN_OBJECT_ID:
+                break;
+            default:
+                return NULL;    /* wrong type */
             }
-            if (res2 == 0) {
-                if (idxptr2->allocated) {
+            entry = (struct snmp_index *) CONTAINER_FIND(idxoid->values,
+                                                         &probe);
+            if (entry) {
+                if (entry->allocated) {
                     /*
                      * No good: the index is in use.  
                      */
@@ -257,27 +445,33 @@ register_index(netsnmp_variable_list * varbind, int flags,
                      * Okay, it's unallocated, we can just claim ownership
                      * here.  
                      */
-                    if ((rv =
-                         snmp_clone_varbind(idxptr2->varbind)) != NULL) {
-                        idxptr2->session = ss;
-                        idxptr2->allocated = 1;
+                    if ((rv = snmp_clone_varbind(entry->varbind)) != NULL) {
+                        CONTAINER_REMOVE(idxoid->unused, entry);
+                        if (_index_claim(entry, ss) != 0) {
+                            CONTAINER_INSERT(idxoid->unused, entry);
+                            snmp_free_varbind(rv);
+                            rv = NULL;
+                        }
                     }
                     return rv;
                 }
             }
+            /*
+             * a new value goes in front of the next larger one
+             */
+            next_idx_ptr = (struct snmp_index *)
+                CONTAINER_NEXT(idxoid->values, &probe);
+            prev_idx_ptr = next_idx_ptr ? next_idx_ptr->prev_idx :
+                idxoid->last;
         }
     }
 
     /*
      * OK - we've now located where the new entry needs to
-     *      be fitted into the index registry tree          
+     *      be fitted into the index registry.
      * To recap:
-     *      'prev_oid_ptr' points to the head of the OID index
-     *          list prior to this one.  If this is null, then
-     *          it means that this is the first OID in the list.
-     *      'idxptr' points either to the head of this OID list,
-     *          or the next OID (if this is a new OID request)
-     *          These can be distinguished by the value of 'res'.
+     *      'idxoid' holds the entries for the requested OID,
+     *          or is NULL if this is a new OID request.
      *
      *      'prev_idx_ptr' points to the index entry that sorts
      *          immediately prior to the requested value (if any).
@@ -286,12 +480,7 @@ register_index(netsnmp_variable_list * varbind, int flags,
      *          If this pointer is null, then either this is a new
      *          OID request, or the requested value is the first
      *          in the list.
-     *      'idxptr2' points to the next sorted index (if any)
-     *          but is not actually needed any more.
-     *
-     *  Clear?  Good!
-     *      I hope you've been paying attention.
-     *          There'll be a test later :-)
+     *      'next_idx_ptr' points to the next sorted index (if any).
      */
 
     /*
@@ -314,8 +503,6 @@ register_index(netsnmp_variable_list * varbind, int flags,
         free(new_index);
         return NULL;
     }
-    new_index->session = ss;
-    new_index->allocated = 1;
 
     if (varbind->type == ASN_OCTET_STR && flags == ALLOCATE_THIS_INDEX)
         new_index->varbind->val.string[new_index->varbind->val_len] = 0;
@@ -422,32 +609,39 @@ register_index(netsnmp_variable_list * varbind, int flags,
 
     /*
      * Right - we've set up the new entry.
-     * All that remains is to link it into the tree.
-     * There are a number of possible cases here,
-     *   so watch carefully.
+     * All that remains is to index it and link it into the list,
+     *   which may be the first for this OID.
      */
-    if (prev_idx_ptr) {
-        new_index->next_idx = prev_idx_ptr->next_idx;
-        new_index->next_oid = prev_idx_ptr->next_oid;
-        prev_idx_ptr->next_idx = new_index;
-    } else {
-        if (res == 0 && idxptr) {
-            new_index->next_idx = idxptr;
-            new_index->next_oid = idxptr->next_oid;
-        } else {
-            new_index->next_idx = NULL;
-            new_index->next_oid = idxptr;
-        }
-
-        if (prev_oid_ptr) {
-            while (prev_oid_ptr) {
-                prev_oid_ptr->next_oid = new_index;
-                prev_oid_ptr = prev_oid_ptr->next_idx;
-            }
-        } else
-            snmp_index_head = new_index;
+    if (NULL == idxoid && NULL == (idxoid = _index_new_oid(varbind)))
+        goto fail;
+    new_index->oid = idxoid;
+    if (CONTAINER_INSERT(idxoid->values, new_index) != 0)
+        goto fail;      /* a generated value which wrapped round */
+    if (_index_claim(new_index, ss) != 0) {
+        CONTAINER_REMOVE(idxoid->values, new_index);
+        goto fail;
     }
+
+    new_index->prev_idx = prev_idx_ptr;
+    new_index->next_idx = prev_idx_ptr ? prev_idx_ptr->next_idx :
+        idxoid->first;
+    if (new_index->prev_idx)
+        new_index->prev_idx->next_idx = new_index;
+    else
+        idxoid->first = new_index;
+    if (new_index->next_idx)
+        new_index->next_idx->prev_idx = new_index;
+    else
+        idxoid->last = new_index;
     return rv;
+
+  fail:
+    if (idxoid && NULL == idxoid->first)
+        _index_free_oid(idxoid);
+    snmp_free_varbind(rv);
+    snmp_free_var(new_index->varbind);
+    free(new_index);
+    return NULL;
 }
 
         /*
@@ -478,15 +672,25 @@ remove_index(netsnmp_variable_list * varbind, netsnmp_session * ss)
 void
 unregister_index_by_session(netsnmp_session * ss)
 {
-    struct snmp_index *idxptr, *idxptr2;
-    for (idxptr = snmp_index_head; idxptr != NULL;
-         idxptr = idxptr->next_oid)
-        for (idxptr2 = idxptr; idxptr2 != NULL;
-             idxptr2 = idxptr2->next_idx)
-            if (idxptr2->session == ss) {
-                idxptr2->allocated = 0;
-                idxptr2->session = NULL;
-            }
+    struct snmp_index_session *sess, probe;
+    struct snmp_index *idxptr, *next;
+
+    if (NULL == snmp_index_sessions)
+        return;
+    probe.session = ss;
+    sess = (struct snmp_index_session *)
+        CONTAINER_FIND(snmp_index_sessions, &probe);
+    if (NULL == sess)
+        return;
+    CONTAINER_REMOVE(snmp_index_sessions, sess);
+    for (idxptr = sess->first; idxptr != NULL; idxptr = next) {
+        next = idxptr->next_sess;
+        idxptr->next_sess = idxptr->prev_sess = NULL;
+        idxptr->allocated = 0;
+        idxptr->session = NULL;
+        CONTAINER_INSERT(idxptr->oid->unused, idxptr);
+    }
+    free(sess);
 }
 
 
@@ -494,9 +698,8 @@ int
 unregister_index(netsnmp_variable_list * varbind, int remember,
                  netsnmp_session * ss)
 {
-    struct snmp_index *idxptr, *idxptr2;
-    struct snmp_index *prev_oid_ptr, *prev_idx_ptr;
-    int             res, res2, i;
+    struct snmp_index_oid *idxoid;
+    struct snmp_index *idxptr2, probe;
 
 #if defined(USING_AGENTX_SUBAGENT_MODULE) && !defined(TESTING)
     if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID, 
@@ -507,58 +710,30 @@ unregister_index(netsnmp_variable_list * varbind, int remember,
     /*
      * Look for the requested OID entry 
      */
-    prev_oid_ptr = NULL;
-    prev_idx_ptr = NULL;
-    res = 1;
-    res2 = 1;
-    for (idxptr = snmp_index_head; idxptr != NULL;
-         prev_oid_ptr = idxptr, idxptr = idxptr->next_oid) {
-        if ((res = snmp_oid_compare(varbind->name, varbind->name_length,
-                                    idxptr->varbind->name,
-                                    idxptr->varbind->name_length)) <= 0)
-            break;
-    }
-
-    if (res != 0)
+    idxoid = _index_find_oid(varbind);
+    if (NULL == idxoid)
         return INDEX_ERR_NOT_ALLOCATED;
-    if (varbind->type != idxptr->varbind->type)
+    if (varbind->type != idxoid->type)
         return INDEX_ERR_WRONG_TYPE;
 
-    for (idxptr2 = idxptr; idxptr2 != NULL;
-         prev_idx_ptr = idxptr2, idxptr2 = idxptr2->next_idx) {
-        switch (varbind->type) {
-        case ASN_INTEGER:
-            res2 =
-                (*varbind->val.integer -
-                 *idxptr2->varbind->val.integer);
-            break;
-        case ASN_OCTET_STR:
-            i = SNMP_MIN(varbind->val_len,
-                         idxptr2->varbind->val_len);
-            res2 =
-                memcmp(varbind->val.string,
-                       idxptr2->varbind->val.string, i);
-            break;
-        case ASN_OBJECT_ID:
-            res2 =
-                snmp_oid_compare(varbind->val.objid,
-                                 varbind->val_len / sizeof(oid),
-                                 idxptr2->varbind->val.objid,
-                                 idxptr2->varbind->val_len /
-                                 sizeof(oid));
-            break;
-        default:
-            return INDEX_ERR_WRONG_TYPE;        /* wrong type */
-        }
-        if (res2 <= 0)
-            break;
+    switch (varbind->type) {
+    case ASN_INTEGER:
+    case ASN_OCTET_STR:
+    case ASN_OBJECT_ID:
+        break;
+    default:
+        return INDEX_ERR_WRONG_TYPE;        /* wrong type */
     }
-    if (res2 != 0 || (res2 == 0 && !idxptr2->allocated)) {
+    probe.varbind = varbind;
+    idxptr2 = (struct snmp_index *) CONTAINER_FIND(idxoid->values, &probe);
+    if (NULL == idxptr2 || !idxptr2->allocated) {
         return INDEX_ERR_NOT_ALLOCATED;
     }
     if (ss != idxptr2->session)
         return INDEX_ERR_WRONG_SESSION;
 
+    _index_release(idxptr2);
+
     /*
      *  If this is a "normal" index unregistration,
      *      mark the index entry as unused, but leave
@@ -566,8 +741,7 @@ unregister_index(netsnmp_variable_list * varbind, int remember,
      *      between ANY_INDEX and NEW_INDEX
      */
     if (remember) {
-        idxptr2->allocated = 0; /* Unused index */
-        idxptr2->session = NULL;
+        CONTAINER_INSERT(idxoid->unused, idxptr2);
         return SNMP_ERR_NOERROR;
     }
     /*
@@ -575,23 +749,17 @@ unregister_index(netsnmp_variable_list * varbind, int remember,
      *      number of indexes, the successful ones
      *      must be removed completely.
      */
-    if (prev_idx_ptr) {
-        prev_idx_ptr->next_idx = idxptr2->next_idx;
-    } else if (prev_oid_ptr) {
-        if (idxptr2->next_idx)  /* Use p_idx_ptr as a temp variable */
-            prev_idx_ptr = idxptr2->next_idx;
-        else
-            prev_idx_ptr = idxptr2->next_oid;
-        while (prev_oid_ptr) {
-            prev_oid_ptr->next_oid = prev_idx_ptr;
-            prev_oid_ptr = prev_oid_ptr->next_idx;
-        }
-    } else {
-        if (idxptr2->next_idx)
-            snmp_index_head = idxptr2->next_idx;
-        else
-            snmp_index_head = idxptr2->next_oid;
-    }
+    CONTAINER_REMOVE(idxoid->values, idxptr2);
+    if (idxptr2->prev_idx)
+        idxptr2->prev_idx->next_idx = idxptr2->next_idx;
+    else
+        idxoid->first = idxptr2->next_idx;
+    if (idxptr2->next_idx)
+        idxptr2->next_idx->prev_idx = idxptr2->prev_idx;
+    else
+        idxoid->last = idxptr2->prev_idx;
+    if (NULL == idxoid->first)
+        _index_free_oid(idxoid);
     snmp_free_var(idxptr2->varbind);
     free(idxptr2);
     return SNMP_ERR_NOERROR;
@@ -640,59 +808,51 @@ unregister_oid_index(oid * name, size_t name_len,
 }
 #endif /* NETSNMP_FEATURE_REMOVE_UNREGISTER_INDEXES */
 
-void
-dump_idx_registry(void)
+static void
+_dump_idx_oid(void *data, void *context)
 {
-    struct snmp_index *idxptr, *idxptr2;
+    struct snmp_index_oid *idxoid = (struct snmp_index_oid *) data;
+    struct snmp_index *idxptr2;
     u_char         *sbuf = NULL, *ebuf = NULL;
     size_t          sbuf_len = 0, sout_len = 0, ebuf_len = 0, eout_len = 0;
 
-    if (snmp_index_head != NULL) {
-        printf("\nIndex Allocations:\n");
+    if (sprint_realloc_objid(&sbuf, &sbuf_len, &sout_len, 1,
+                             idxoid->name, idxoid->name_length)) {
+        printf("%s indexes:\n", sbuf);
+    } else {
+        printf("%s [TRUNCATED] indexes:\n", sbuf);
     }
 
-    for (idxptr = snmp_index_head; idxptr != NULL;
-         idxptr = idxptr->next_oid) {
-        sout_len = 0;
-        if (sprint_realloc_objid(&sbuf, &sbuf_len, &sout_len, 1,
-                                 idxptr->varbind->name,
-                                 idxptr->varbind->name_length)) {
-            printf("%s indexes:\n", sbuf);
-        } else {
-            printf("%s [TRUNCATED] indexes:\n", sbuf);
-        }
-
-        for (idxptr2 = idxptr; idxptr2 != NULL;
-             idxptr2 = idxptr2->next_idx) {
-            switch (idxptr2->varbind->type) {
-            case ASN_INTEGER:
-                printf("    %ld for session %8p, allocated %d\n",
-                       *idxptr2->varbind->val.integer, idxptr2->session,
-                       idxptr2->allocated);
-                break;
-            case ASN_OCTET_STR:
-                printf("    \"%s\" for session %8p, allocated %d\n",
-                       idxptr2->varbind->val.string, idxptr2->session,
-                       idxptr2->allocated);
-                break;
-            case ASN_OBJECT_ID:
-                eout_len = 0;
-                if (sprint_realloc_objid(&ebuf, &ebuf_len, &eout_len, 1,
-                                         idxptr2->varbind->val.objid,
-                                         idxptr2->varbind->val_len /
-                                         sizeof(oid))) {
-                    printf("    %s for session %8p, allocated %d\n", ebuf,
-                           idxptr2->session, idxptr2->allocated);
-                } else {
-                    printf
-                        ("    %s [TRUNCATED] for sess %8p, allocated %d\n",
-                         ebuf, idxptr2->session, idxptr2->allocated);
-                }
-                break;
-            default:
-                printf("unsupported type (%d/0x%02x)\n",
-                       idxptr2->varbind->type, idxptr2->varbind->type);
+    for (idxptr2 = idxoid->first; idxptr2 != NULL;
+         idxptr2 = idxptr2->next_idx) {
+        switch (idxptr2->varbind->type) {
+        case ASN_INTEGER:
+            printf("    %ld for session %8p, allocated %d\n",
+                   *idxptr2->varbind->val.integer, idxptr2->session,
+                   idxptr2->allocated);
+            break;
+        case ASN_OCTET_STR:
+            printf("    \"%s\" for session %8p, allocated %d\n",
+                   idxptr2->varbind->val.string, idxptr2->session,
+                   idxptr2->allocated);
+            break;
+        case ASN_OBJECT_ID:
+            eout_len = 0;
+            if (sprint_realloc_objid(&ebuf, &ebuf_len, &eout_len, 1,
+                                     idxptr2->varbind->val.objid,
+                                     idxptr2->varbind->val_len /
+                                     sizeof(oid))) {
+                printf("    %s for session %8p, allocated %d\n", ebuf,
+                       idxptr2->session, idxptr2->allocated);
+            } else {
+                printf
+                    ("    %s [TRUNCATED] for sess %8p, allocated %d\n",
+                     ebuf, idxptr2->session, idxptr2->allocated);
             }
+            break;
+        default:
+            printf("unsupported type (%d/0x%02x)\n",
+                   idxptr2->varbind->type, idxptr2->varbind->type);
         }
     }
 
@@ -704,24 +864,33 @@ dump_idx_registry(void)
     }
 }
 
+void
+dump_idx_registry(void)
+{
+    if (snmp_index_oids != NULL && CONTAINER_SIZE(snmp_index_oids) > 0) {
+        printf("\nIndex Allocations:\n");
+        CONTAINER_FOR_EACH(snmp_index_oids, _dump_idx_oid, NULL);
+    }
+}
+
 netsnmp_feature_child_of(count_indexes, netsnmp_unused);
 #ifndef NETSNMP_FEATURE_REMOVE_UNUSED
 unsigned long
 count_indexes(oid * name, size_t namelen, int include_unallocated)
 {
-    struct snmp_index *i = NULL, *j = NULL;
+    struct snmp_index_oid *idxoid, probe;
     unsigned long   n = 0;
 
-    for (i = snmp_index_head; i != NULL; i = i->next_oid) {
-        if (netsnmp_oid_equals(name, namelen,
-                             i->varbind->name,
-                             i->varbind->name_length) == 0) {
-            for (j = i; j != NULL; j = j->next_idx) {
-                if (j->allocated || include_unallocated) {
-                    n++;
-                }
-            }
-        }
+    if (NULL == snmp_index_oids)
+        return 0;
+    probe.name = name;
+    probe.name_length = namelen;
+    idxoid = (struct snmp_index_oid *) CONTAINER_FIND(snmp_index_oids,
+                                                      &probe);
+    if (idxoid) {
+        n = CONTAINER_SIZE(idxoid->values);
+        if (!include_unallocated)
+            n -= CONTAINER_SIZE(idxoid->unused);
     }
     return n;
 }
@@ -281,6 +281,18 @@ init_agent_read_config(const char *app)
     netsnmp_ds_register_config(ASN_BOOLEAN, app, "dontLogTCPWrappersConnects",
                                NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_DONT_LOG_TCPWRAPPERS_CONNECTS);
+    netsnmp_ds_register_config(ASN_BOOLEAN, app, "disableTableBulk",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_NO_TABLE_BULK);
+    netsnmp_ds_register_config(ASN_BOOLEAN, app, "disableHandlerStats",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_NO_HANDLER_STATS);
+    netsnmp_ds_register_config(ASN_BOOLEAN, app, "lazyInit",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_INIT);
+    netsnmp_ds_register_config(ASN_INTEGER, app, "lazyInitPrewarm",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_PREWARM);
     netsnmp_ds_register_config(ASN_INTEGER, app, "maxGetbulkRepeats",
                                NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_MAX_GETBULKREPEATS);
@@ -290,6 +302,9 @@ init_agent_read_config(const char *app)
     netsnmp_ds_register_config(ASN_INTEGER, app, "avgBulkVarbindSize",
                                NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_AVG_BULKVARBINDSIZE);
+    register_app_config_handler("responseMemo",
+                                netsnmp_response_memo_parse,
+                                netsnmp_response_memo_free, "OID SECONDS");
 #ifndef NETSNMP_NO_PDU_STATS
     netsnmp_ds_register_config(ASN_INTEGER, app, "pduStatsMax",
                                NETSNMP_DS_APPLICATION_ID,
@@ -298,6 +313,11 @@ init_agent_read_config(const char *app)
                                NETSNMP_DS_APPLICATION_ID,
                                NETSNMP_DS_AGENT_PDU_STATS_THRESHOLD);
 #endif /* NETSNMP_NO_PDU_STATS */
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+    netsnmp_ds_register_config(ASN_INTEGER, app, "agentThreads",
+                               NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_THREADS);
+#endif /* NETSNMP_REENTRANT && HAVE_PTHREAD_H */
 
     netsnmp_init_handler_conf();
 
@@ -77,8 +77,10 @@ netsnmp_feature_child_of(agent_registry_all, libnetsnmpagent);
 
 netsnmp_feature_child_of(unregister_mib_table_row, agent_registry_all);
 
-/** @defgroup agent_lookup_cache Lookup cache, storing the registered OIDs.
- *     Maintain the cache used for locating sub-trees and OIDs.
+/** @defgroup agent_lookup_cache Lookup index, locating the registered OIDs.
+ *     Maintain a sorted index of each context's subtree list, so that
+ *     locating the subtree for an OID is a binary search rather than a
+ *     walk along the list.
  *   @ingroup agent_registry
  *
  * @{
@@ -90,33 +92,39 @@ netsnmp_feature_child_of(unregister_mib_table_row, agent_registry_all);
 #define SUBTREE_MAX_CACHE_SIZE     32
 int lookup_cache_size = 0; /*enabled later after registrations are loaded */
 
-typedef struct lookup_cache_s {
-   netsnmp_subtree *next;
-   netsnmp_subtree *previous;
-} lookup_cache;
-
 typedef struct lookup_cache_context_s {
    char *context;
    struct lookup_cache_context_s *next;
-   int thecachecount;
-   int currentpos;
-   lookup_cache cache[SUBTREE_MAX_CACHE_SIZE];
+   netsnmp_subtree **subtrees;  /* the subtree list, in order */
+   size_t count;
+   size_t size;
+   u_int generation;            /* of the list the index was built from */
 } lookup_cache_context;
 
 static lookup_cache_context *thecontextcache = NULL;
 
-/** Set the lookup cache size for optimized agent registration performance.
- * Note that it is only used by master agent - sub-agent doesn't need the cache.
- * The rough guide is that the cache size should be equal to the maximum
- * number of simultaneous managers you expect to talk to the agent (M) times 80%
- * (or so, he says randomly) the average number (N) of varbinds you
- * expect to receive in a given request for a manager.  ie, M times N.
- * Bigger does NOT necessarily mean better.  Certainly 16 should be an
- * upper limit.  32 is the hard coded limit.
- *
- * @param newsize set to the maximum size of a cache for a given
- * context.  Set to 0 to completely disable caching, or to -1 to set
- * to the default cache size (8), or to a number of your chosing.  The
+/*
+ * Bumped on every change to the shape of any subtree list; an index
+ * built at an older generation is rebuilt before it is used again.
+ */
+static u_int subtree_generation = 1;
+
+NETSNMP_STATIC_INLINE void
+subtree_changed(void) {
+    if (++subtree_generation == 0)
+        subtree_generation = 1;
+}
+
+/** Enables or disables the lookup index.
+ * The registration code turns it off while it modifies the subtree
+ * lists, which it walks itself, and the agent turns it on once the
+ * initial registrations are loaded.  Sub-agents don't need it.
+ *
+ * The index itself is not bounded by this value; it is kept for
+ * compatibility with the size of the old fixed lookup cache.
+ *
+ * @param newsize set to 0 to disable the index, or to -1 or any
+ * positive number to enable it.
  */
 void
 netsnmp_set_lookup_cache_size(int newsize) {
@@ -131,14 +139,14 @@ netsnmp_set_lookup_cache_size(int newsize) {
 /** Retrieves the current value of the lookup cache size
  *  Should be called from master agent only - sub-agent doesn't need the cache.
  *
- *  @return the current lookup cache size
+ *  @return the current lookup cache size, 0 if the index is disabled
  */
 int
 netsnmp_get_lookup_cache_size(void) {
     return lookup_cache_size;
 }
 
-/** Returns lookup cache entry for the context of given name.
+/** Returns lookup index entry for the context of given name.
  *
  *  @param context Name of the context. Name is case sensitive.
  *
@@ -157,8 +165,14 @@ get_context_lookup_cache(const char *context) {
     if (!ptr) {
         if (netsnmp_subtree_find_first(context)) {
             ptr = SNMP_MALLOC_TYPEDEF(lookup_cache_context);
-            ptr->next = thecontextcache;
+            if (!ptr)
+                return NULL;
             ptr->context = strdup(context);
+            if (!ptr->context) {
+                free(ptr);
+                return NULL;
+            }
+            ptr->next = thecontextcache;
             thecontextcache = ptr;
         } else {
             return NULL;
@@ -167,50 +181,40 @@ get_context_lookup_cache(const char *context) {
     return ptr;
 }
 
-/** Adds an entry to the Lookup Cache under specified context name.
- *
- *  @param context  Name of the context. Name is case sensitive.
- *
- *  @param next     Next subtree item.
- *
- *  @param previous Previous subtree item.
- */
-NETSNMP_STATIC_INLINE void
-lookup_cache_add(const char *context,
-                 netsnmp_subtree *next, netsnmp_subtree *previous) {
-    lookup_cache_context *cptr;
-
-    if ((cptr = get_context_lookup_cache(context)) == NULL)
-        return;
-
-    if (cptr->thecachecount < lookup_cache_size)
-        cptr->thecachecount++;
-
-    cptr->cache[cptr->currentpos].next = next;
-    cptr->cache[cptr->currentpos].previous = previous;
-
-    if (++cptr->currentpos >= lookup_cache_size)
-        cptr->currentpos = 0;
-}
-
 /** @private
- *  Replaces next and previous pointer in given Lookup Cache.
- *
- *  @param ptr      Lookup Cache pointer.
+ *  Rebuilds the index of a context from its subtree list.
  *
- *  @param next     Next subtree item.
- *
- *  @param previous Previous subtree item.
+ *  @return 0 on success, -1 if memory ran out (the index is left empty).
  */
-NETSNMP_STATIC_INLINE void
-lookup_cache_replace(lookup_cache *ptr,
-                     netsnmp_subtree *next, netsnmp_subtree *previous) {
-
-    ptr->next = next;
-    ptr->previous = previous;
+static int
+lookup_cache_rebuild(lookup_cache_context *cptr) {
+    netsnmp_subtree *s;
+    size_t n = 0;
+
+    for (s = netsnmp_subtree_find_first(cptr->context); s; s = s->next)
+        n++;
+    if (n > cptr->size) {
+        netsnmp_subtree **a = (netsnmp_subtree **)
+            realloc(cptr->subtrees, n * sizeof(*a));
+        if (!a) {
+            cptr->count = 0;
+            return -1;
+        }
+        cptr->subtrees = a;
+        cptr->size = n;
+    }
+    n = 0;
+    for (s = netsnmp_subtree_find_first(cptr->context); s; s = s->next)
+        cptr->subtrees[n++] = s;
+    cptr->count = n;
+    cptr->generation = subtree_generation;
+    DEBUGMSGTL(("subtree:index", "indexed %" NETSNMP_PRIz "u subtrees for "
+                "context \"%s\"\n", n, cptr->context));
+    return 0;
 }
 
-/** Finds an entry in the Lookup Cache.
+/** Finds the last subtree in a context starting at or before an OID,
+ *  using the index.
  *
  *  @param context  Case sensitive name of the context.
  *
@@ -218,49 +222,44 @@ lookup_cache_replace(lookup_cache *ptr,
  *
  *  @param name_len Number of sub-ids (single integers) in the OID.
  *
- *  @param retcmp   Value set to snmp_oid_compare() call result.
- *                  The value, if set, is always nonnegative.
- *
- *  @return gives Lookup Cache entry, or NULL if not found.
+ *  @param found    Set to the subtree, or NULL if the OID precedes
+ *                  every registration.
  *
- *  @see snmp_oid_compare()
+ *  @return 0 if the index was used, -1 if it is not available and the
+ *          list has to be searched instead.
  */
-NETSNMP_STATIC_INLINE lookup_cache *
+NETSNMP_STATIC_INLINE int
 lookup_cache_find(const char *context, const oid *name, size_t name_len,
-                  int *retcmp) {
+                  netsnmp_subtree **found) {
     lookup_cache_context *cptr;
-    lookup_cache *ret = NULL;
-    int cmp;
-    int i;
+    size_t lo, hi, mid;
 
     if ((cptr = get_context_lookup_cache(context)) == NULL)
-        return NULL;
-
-    for(i = 0; i < cptr->thecachecount && i < lookup_cache_size; i++) {
-        if (cptr->cache[i].previous->start_a)
-            cmp = snmp_oid_compare(name, name_len,
-                                   cptr->cache[i].previous->start_a,
-                                   cptr->cache[i].previous->start_len);
+        return -1;
+    if (cptr->generation != subtree_generation &&
+        lookup_cache_rebuild(cptr) != 0)
+        return -1;
+
+    lo = 0;
+    hi = cptr->count;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (snmp_oid_compare(name, name_len, cptr->subtrees[mid]->start_a,
+                             cptr->subtrees[mid]->start_len) < 0)
+            hi = mid;
         else
-            cmp = 1;
-        if (cmp >= 0) {
-            *retcmp = cmp;
-            ret = &(cptr->cache[i]);
-        }
+            lo = mid + 1;
     }
-    return ret;
+    *found = lo ? cptr->subtrees[lo - 1] : NULL;
+    return 0;
 }
 
 /** @private
- *  Clears cache count and position in Lookup Cache.
+ *  Marks the index of a context as out of date.
  */
 NETSNMP_STATIC_INLINE void
 invalidate_lookup_cache(const char *context) {
-    lookup_cache_context *cptr;
-    if ((cptr = get_context_lookup_cache(context)) != NULL) {
-        cptr->thecachecount = 0;
-        cptr->currentpos = 0;
-    }
+    subtree_changed();
 }
 
 void
@@ -272,6 +271,7 @@ clear_lookup_cache(void) {
     while (ptr) {
 	next = ptr->next;
 	SNMP_FREE(ptr->context);
+	SNMP_FREE(ptr->subtrees);
 	SNMP_FREE(ptr);
 	ptr = next;
     }
@@ -358,6 +358,7 @@ add_subtree(netsnmp_subtree *new_tree, const char *context_name)
     ptr->first_subtree = new_tree;
     ptr->context_name = strdup(context_name);
     context_subtrees = ptr;
+    subtree_changed();
 
     return ptr->first_subtree;
 }
@@ -379,6 +380,7 @@ netsnmp_remove_subtree(netsnmp_subtree *tree)
 
     if (tree->next)
         tree->next->prev = tree->prev;
+    subtree_changed();
 }
 
 /** Replaces first subtree registered under given context name.
@@ -405,6 +407,7 @@ netsnmp_subtree_replace_first(netsnmp_subtree *new_tree,
         if (ptr->context_name != NULL &&
 	    strcmp(ptr->context_name, context_name) == 0) {
             ptr->first_subtree = new_tree;
+            subtree_changed();
             return ptr->first_subtree;
         }
     }
@@ -480,6 +483,7 @@ netsnmp_subtree_free(netsnmp_subtree *a)
     netsnmp_handler_registration_free(a->reginfo);
     a->reginfo = NULL;
     SNMP_FREE(a);
+    subtree_changed();
   }
 }
 
@@ -538,6 +542,7 @@ NETSNMP_STATIC_INLINE void
 netsnmp_subtree_change_next(netsnmp_subtree *ptr, netsnmp_subtree *thenext)
 {
     ptr->next = thenext;
+    subtree_changed();
     if (thenext)
         netsnmp_oid_compare_ll(ptr->start_a,
                                ptr->start_len,
@@ -553,6 +558,7 @@ NETSNMP_STATIC_INLINE void
 netsnmp_subtree_change_prev(netsnmp_subtree *ptr, netsnmp_subtree *theprev)
 {
     ptr->prev = theprev;
+    subtree_changed();
     if (theprev)
         netsnmp_oid_compare_ll(theprev->start_a,
                                theprev->start_len,
@@ -977,26 +983,17 @@ netsnmp_subtree *
 netsnmp_subtree_find_prev(const oid *name, size_t len, netsnmp_subtree *subtree,
 			  const char *context_name)
 {
-    lookup_cache *lookup_cache = NULL;
     netsnmp_subtree *myptr = NULL, *previous = NULL;
-    int cmp = 1;
     size_t ll_off = 0;
 
     if (subtree) {
         myptr = subtree;
     } else {
 	/* look through everything */
-        if (lookup_cache_size) {
-            lookup_cache = lookup_cache_find(context_name, name, len, &cmp);
-            if (lookup_cache) {
-                myptr = lookup_cache->next;
-                previous = lookup_cache->previous;
-            }
-            if (!myptr)
-                myptr = netsnmp_subtree_find_first(context_name);
-        } else {
-            myptr = netsnmp_subtree_find_first(context_name);
-        }
+        if (lookup_cache_size &&
+            lookup_cache_find(context_name, name, len, &previous) == 0)
+            return previous;
+        myptr = netsnmp_subtree_find_first(context_name);
     }
 
     /*
@@ -1031,13 +1028,6 @@ netsnmp_subtree_find_prev(const oid *name, size_t len, netsnmp_subtree *subtree,
 #else
         if (snmp_oid_compare(name, len, myptr->start_a, myptr->start_len) < 0) {
 #endif
-            if (lookup_cache_size && previous && cmp) {
-                if (lookup_cache) {
-                    lookup_cache_replace(lookup_cache, myptr, previous);
-                } else {
-                    lookup_cache_add(context_name, myptr, previous);
-                }
-            }
             return previous;
         }
     }
@@ -24,6 +24,7 @@ netsnmp_init_helpers(void)
     netsnmp_init_serialize();
     netsnmp_init_read_only_helper();
     netsnmp_init_bulk_to_next_helper();
+    netsnmp_init_cache_handler();
 #ifndef NETSNMP_FEATURE_REMOVE_TABLE_DATASET
     netsnmp_init_table_dataset();
 #endif /* NETSNMP_FEATURE_REMOVE_TABLE_DATASET */
@@ -135,6 +135,134 @@ netsnmp_bulk_to_next_helper(netsnmp_mib_handler *handler,
     return ret;
 }
 
+/** returns a table_bulk handler, which answers a whole GETBULK for the
+ *  handlers below it in one call.  netsnmp_register_table() injects it
+ *  in place of the bulk_to_next handler.
+ */
+netsnmp_mib_handler *
+netsnmp_get_table_bulk_handler(void)
+{
+    netsnmp_mib_handler *handler =
+        netsnmp_create_handler("table_bulk", netsnmp_table_bulk_helper);
+
+    if (NULL != handler)
+        handler->flags |= MIB_HANDLER_AUTO_NEXT;
+
+    return handler;
+}
+
+/*
+ * Access control for the answers gathered by the table_bulk handler.
+ * check_acm() only looks at as many repetitions as one pass can add, so
+ * an answer outside the view is marked to be retried from where it is,
+ * just like the agent does between passes, before the request moves on.
+ */
+static void
+_table_bulk_check_acm(netsnmp_agent_request_info *reqinfo,
+                      netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request;
+    netsnmp_variable_list *vb;
+
+    for (request = requests; request; request = request->next) {
+        vb = request->requestvb;
+        if (request->delegated || request->status ||
+            ASN_NULL == vb->type || ASN_PRIV_RETRY == vb->type)
+            continue;
+        if (in_a_view(vb->name, &vb->name_length, reqinfo->asp->pdu,
+                      vb->type) != VACM_SUCCESS) {
+            snmp_set_var_typed_value(vb, ASN_PRIV_RETRY, NULL, 0);
+            request->inclusive = 0;
+        }
+    }
+}
+
+/** @internal Implements the table_bulk handler.
+ *
+ *  Like bulk_to_next, but instead of answering one repetition and
+ *  leaving the rest to another pass through the agent (with its subtree
+ *  cache rebuild and access control checks), the next handler is called
+ *  in GETNEXT mode again and again for the requests that still have
+ *  repetitions left and whose last answer stayed within the table, so
+ *  that consecutive rows of a column are gathered in one call.  Answers
+ *  outside the view are retried from where they are, as the agent would
+ *  do in its next pass.  The loop stops as soon as anything is delegated
+ *  or fails, leaving the rest to the agent as usual.
+ */
+int
+netsnmp_table_bulk_helper(netsnmp_mib_handler *handler,
+                          netsnmp_handler_registration *reginfo,
+                          netsnmp_agent_request_info *reqinfo,
+                          netsnmp_request_info *requests)
+{
+    netsnmp_request_info *request, *todo, *next, **tail, **saved;
+    int             ret, i, count, passes = 1;
+
+    netsnmp_assert(handler->flags & MIB_HANDLER_AUTO_NEXT);
+
+    if (MODE_GETBULK != reqinfo->mode)
+        return SNMP_ERR_NOERROR;
+
+    if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_NO_TABLE_BULK))
+        return netsnmp_bulk_to_next_helper(handler, reginfo, reqinfo,
+                                           requests);
+
+    for (count = 0, request = requests; request; request = request->next)
+        count++;
+    saved = (netsnmp_request_info **) malloc(count * sizeof(*saved));
+    if (NULL == saved)
+        return netsnmp_bulk_to_next_helper(handler, reginfo, reqinfo,
+                                           requests);
+    for (i = 0, request = requests; request; request = request->next)
+        saved[i++] = request->next;
+
+    reqinfo->mode = MODE_GETNEXT;
+    ret = netsnmp_call_next_handler(handler, reginfo, reqinfo, requests);
+    _table_bulk_check_acm(reqinfo, requests);
+    netsnmp_bulk_to_next_fix_requests(requests);
+
+    for (todo = requests; SNMP_ERR_NOERROR == ret; passes++) {
+        /*
+         * collect the requests that moved on to their next repetition
+         */
+        for (tail = &next, request = todo; request; request = request->next) {
+            if (request->delegated || request->status)
+                break;
+            if (ASN_PRIV_RETRY == request->requestvb->type) {
+                *tail = request;
+                tail = &request->next;
+            }
+        }
+        if (request || tail == &next)
+            break;
+        *tail = NULL;
+        todo = next;
+
+        for (request = todo; request; request = request->next) {
+            request->requestvb->type = ASN_NULL;
+            request->processed = 0;
+            netsnmp_free_request_data_sets(request);
+        }
+        ret = netsnmp_call_next_handler(handler, reginfo, reqinfo, todo);
+        _table_bulk_check_acm(reqinfo, todo);
+        netsnmp_bulk_to_next_fix_requests(todo);
+    }
+    reqinfo->mode = MODE_GETBULK;
+
+    for (i = 0, request = requests; i < count; i++) {
+        request->next = saved[i];
+        request = saved[i];
+    }
+    free(saved);
+
+    DEBUGMSGTL(("table_bulk", "%s: %d requests in %d passes\n",
+                reginfo->handlerName, count, passes));
+
+    handler->flags |= MIB_HANDLER_AUTO_NEXT_OVERRIDE_ONCE;
+    return ret;
+}
+
 /** initializes the bulk_to_next helper which then registers a bulk_to_next
  *  handler as a run-time injectable handler for configuration file
  *  use.
@@ -34,6 +34,8 @@ netsnmp_feature_child_of(cache_get_head, cache_handler);
 
 static netsnmp_cache  *cache_head = NULL;
 static int             cache_outstanding_valid = 0;
+static int             cache_preload_callback = 0;
+static u_long          cache_prewarm_alarm = 0;
 static int             _cache_load( netsnmp_cache *cache );
 
 #define CACHE_RELEASE_FREQUENCY 60      /* Check for expired caches every 60s */
@@ -78,7 +80,12 @@ void            release_cached_resources(unsigned int regNo,
  *  routine will properly deal with being called with a valid cache.
  *
  *  If NETSNMP_CACHE_PRELOAD is set when a the cache handler is created,
- *  the cache load routine will be called immediately.
+ *  the cache load routine will be called once the configuration has been
+ *  read (immediately, if it already has been). With the lazyInit token,
+ *  the load is instead left to the first request that uses the cache, or
+ *  to the prewarming pass set up by lazyInitPrewarm. Until then the cache
+ *  is marked NETSNMP_CACHE_PRELOAD_PENDING, and the timer for
+ *  NETSNMP_CACHE_AUTO_RELOAD is not started either.
  *
  *  If NETSNMP_CACHE_DONT_AUTO_RELEASE is set, the periodic callback that
  *  checks for expired caches will skip the cache. The cache will only be
@@ -98,6 +105,26 @@ void            release_cached_resources(unsigned int regNo,
  *  not be used if cache is not synchronized automatically as it would
  *  result in stale cache information when if polling happens too fast.
  *
+ *  If NETSNMP_CACHE_BACKGROUND_RELOAD is set, a request that finds the
+ *  cache expired (but still loaded) is answered from the existing data,
+ *  and the reload is scheduled to run from the main loop once the current
+ *  request has been dealt with. Requests are then never held up by a slow
+ *  load routine, at the price of seeing data that is up to one reload
+ *  older. The duration of the last load is kept in load_time, and shown
+ *  as nsCacheLoadTime.
+ *
+ *  Data access code that learns about individual changes to its data
+ *  (from netlink messages, say) can avoid reloading everything by setting
+ *  the cache's apply_change hook and reporting each insert, update or
+ *  delete with netsnmp_cache_report_change(). The changes are queued, and
+ *  the next request that finds the cache unexpired hands them to the
+ *  apply_change hook, in the order they were reported, instead of calling
+ *  load_cache. The timeout still triggers a full reload, so that a missed
+ *  change does not live forever. If apply_change fails, the rest of the
+ *  queue is discarded and the cache is fully reloaded. Queued changes are
+ *  passed to apply_change with NETSNMP_CACHE_CHANGE_DISCARD whenever they
+ *  are made redundant by a full reload, so that their data can be freed.
+ *
  *
  *  Here are some suggestions for some common situations.
  *
@@ -129,6 +156,14 @@ void            release_cached_resources(unsigned int regNo,
  *          NETSNMP_CACHE_DONT_AUTO_RELEASE
  *          NETSNMP_CACHE_AUTO_RELOAD
  *
+ *  Large tables, expensive to load:
+ *      If loading the cache takes long enough for requests to time out
+ *      while they wait for it, let the reload run between requests
+ *      instead. Set the following flags:
+ *
+ *          NETSNMP_CACHE_DONT_FREE_EXPIRED
+ *          NETSNMP_CACHE_BACKGROUND_RELOAD
+ *
  *  Dynamically updated, unloaded after timeout:
  *      If the cache is kept up to date dynamically by listening for
  *      change notifications somehow, but it should not be in memory
@@ -261,6 +296,11 @@ netsnmp_cache_free(netsnmp_cache *cache)
     if(0 != cache->timer_id)
         netsnmp_cache_timer_stop(cache);
 
+    if (0 != cache->reload_alarm)
+        snmp_alarm_unregister(cache->reload_alarm);
+
+    netsnmp_cache_discard_changes(cache);
+
     if (cache->valid)
         _cache_free(cache);
 
@@ -318,6 +358,84 @@ _timer_reload(unsigned int regNo, void *clientargs)
     _cache_load(cache);
 }
 
+/** callback function to run a deferred cache load */
+static void
+_background_reload(unsigned int regNo, void *clientargs)
+{
+    netsnmp_cache *cache = (netsnmp_cache *)clientargs;
+
+    cache->reload_alarm = 0;
+    if (!cache->enabled || !netsnmp_cache_check_expired(cache))
+        return;
+
+    DEBUGMSGT(("helper:cache_handler", "background reload of cache %p\n",
+               cache));
+    _cache_load(cache);
+}
+
+/** callback function to load the next cache still waiting for its preload */
+static void
+_cache_prewarm(unsigned int regNo, void *clientargs)
+{
+    netsnmp_cache *cache;
+
+    cache_prewarm_alarm = 0;
+    for (cache = cache_head; cache; cache = cache->next)
+        if (cache->flags & NETSNMP_CACHE_PRELOAD_PENDING)
+            break;
+    if (NULL == cache)
+        return;
+
+    DEBUGMSGT(("helper:cache_handler", "prewarming cache %p\n", cache));
+    (void)_cache_load(cache);
+
+    /*
+     * one cache per pass, so that requests get answered in between
+     */
+    cache_prewarm_alarm = snmp_alarm_register(0, 0, _cache_prewarm, NULL);
+}
+
+static void
+_cache_schedule_prewarm(void)
+{
+    int             delay;
+
+    delay = netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_PREWARM);
+    if (delay > 0 && 0 == cache_prewarm_alarm)
+        cache_prewarm_alarm =
+            snmp_alarm_register(delay, 0, _cache_prewarm, NULL);
+}
+
+/** runs the preloads held back until the configuration had been read */
+static int
+_cache_config_read(int majorID, int minorID, void *serverarg,
+                   void *clientarg)
+{
+    netsnmp_cache *cache;
+
+    if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_INIT)) {
+        _cache_schedule_prewarm();
+        return SNMPERR_SUCCESS;
+    }
+
+    for (cache = cache_head; cache; cache = cache->next)
+        if (cache->flags & NETSNMP_CACHE_PRELOAD_PENDING)
+            (void)_cache_load(cache);
+    return SNMPERR_SUCCESS;
+}
+
+/** initializes the cache handler. Called by init_agent. */
+void
+netsnmp_init_cache_handler(void)
+{
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           _cache_config_read, NULL);
+    cache_preload_callback = 1;
+}
+
 /** starts the recurring cache_load callback */
 unsigned int
 netsnmp_cache_timer_start(netsnmp_cache *cache)
@@ -388,13 +506,32 @@ netsnmp_cache_handler_get(netsnmp_cache* cache)
         
         if(NULL != cache) {
             if ((cache->flags & NETSNMP_CACHE_PRELOAD) && ! cache->valid) {
-                /*
-                 * load cache, ignore rc
-                 * (failed load doesn't affect registration)
-                 */
-                (void)_cache_load(cache);
+                int config_read =
+                    netsnmp_ds_get_boolean(NETSNMP_DS_LIBRARY_ID,
+                                           NETSNMP_DS_LIB_HAVE_READ_CONFIG);
+
+                if (cache->rootoid && cache_preload_callback &&
+                    (!config_read ||
+                     netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                            NETSNMP_DS_AGENT_LAZY_INIT))) {
+                    /*
+                     * wait for the configuration to say whether the load
+                     * should be left to the first request (lazyInit).
+                     * Only caches in the list can be found again.
+                     */
+                    cache->flags |= NETSNMP_CACHE_PRELOAD_PENDING;
+                    if (config_read)
+                        _cache_schedule_prewarm();
+                } else {
+                    /*
+                     * load cache, ignore rc
+                     * (failed load doesn't affect registration)
+                     */
+                    (void)_cache_load(cache);
+                }
             }
-            if (cache->flags & NETSNMP_CACHE_AUTO_RELOAD)
+            if ((cache->flags & NETSNMP_CACHE_AUTO_RELOAD) &&
+                !(cache->flags & NETSNMP_CACHE_PRELOAD_PENDING))
                 netsnmp_cache_timer_start(cache);
             
         }
@@ -565,6 +702,78 @@ netsnmp_cache_check_expired(netsnmp_cache *cache)
     return cache->expired;
 }
 
+/** Queue a change to the cached data, to be applied by the apply_change
+ *  hook before the cache is next used.  data is owned by the queue until
+ *  it has been passed to apply_change.
+ */
+int
+netsnmp_cache_report_change(netsnmp_cache *cache, int op, void *data)
+{
+    netsnmp_cache_change *change;
+
+    if (NULL == cache || NULL == cache->apply_change)
+        return SNMPERR_GENERR;
+
+    change = SNMP_MALLOC_TYPEDEF(netsnmp_cache_change);
+    if (NULL == change)
+        return SNMPERR_MALLOC;
+    change->op = op;
+    change->data = data;
+    if (cache->changes_tail)
+        cache->changes_tail->next = change;
+    else
+        cache->changes = change;
+    cache->changes_tail = change;
+
+    DEBUGMSGTL(("helper:cache_handler:change", "cache %p: queued op %d\n",
+                cache, op));
+    return SNMPERR_SUCCESS;
+}
+
+/** Drop any queued changes, passing each to apply_change to be freed */
+void
+netsnmp_cache_discard_changes(netsnmp_cache *cache)
+{
+    netsnmp_cache_change *change;
+
+    if (NULL == cache)
+        return;
+
+    while ((change = cache->changes) != NULL) {
+        cache->changes = change->next;
+        if (cache->apply_change)
+            cache->apply_change(cache, NETSNMP_CACHE_CHANGE_DISCARD,
+                                change->data, cache->magic);
+        free(change);
+    }
+    cache->changes_tail = NULL;
+}
+
+/** apply the queued changes, falling back to a full load on failure */
+static int
+_cache_apply_changes(netsnmp_cache *cache)
+{
+    netsnmp_cache_change *change;
+    int count = 0, rc;
+
+    while ((change = cache->changes) != NULL) {
+        cache->changes = change->next;
+        if (NULL == cache->changes)
+            cache->changes_tail = NULL;
+        rc = cache->apply_change(cache, change->op, change->data,
+                                 cache->magic);
+        free(change);
+        cache->generation++;
+        if (rc < 0) {
+            DEBUGMSGT(("helper:cache_handler", " change failed (%d)\n", rc));
+            return _cache_load(cache);
+        }
+        count++;
+    }
+    DEBUGMSGT(("helper:cache_handler", " applied %d changes\n", count));
+    return 0;
+}
+
 /** Reload the cache if required */
 int
 netsnmp_cache_check_and_reload(netsnmp_cache * cache)
@@ -575,6 +784,8 @@ netsnmp_cache_check_and_reload(netsnmp_cache * cache)
     }
     if (!cache->valid || netsnmp_cache_check_expired(cache))
         return _cache_load( cache );
+    else if (cache->changes)
+        return _cache_apply_changes( cache );
     else {
         DEBUGMSGT(("helper:cache_handler", " cached (%d)\n",
                    cache->timeout));
@@ -666,6 +877,23 @@ netsnmp_cache_helper_handler(netsnmp_mib_handler * handler,
         if (netsnmp_cache_is_valid(reqinfo, addrstr))
             break;
 
+        /*
+         * serve expired data while a reload is pending, if allowed to
+         */
+        if ((cache->flags & NETSNMP_CACHE_BACKGROUND_RELOAD) &&
+            reqinfo->mode != MODE_SET_RESERVE1 &&
+            cache->valid && netsnmp_cache_check_expired(cache)) {
+            if (0 == cache->reload_alarm)
+                cache->reload_alarm =
+                    snmp_alarm_register(0, 0, _background_reload, cache);
+            if (0 != cache->reload_alarm) {
+                DEBUGMSGT(("helper:cache_handler", " stale, reload %lu\n",
+                           cache->reload_alarm));
+                netsnmp_cache_reqinfo_insert(cache, reqinfo, addrstr);
+                break;
+            }
+        }
+
         /*
          * call the load hook, and update the cache timestamp.
          * If it's not already there, add to reqinfo
@@ -694,6 +922,7 @@ netsnmp_cache_helper_handler(netsnmp_mib_handler * handler,
             ! (cache->flags & NETSNMP_CACHE_DONT_INVALIDATE_ON_SET) ) {
             cache->free_cache(cache, cache->magic);
             cache->valid = 0;
+            cache->generation++;
         }
         /** next handler called automatically - 'AUTO_NEXT' */
         break;
@@ -716,6 +945,7 @@ _cache_free( netsnmp_cache *cache )
     if (NULL != cache->free_cache) {
         cache->free_cache(cache, cache->magic);
         cache->valid = 0;
+        cache->generation++;
     }
 }
 
@@ -723,6 +953,22 @@ static int
 _cache_load( netsnmp_cache *cache )
 {
     int ret = -1;
+    struct timeval start, now;
+
+    /*
+     * The first load of a cache whose preload was held back starts its
+     * reload timer too
+     */
+    if (cache->flags & NETSNMP_CACHE_PRELOAD_PENDING) {
+        cache->flags &= ~NETSNMP_CACHE_PRELOAD_PENDING;
+        if (cache->flags & NETSNMP_CACHE_AUTO_RELOAD)
+            netsnmp_cache_timer_start(cache);
+    }
+
+    /*
+     * A full load covers any changes reported since the last one
+     */
+    netsnmp_cache_discard_changes(cache);
 
     /*
      * If we've got a valid cache, then release it before reloading
@@ -731,8 +977,13 @@ _cache_load( netsnmp_cache *cache )
         (! (cache->flags & NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD)))
         _cache_free(cache);
 
+    netsnmp_get_monotonic_clock(&start);
+    cache->generation++;
     if ( cache->load_cache)
         ret = cache->load_cache(cache, cache->magic);
+    netsnmp_get_monotonic_clock(&now);
+    cache->load_time = (now.tv_sec - start.tv_sec) * 1000 +
+        (now.tv_usec - start.tv_usec) / 1000;
     if (ret < 0) {
         DEBUGMSGT(("helper:cache_handler", " load failed (%d)\n", ret));
         cache->valid = 0;
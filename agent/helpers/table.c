@@ -165,6 +165,22 @@ netsnmp_register_table(netsnmp_handler_registration *reginfo,
         return MIB_REGISTRATION_FAILED;
     }
 
+    /*
+     * let GETBULK collect a column's rows in one call, rather than one
+     * row per pass through the agent (see netsnmp_table_bulk_helper)
+     */
+    if (!(reginfo->modes & HANDLER_CAN_GETBULK)) {
+        handler = netsnmp_get_table_bulk_handler();
+        if (!handler ||
+            (netsnmp_inject_handler(reginfo, handler) != SNMPERR_SUCCESS)) {
+            snmp_log(LOG_ERR, "could not create table_bulk handler\n");
+            netsnmp_handler_free(handler);
+            netsnmp_handler_registration_free(reginfo);
+            return MIB_REGISTRATION_FAILED;
+        }
+        reginfo->modes |= HANDLER_CAN_GETBULK;
+    }
+
     return netsnmp_register_handler(reginfo);
 }
 
@@ -63,6 +63,9 @@ netsnmp_feature_child_of(table_data_row_first, table_data_extras);
  *  for or accept data for.  Complex GETNEXT handling is greatly
  *  simplified in this case.
  *
+ *  The rows are kept in a list in index order, and in a container over
+ *  the same rows so that lookups and inserts don't walk the list.
+ *
  *  @{
  */
 
@@ -81,6 +84,44 @@ netsnmp_table_data_generate_index_oid(netsnmp_table_row *row)
     build_oid(&row->index_oid, &row->index_oid_len, NULL, 0, row->indexes);
 }
 
+static int
+_table_data_row_compare(const void *lhs, const void *rhs)
+{
+    const netsnmp_table_row *lrow = (const netsnmp_table_row *)lhs;
+    const netsnmp_table_row *rrow = (const netsnmp_table_row *)rhs;
+
+    return snmp_oid_compare(lrow->index_oid, lrow->index_oid_len,
+                            rrow->index_oid, rrow->index_oid_len);
+}
+
+/*
+ * returns the index over the table's rows, building it from the row list
+ * the first time. Returns NULL if it can't be built, in which case the
+ * list is searched instead.
+ */
+static netsnmp_container *
+_table_data_rows(netsnmp_table_data *table)
+{
+    netsnmp_table_row *row;
+
+    if (table->rows)
+        return table->rows;
+
+    table->rows = netsnmp_container_find("table_data:table_container");
+    if (!table->rows)
+        return NULL;
+    table->rows->compare = _table_data_row_compare;
+
+    for (row = table->first_row; row; row = row->next) {
+        if (row->index_oid && CONTAINER_INSERT(table->rows, row) != 0) {
+            CONTAINER_FREE(table->rows);
+            table->rows = NULL;
+            return NULL;
+        }
+    }
+    return table->rows;
+}
+
 /** creates and returns a pointer to table data set */
 netsnmp_table_data *
 netsnmp_create_table_data(const char *name)
@@ -169,6 +210,7 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
 {
     int rc, dup = 0;
     netsnmp_table_row *nextrow = NULL, *prevrow;
+    netsnmp_container *rows;
 
     if (!row || !table)
         return SNMPERR_GENERR;
@@ -192,6 +234,8 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
         return SNMPERR_GENERR;
     }
 
+    rows = _table_data_rows(table);
+
     /*
      * check for simple append
      */
@@ -208,7 +252,14 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
      * if no last row, or newrow < last row, search the table and
      * insert it into the table in the proper oid-lexographical order 
      */
-    if (rc > 0) {
+    if (rc > 0 && rows) {
+        if (CONTAINER_FIND(rows, row))
+            dup = 1;
+        else {
+            nextrow = (netsnmp_table_row *)CONTAINER_NEXT(rows, row);
+            prevrow = nextrow ? nextrow->prev : table->last_row;
+        }
+    } else if (rc > 0) {
         for (nextrow = table->first_row, prevrow = NULL;
              nextrow != NULL; prevrow = nextrow, nextrow = nextrow->next) {
             if (NULL == nextrow->index_oid) {
@@ -236,6 +287,9 @@ netsnmp_table_data_add_row(netsnmp_table_data *table,
         return SNMPERR_GENERR;
     }
 
+    if (rows && CONTAINER_INSERT(rows, row) != 0)
+        return SNMPERR_GENERR;
+
     /*
      * ok, we have the location of where it should go 
      */
@@ -284,6 +338,9 @@ netsnmp_table_data_remove_row(netsnmp_table_data *table,
     if (!row || !table)
         return NULL;
 
+    if (table->rows)
+        CONTAINER_REMOVE(table->rows, row);
+
     if (row->prev)
         row->prev->next = row->next;
     else
@@ -348,6 +405,8 @@ netsnmp_table_data_delete_table( netsnmp_table_data *table )
         /* Can't delete table-specific entry memory */
     }
     table->first_row = NULL;
+    if (table->rows)
+        CONTAINER_FREE(table->rows);
 
     SNMP_FREE(table->name);
     SNMP_FREE(table);
@@ -572,33 +631,47 @@ netsnmp_table_data_helper_handler(netsnmp_mib_handler *handler,
                  */
                 row = table->first_row;
             } else {
+                netsnmp_container *rows = _table_data_rows(table);
+                netsnmp_table_row key;
+
                 /*
-                 * loop through all rows looking for the first one
-                 * that is equal to the request or greater than it 
+                 * the first row greater than the request's index
                  */
-                for (row = table->first_row; row; row = row->next) {
+                key.index_oid = request->requestvb->name + 2 +
+                    reginfo->rootoid_len;
+                key.index_oid_len = request->requestvb->name_length -
+                    2 - reginfo->rootoid_len;
+                if (rows)
+                    row = (netsnmp_table_row *)CONTAINER_NEXT(rows, &key);
+                else {
                     /*
-                     * compare the index of the request to the row 
+                     * loop through all rows looking for the first one
+                     * that is equal to the request or greater than it 
                      */
-                    result =
-                        snmp_oid_compare(row->index_oid,
-                                         row->index_oid_len,
-                                         request->requestvb->name + 2 +
-                                         reginfo->rootoid_len,
-                                         request->requestvb->name_length -
-                                         2 - reginfo->rootoid_len);
-                    if (result == 0) {
+                    for (row = table->first_row; row; row = row->next) {
                         /*
-                         * equal match, return the next row 
+                         * compare the index of the request to the row 
                          */
-                        row = row->next;
-                        break;
-                    } else if (result > 0) {
-                        /*
-                         * the current row is greater than the
-                         * request, use it 
-                         */
-                        break;
+                        result =
+                            snmp_oid_compare(row->index_oid,
+                                             row->index_oid_len,
+                                             request->requestvb->name + 2 +
+                                             reginfo->rootoid_len,
+                                             request->requestvb->name_length -
+                                             2 - reginfo->rootoid_len);
+                        if (result == 0) {
+                            /*
+                             * equal match, return the next row 
+                             */
+                            row = row->next;
+                            break;
+                        } else if (result > 0) {
+                            /*
+                             * the current row is greater than the
+                             * request, use it 
+                             */
+                            break;
+                        }
                     }
                 }
             }
@@ -898,10 +971,18 @@ netsnmp_table_row *
 netsnmp_table_data_get_from_oid(netsnmp_table_data *table,
                                 oid * searchfor, size_t searchfor_len)
 {
-    netsnmp_table_row *row;
+    netsnmp_table_row *row, key;
+    netsnmp_container *rows;
     if (!table)
         return NULL;
 
+    rows = _table_data_rows(table);
+    if (rows) {
+        key.index_oid = searchfor;
+        key.index_oid_len = searchfor_len;
+        return (netsnmp_table_row *)CONTAINER_FIND(rows, &key);
+    }
+
     for (row = table->first_row; row != NULL; row = row->next) {
         if (row->index_oid &&
             snmp_oid_compare(searchfor, searchfor_len,
@@ -918,6 +999,8 @@ netsnmp_table_data_num_rows(netsnmp_table_data *table)
     netsnmp_table_row *row;
     if (!table)
         return 0;
+    if (_table_data_rows(table))
+        return CONTAINER_SIZE(table->rows);
     for (row = table->first_row; row; row = row->next) {
         i++;
     }
@@ -964,10 +1047,16 @@ netsnmp_table_row *
 netsnmp_table_data_row_next_byoid(netsnmp_table_data *table,
                                   oid *instance, size_t len)
 {
-    netsnmp_table_row *row;
+    netsnmp_table_row *row, key;
 
     if (!table || !instance)
         return NULL;
+
+    if (_table_data_rows(table)) {
+        key.index_oid = instance;
+        key.index_oid_len = len;
+        return (netsnmp_table_row *)CONTAINER_NEXT(table->rows, &key);
+    }
     
     for (row = table->first_row; row; row = row->next) {
         if (snmp_oid_compare(row->index_oid,
@@ -83,6 +83,18 @@
         then the free_loop_context_at_end pointer should be set, which
         is more efficient since a malloc/free will only be performed
         once for every iteration.
+
+    Looking for the next row means a pass over the whole table for each
+    GETNEXT request, so walking a table of N rows takes N^2 hook calls.
+    Tables whose data is loaded by a cache helper (netsnmp_cache) that
+    is part of the same registration can set the
+    NETSNMP_ITERATOR_FLAG_SNAPSHOT flag.  The helper then makes a single
+    pass over the rows after every load of the cache, keeps their
+    indexes and data contexts sorted, and answers GET and GETNEXT
+    requests by a binary search.  This is only correct if the data
+    contexts stay valid until the cache is next loaded or freed (data
+    contexts made by make_data_context, or passed back together with
+    a free_data_context hook, are freed by the helper at that point).
  *
  *  @{
  */
@@ -158,6 +170,8 @@ netsnmp_iterator_create_table( Netsnmp_First_Data_Point *firstDP,
 }
 #endif /* NETSNMP_FEATURE_REMOVE_TABLE_ITERATOR_CREATE_TABLE */
 
+static void _ti_snapshot_free(netsnmp_iterator_info *iinfo);
+
 /** Free the memory that was allocated for a table iterator. */
 void
 netsnmp_iterator_delete_table( netsnmp_iterator_info *iinfo )
@@ -165,6 +179,8 @@ netsnmp_iterator_delete_table( netsnmp_iterator_info *iinfo )
     if (!iinfo)
         return;
 
+    _ti_snapshot_free(iinfo);
+
     if (iinfo->indexes) {
         snmp_free_varbind( iinfo->indexes );
         iinfo->indexes = NULL;
@@ -446,6 +462,221 @@ netsnmp_iterator_remember(netsnmp_request_info *request,
     return ti_info;
 }    
 
+/*
+ * A sorted copy of the row indexes of a table, valid for as long as the
+ * cache the rows were loaded by doesn't change (see
+ * NETSNMP_ITERATOR_FLAG_SNAPSHOT).
+ */
+typedef struct ti_snapshot_row_s {
+    oid            *index;
+    size_t          index_len;
+    void           *data_context;
+} ti_snapshot_row;
+
+typedef struct ti_snapshot_s {
+    netsnmp_cache  *cache;
+    u_int           generation;
+    size_t          count;
+    ti_snapshot_row *rows;
+} ti_snapshot;
+
+static void
+_ti_snapshot_free(netsnmp_iterator_info *iinfo)
+{
+    ti_snapshot    *snap = (ti_snapshot *) iinfo->snapshot;
+    size_t          i;
+
+    if (!snap)
+        return;
+    for (i = 0; i < snap->count; i++) {
+        if (iinfo->free_data_context && snap->rows[i].data_context)
+            (iinfo->free_data_context)(snap->rows[i].data_context, iinfo);
+        free(snap->rows[i].index);
+    }
+    free(snap->rows);
+    free(snap);
+    iinfo->snapshot = NULL;
+}
+
+static int
+_ti_snapshot_row_compare(const void *a, const void *b)
+{
+    const ti_snapshot_row *r1 = (const ti_snapshot_row *) a;
+    const ti_snapshot_row *r2 = (const ti_snapshot_row *) b;
+
+    return snmp_oid_compare(r1->index, r1->index_len,
+                            r2->index, r2->index_len);
+}
+
+/* returns the snapshot of the table, (re)building it if needed */
+static ti_snapshot *
+_ti_snapshot_get(netsnmp_iterator_info *iinfo,
+                 netsnmp_handler_registration *reginfo)
+{
+    ti_snapshot    *snap = (ti_snapshot *) iinfo->snapshot;
+    ti_snapshot_row *rows;
+    netsnmp_mib_handler *h;
+    netsnmp_cache  *cache = NULL;
+    netsnmp_variable_list *index_search, *free_this_index_search;
+    void           *loop_context = NULL, *data_context = NULL;
+    void           *last_loop_context;
+    oid             index[MAX_OID_LEN];
+    size_t          index_len, size = 0;
+
+    /*
+     * the handlers of thread safe registrations may run concurrently
+     */
+    if (reginfo->modes & HANDLER_CAN_THREADSAFE)
+        return NULL;
+
+    for (h = reginfo->handler; h; h = h->next)
+        if (h->access_method == netsnmp_cache_helper_handler) {
+            cache = (netsnmp_cache *) h->myvoid;
+            break;
+        }
+    if (!cache || !cache->valid) {
+        DEBUGMSGTL(("table_iterator", "no valid cache for the snapshot of %s\n",
+                    reginfo->handlerName));
+        return NULL;
+    }
+    if (snap && snap->cache == cache && snap->generation == cache->generation)
+        return snap;
+
+    _ti_snapshot_free(iinfo);
+    snap = SNMP_MALLOC_TYPEDEF(ti_snapshot);
+    index_search = snmp_clone_varbind(iinfo->indexes);
+    if (!snap || !index_search) {
+        SNMP_FREE(snap);
+        snmp_free_varbind(index_search);
+        return NULL;
+    }
+    snap->cache = cache;
+    snap->generation = cache->generation;
+    iinfo->snapshot = snap;
+
+    free_this_index_search = index_search;
+    index_search = (iinfo->get_first_data_point) (&loop_context,
+                                                  &data_context,
+                                                  index_search, iinfo);
+    while (index_search) {
+        free_this_index_search = index_search;
+
+        if (snap->count == size) {
+            size = size ? 2 * size : 16;
+            rows = (ti_snapshot_row *) realloc(snap->rows,
+                                               size * sizeof(*rows));
+            if (!rows)
+                break;
+            snap->rows = rows;
+        }
+        if (!data_context && iinfo->make_data_context)
+            data_context = (iinfo->make_data_context)(loop_context, iinfo);
+        build_oid_noalloc(index, MAX_OID_LEN, &index_len, NULL, 0,
+                          index_search);
+        rows = &snap->rows[snap->count];
+        rows->index = (oid *) netsnmp_memdup(index, index_len * sizeof(oid));
+        rows->index_len = index_len;
+        rows->data_context = data_context;
+        if (!rows->index)
+            break;
+        snap->count++;
+
+        data_context = NULL;
+        last_loop_context = loop_context;
+        index_search = (iinfo->get_next_data_point) (&loop_context,
+                                                     &data_context,
+                                                     index_search, iinfo);
+        if (iinfo->free_loop_context && last_loop_context &&
+            data_context != last_loop_context)
+            (iinfo->free_loop_context) (last_loop_context, iinfo);
+    }
+    if (loop_context && iinfo->free_loop_context_at_end)
+        (iinfo->free_loop_context_at_end) (loop_context, iinfo);
+    snmp_free_varbind(free_this_index_search);
+
+    if (index_search) {
+        /* ran out of memory part way through */
+        if (iinfo->free_data_context && data_context)
+            (iinfo->free_data_context)(data_context, iinfo);
+        _ti_snapshot_free(iinfo);
+        return NULL;
+    }
+
+    if (snap->count > 1)
+        qsort(snap->rows, snap->count, sizeof(ti_snapshot_row),
+              _ti_snapshot_row_compare);
+    DEBUGMSGTL(("table_iterator", "snapshot of %s: %" NETSNMP_PRIz "u rows\n",
+                reginfo->handlerName, snap->count));
+    return snap;
+}
+
+/*
+ * Finds the row of the given column whose OID equals (exact) or else
+ * follows the OID of the request.  The rows are sorted by index, and
+ * so are their OIDs within a column.
+ */
+static ti_snapshot_row *
+_ti_snapshot_find(ti_snapshot *snap, oid *coloid, size_t coloid_len,
+                  netsnmp_variable_list *var, int exact)
+{
+    oid             name[MAX_OID_LEN];
+    size_t          lo = 0, hi = snap->count, mid, len;
+    ti_snapshot_row *row;
+    int             cmp;
+
+    memcpy(name, coloid, coloid_len * sizeof(oid));
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        row = &snap->rows[mid];
+        len = coloid_len + row->index_len;
+        if (len > MAX_OID_LEN)
+            len = MAX_OID_LEN;
+        memcpy(name + coloid_len, row->index,
+               (len - coloid_len) * sizeof(oid));
+        cmp = snmp_oid_compare(name, len, var->name, var->name_length);
+        if (exact && cmp == 0)
+            return row;
+        if (exact ? cmp < 0 : cmp <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return (!exact && lo < snap->count) ? &snap->rows[lo] : NULL;
+}
+
+/* fills in the request cache as the main loop would for a matching row */
+static int
+_ti_snapshot_remember(netsnmp_request_info *request, ti_snapshot_row *row,
+                      oid *coloid, size_t coloid_len,
+                      netsnmp_iterator_info *iinfo, int next)
+{
+    ti_cache_info  *ti_info;
+    oid             name[MAX_OID_LEN];
+    size_t          len = coloid_len + row->index_len;
+
+    if (len > MAX_OID_LEN)
+        return SNMPERR_GENERR;
+    memcpy(name, coloid, coloid_len * sizeof(oid));
+    memcpy(name + coloid_len, row->index, row->index_len * sizeof(oid));
+
+    ti_info = netsnmp_iterator_remember(request, name, len,
+                                        row->data_context, NULL, iinfo);
+    if (!ti_info)
+        return SNMPERR_GENERR;
+    ti_info->free_context = NULL;   /* owned by the snapshot */
+
+    if (next) {
+        snmp_free_varbind(ti_info->results);
+        ti_info->results = snmp_clone_varbind(iinfo->indexes);
+        if (!ti_info->results ||
+            parse_oid_indexes(row->index, row->index_len,
+                              ti_info->results) != SNMPERR_SUCCESS)
+            return SNMPERR_GENERR;
+        snmp_set_var_objid(ti_info->results, name, len);
+    }
+    return SNMPERR_SUCCESS;
+}
+
 #define TABLE_ITERATOR_NOTAGAIN 255
 /* implements the table_iterator helper */
 int
@@ -468,6 +699,8 @@ netsnmp_table_iterator_helper_handler(netsnmp_mib_handler *handler,
     netsnmp_request_info *request, *reqtmp = NULL;
     netsnmp_variable_list *index_search = NULL;
     netsnmp_variable_list *free_this_index_search = NULL;
+    ti_snapshot    *snap = NULL;
+    ti_snapshot_row *row;
     void           *callback_loop_context = NULL, *last_loop_context;
     void           *callback_data_context = NULL;
     ti_cache_info  *ti_info = NULL;
@@ -573,10 +806,55 @@ netsnmp_table_iterator_helper_handler(netsnmp_mib_handler *handler,
         break;
     }
 
+    if ((iinfo->flags & NETSNMP_ITERATOR_FLAG_SNAPSHOT) &&
+        (reqinfo->mode == MODE_GET || reqinfo->mode == MODE_GETNEXT))
+        snap = _ti_snapshot_get(iinfo, reginfo);
+
     /*
      * collect all information for each needed row
      */
-    if (reqinfo->mode == MODE_GET ||
+    if (snap) {
+        for (request = requests; request; request = request->next) {
+            if (request->processed)
+                continue;
+            table_info = netsnmp_extract_table_info(request);
+            if (table_info == NULL)
+                return SNMP_ERR_GENERR;
+            coloid[reginfo->rootoid_len + 1] = table_info->colnum;
+
+            if (reqinfo->mode == MODE_GET) {
+                row = _ti_snapshot_find(snap, coloid, coloid_len,
+                                        request->requestvb, 1);
+                if (row && _ti_snapshot_remember(request, row, coloid,
+                                                 coloid_len, iinfo, 0))
+                    return SNMP_ERR_GENERR;
+                continue;
+            }
+
+            for (;;) {
+                int nc;
+
+                row = _ti_snapshot_find(snap, coloid, coloid_len,
+                                        request->requestvb, 0);
+                if (row) {
+                    if (_ti_snapshot_remember(request, row, coloid,
+                                              coloid_len, iinfo, 1))
+                        return SNMP_ERR_GENERR;
+                    break;
+                }
+                nc = netsnmp_table_next_column(table_info);
+                if (0 == nc) {
+                    coloid[reginfo->rootoid_len+1] = table_info->colnum+1;
+                    snmp_set_var_objid(request->requestvb,
+                                       coloid, reginfo->rootoid_len+2);
+                    request->processed = TABLE_ITERATOR_NOTAGAIN;
+                    break;
+                }
+                table_info->colnum = nc;
+                coloid[reginfo->rootoid_len + 1] = nc;
+            }
+        }
+    } else if (reqinfo->mode == MODE_GET ||
         reqinfo->mode == MODE_GETNEXT ||
         reqinfo->mode == MODE_GET_STASH
 #ifndef NETSNMP_NO_WRITE_SUPPORT
@@ -14,6 +14,7 @@
 #include "agent/nsCache.h"
 
 netsnmp_feature_require(cache_get_head);
+netsnmp_feature_require(read_only_counter32_instance);
 
 
 /*
@@ -39,6 +40,7 @@ extern netsnmp_cache *netsnmp_cache_get_head(void);
 
 #define  NSCACHE_TIMEOUT	2
 #define  NSCACHE_STATUS		3
+#define  NSCACHE_LOAD_TIME	4
 
 #define NSCACHE_STATUS_ENABLED  1
 #define NSCACHE_STATUS_DISABLED 2
@@ -56,6 +58,8 @@ init_nsCache(void)
     const oid nsCacheTimeout_oid[]    = { nsCache, 1 };
     const oid nsCacheEnabled_oid[]    = { nsCache, 2 };
     const oid nsCacheTable_oid[]      = { nsCache, 3 };
+    const oid nsResponseMemoHits_oid[]   = { nsCache, 4, 0 };
+    const oid nsResponseMemoMisses_oid[] = { nsCache, 5, 0 };
 
     netsnmp_table_registration_info *table_info;
     netsnmp_iterator_info           *iinfo;
@@ -76,6 +80,14 @@ init_nsCache(void)
             nsCacheEnabled_oid, OID_LENGTH(nsCacheEnabled_oid),
             HANDLER_CAN_RWRITE)
         );
+    netsnmp_register_read_only_counter32_instance(
+        "nsResponseMemoHits",
+        nsResponseMemoHits_oid, OID_LENGTH(nsResponseMemoHits_oid),
+        &netsnmp_response_memo_hits, NULL);
+    netsnmp_register_read_only_counter32_instance(
+        "nsResponseMemoMisses",
+        nsResponseMemoMisses_oid, OID_LENGTH(nsResponseMemoMisses_oid),
+        &netsnmp_response_memo_misses, NULL);
 
     /*
      * ... and the table.
@@ -88,7 +100,7 @@ init_nsCache(void)
     }
     netsnmp_table_helper_add_indexes(table_info, ASN_PRIV_IMPLIED_OBJECT_ID, 0);
     table_info->min_column = NSCACHE_TIMEOUT;
-    table_info->max_column = NSCACHE_STATUS;
+    table_info->max_column = NSCACHE_LOAD_TIME;
 
 
     /*
@@ -316,6 +328,16 @@ handle_nsCacheTable(netsnmp_mib_handler *handler,
                                          (u_char*)&status, sizeof(status));
 	        break;
 
+            case NSCACHE_LOAD_TIME:
+                if (!cache_entry) {
+                    netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHINSTANCE);
+                    continue;
+		}
+	        snmp_set_var_typed_value(request->requestvb, ASN_UNSIGNED,
+                                         (u_char*)&cache_entry->load_time,
+                                         sizeof(cache_entry->load_time));
+	        break;
+
             default:
                 netsnmp_set_request_error(reqinfo, request, SNMP_NOSUCHOBJECT);
                 continue;
@@ -369,6 +391,10 @@ handle_nsCacheTable(netsnmp_mib_handler *handler,
                 }
 	        break;
 
+            case NSCACHE_LOAD_TIME:
+                netsnmp_set_request_error(reqinfo, request, SNMP_ERR_NOTWRITABLE);
+                return SNMP_ERR_NOTWRITABLE;
+
             default:
                 netsnmp_set_request_error(reqinfo, request, SNMP_ERR_NOCREATION);
                 return SNMP_ERR_NOCREATION;	/* XXX - is this right ? */
@@ -87,6 +87,7 @@ init_nsModuleTable(void)
      * here we initialize all the tables we're planning on supporting 
      */
     initialize_table_nsModuleTable();
+    initialize_table_nsModuleStatsTable();
 }
 
 /** returns the first data point within the nsModuleTable table data.
@@ -320,3 +321,234 @@ nsModuleTable_handler(netsnmp_mib_handler *handler,
     }
     return SNMP_ERR_NOERROR;
 }
+
+static Netsnmp_Make_Data_Context _nsModuleStats_make_data_context;
+
+/** Initialize the nsModuleStatsTable table, which shares the indexes
+    of the nsModuleTable, with the type of request added */
+void
+initialize_table_nsModuleStatsTable(void)
+{
+    const oid nsModuleStatsTable_oid[] = { 1, 3, 6, 1, 4, 1, 8072, 1, 2, 2 };
+    netsnmp_table_registration_info *table_info;
+    netsnmp_handler_registration *my_handler;
+    netsnmp_iterator_info *iinfo;
+
+    table_info = SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
+    iinfo = SNMP_MALLOC_TYPEDEF(netsnmp_iterator_info);
+
+    my_handler = netsnmp_create_handler_registration("nsModuleStatsTable",
+                                                     nsModuleStatsTable_handler,
+                                                     nsModuleStatsTable_oid,
+                                                     OID_LENGTH
+                                                     (nsModuleStatsTable_oid),
+                                                     HANDLER_CAN_RONLY);
+
+    if (!my_handler || !table_info || !iinfo) {
+        if (my_handler)
+            netsnmp_handler_registration_free(my_handler);
+        SNMP_FREE(table_info);
+        SNMP_FREE(iinfo);
+        return;                 /* mallocs failed */
+    }
+
+    netsnmp_table_helper_add_indexes(table_info, ASN_OCTET_STR, /* context name */
+                                     ASN_OBJECT_ID,     /* reg point */
+                                     ASN_INTEGER,       /* priority */
+                                     ASN_INTEGER,       /* request type */
+                                     0);
+
+    table_info->min_column = COLUMN_NSMSCALLS;
+    table_info->max_column = COLUMN_NSMSLATENCYHISTOGRAM;
+
+    iinfo->get_first_data_point = nsModuleStatsTable_get_first_data_point;
+    iinfo->get_next_data_point = nsModuleStatsTable_get_next_data_point;
+    iinfo->make_data_context = _nsModuleStats_make_data_context;
+    iinfo->free_data_context = nsModuleTable_free;
+    iinfo->free_loop_context_at_end = nsModuleTable_free;
+    iinfo->table_reginfo = table_info;
+
+    DEBUGMSGTL(("initialize_table_nsModuleStatsTable",
+                "Registering table nsModuleStatsTable as a table iterator\n"));
+    netsnmp_register_table_iterator2(my_handler, iinfo);
+}
+
+/*
+ * The rows are the registrations of the nsModuleTable, one for each type
+ * of request their handler has been called for.
+ */
+typedef struct stats_loop_ctx_s {
+    netsnmp_subtree *tree;
+    subtree_context_cache *context_ptr;
+    int             kind;
+} stats_loop_ctx;
+
+/*
+ * Moves the loop context on to the next row; returns 0 when there is none.
+ */
+static int
+_nsModuleStats_advance(stats_loop_ctx *ctx)
+{
+    netsnmp_handler_stats *stats;
+
+    for (;;) {
+        if (ctx->tree && ctx->tree->reginfo &&
+            (stats = ctx->tree->reginfo->stats) != NULL) {
+            while (++ctx->kind < NETSNMP_HANDLER_STATS_MODES)
+                if (stats->calls[ctx->kind])
+                    return 1;
+        }
+        ctx->kind = -1;
+        if (ctx->tree)
+            ctx->tree = ctx->tree->next;
+        while (!ctx->tree) {
+            if (!ctx->context_ptr)
+                return 0;
+            ctx->context_ptr = ctx->context_ptr->next;
+            if (!ctx->context_ptr)
+                return 0;
+            ctx->tree = ctx->context_ptr->first_subtree;
+        }
+    }
+}
+
+/*
+ * the loop context moves on, so matching rows get a copy of it
+ */
+static void    *
+_nsModuleStats_make_data_context(void *loop_context,
+                                 netsnmp_iterator_info *iinfo)
+{
+    return netsnmp_memdup(loop_context, sizeof(stats_loop_ctx));
+}
+
+static netsnmp_variable_list *
+_nsModuleStats_set_index(stats_loop_ctx *ctx, void **my_data_context,
+                         netsnmp_variable_list *put_index_data)
+{
+    netsnmp_variable_list *vptr;
+    u_long          ultmp;
+
+    *my_data_context = NULL;    /* see _nsModuleStats_make_data_context */
+
+    vptr = put_index_data;
+    snmp_set_var_value(vptr, ctx->context_ptr->context_name,
+                       strlen(ctx->context_ptr->context_name));
+
+    vptr = vptr->next_variable;
+    snmp_set_var_value(vptr, ctx->tree->name_a,
+                       ctx->tree->namelen * sizeof(oid));
+
+    ultmp = ctx->tree->priority;
+    vptr = vptr->next_variable;
+    snmp_set_var_value(vptr, &ultmp, sizeof(ultmp));
+
+    ultmp = ctx->kind + 1;
+    vptr = vptr->next_variable;
+    snmp_set_var_value(vptr, &ultmp, sizeof(ultmp));
+
+    return put_index_data;
+}
+
+netsnmp_variable_list *
+nsModuleStatsTable_get_first_data_point(void **my_loop_context,
+                                        void **my_data_context,
+                                        netsnmp_variable_list *
+                                        put_index_data,
+                                        netsnmp_iterator_info *otherstuff)
+{
+    stats_loop_ctx *ctx;
+
+    ctx = SNMP_MALLOC_TYPEDEF(stats_loop_ctx);
+    if (!ctx)
+        return NULL;
+    *my_loop_context = ctx;
+
+    ctx->context_ptr = get_top_context_cache();
+    if (!ctx->context_ptr)
+        return NULL;
+    ctx->tree = ctx->context_ptr->first_subtree;
+    ctx->kind = -1;
+    if (!_nsModuleStats_advance(ctx))
+        return NULL;
+
+    return _nsModuleStats_set_index(ctx, my_data_context, put_index_data);
+}
+
+netsnmp_variable_list *
+nsModuleStatsTable_get_next_data_point(void **my_loop_context,
+                                       void **my_data_context,
+                                       netsnmp_variable_list *put_index_data,
+                                       netsnmp_iterator_info *otherstuff)
+{
+    stats_loop_ctx *ctx = (stats_loop_ctx *) *my_loop_context;
+
+    if (!_nsModuleStats_advance(ctx))
+        return NULL;
+
+    return _nsModuleStats_set_index(ctx, my_data_context, put_index_data);
+}
+
+/** handles requests for the nsModuleStatsTable table */
+int
+nsModuleStatsTable_handler(netsnmp_mib_handler *handler,
+                           netsnmp_handler_registration *reginfo,
+                           netsnmp_agent_request_info *reqinfo,
+                           netsnmp_request_info *requests)
+{
+    netsnmp_table_request_info *table_info;
+    netsnmp_request_info *request;
+    netsnmp_handler_stats *stats;
+    stats_loop_ctx *ctx;
+    u_char          histogram[NETSNMP_HANDLER_STATS_BUCKETS * 4];
+    u_long          ultmp;
+    int             i;
+
+    if (reqinfo->mode != MODE_GET)
+        return SNMP_ERR_NOERROR;
+
+    for (request = requests; request; request = request->next) {
+        if (request->processed != 0)
+            continue;
+
+        ctx = (stats_loop_ctx *) netsnmp_extract_iterator_context(request);
+        table_info = netsnmp_extract_table_info(request);
+        if (ctx == NULL || table_info == NULL ||
+            (stats = ctx->tree->reginfo->stats) == NULL) {
+            netsnmp_set_request_error(reqinfo, request,
+                                      SNMP_NOSUCHINSTANCE);
+            continue;
+        }
+
+        switch (table_info->colnum) {
+        case COLUMN_NSMSCALLS:
+            ultmp = stats->calls[ctx->kind] & 0xffffffff;
+            snmp_set_var_typed_value(request->requestvb, ASN_COUNTER,
+                                     (u_char *) &ultmp, sizeof(ultmp));
+            break;
+
+        case COLUMN_NSMSMAXLATENCY:
+            ultmp = stats->max_usec[ctx->kind] & 0xffffffff;
+            snmp_set_var_typed_value(request->requestvb, ASN_UNSIGNED,
+                                     (u_char *) &ultmp, sizeof(ultmp));
+            break;
+
+        case COLUMN_NSMSLATENCYHISTOGRAM:
+            for (i = 0; i < NETSNMP_HANDLER_STATS_BUCKETS; i++) {
+                ultmp = stats->buckets[ctx->kind][i];
+                histogram[4 * i] = (ultmp >> 24) & 0xff;
+                histogram[4 * i + 1] = (ultmp >> 16) & 0xff;
+                histogram[4 * i + 2] = (ultmp >> 8) & 0xff;
+                histogram[4 * i + 3] = ultmp & 0xff;
+            }
+            snmp_set_var_typed_value(request->requestvb, ASN_OCTET_STR,
+                                     histogram, sizeof(histogram));
+            break;
+
+        default:
+            snmp_log(LOG_ERR,
+                     "problem encountered in nsModuleStatsTable_handler: unknown column\n");
+        }
+    }
+    return SNMP_ERR_NOERROR;
+}
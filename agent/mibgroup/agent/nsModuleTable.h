@@ -15,6 +15,12 @@ Netsnmp_Node_Handler nsModuleTable_handler;
 Netsnmp_First_Data_Point nsModuleTable_get_first_data_point;
 Netsnmp_Next_Data_Point nsModuleTable_get_next_data_point;
 
+void            initialize_table_nsModuleStatsTable(void);
+Netsnmp_Node_Handler nsModuleStatsTable_handler;
+
+Netsnmp_First_Data_Point nsModuleStatsTable_get_first_data_point;
+Netsnmp_Next_Data_Point nsModuleStatsTable_get_next_data_point;
+
 /*
  * column number definitions for table nsModuleTable 
  */
@@ -24,4 +30,12 @@ Netsnmp_Next_Data_Point nsModuleTable_get_next_data_point;
 #define COLUMN_NSMODULENAME		4
 #define COLUMN_NSMODULEMODES		5
 #define COLUMN_NSMODULETIMEOUT		6
+
+/*
+ * column number definitions for table nsModuleStatsTable 
+ */
+#define COLUMN_NSMSREQUESTTYPE		1
+#define COLUMN_NSMSCALLS		2
+#define COLUMN_NSMSMAXLATENCY		3
+#define COLUMN_NSMSLATENCYHISTOGRAM	4
 #endif                          /* NSMODULETABLE_H */
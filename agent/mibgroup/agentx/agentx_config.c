@@ -138,6 +138,39 @@ agentx_parse_agentx_retries(const char *token, char *cptr)
     netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
                        NETSNMP_DS_AGENT_AGENTX_RETRIES, x);
 }
+
+void
+agentx_parse_agentx_coalesce(const char *token, char *cptr)
+{
+    int i = netsnmp_ds_parse_boolean(cptr);
+    DEBUGMSGTL(("agentx/config/coalesce", "%s\n", cptr));
+    if (i < 0) {
+        config_perror("Invalid coalesce value (expected yes or no)");
+        return;
+    }
+    netsnmp_ds_set_boolean(NETSNMP_DS_APPLICATION_ID,
+                           NETSNMP_DS_AGENT_AGENTX_COALESCE, i);
+}
+
+void
+agentx_parse_agentx_batch(const char *token, char *cptr)
+{
+    char *delay = NULL;
+    int x = (int) strtol(cptr, &delay, 10);
+    int msec = 0;
+
+    DEBUGMSGTL(("agentx/config/batch", "%s\n", cptr));
+    if (delay && *delay)
+        msec = atoi(delay);
+    if (x < 0 || msec < 0) {
+        config_perror("Invalid batch value (expected MAXVARBINDS [MSEC])");
+        return;
+    }
+    netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_AGENTX_BATCH, x);
+    netsnmp_ds_set_int(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_AGENTX_BATCH_DELAY, msec);
+}
 #endif                          /* USING_AGENTX_MASTER_MODULE */
 
 #ifdef USING_AGENTX_SUBAGENT_MODULE
@@ -229,6 +262,12 @@ agentx_config_init(void)
     agentx_register_config_handler("agentxperms",
                                   agentx_parse_agentx_perms, NULL,
                                   "AgentX socket permissions: socket_perms [directory_perms [username|userid [groupname|groupid]]]");
+    agentx_register_config_handler("agentxCoalesce",
+                                  agentx_parse_agentx_coalesce, NULL,
+                                  "share identical AgentX read requests: yes|no");
+    agentx_register_config_handler("agentxBatch",
+                                  agentx_parse_agentx_batch, NULL,
+                                  "combine AgentX read requests: max_varbinds [msec]");
     }
 #endif                          /* USING_AGENTX_MASTER_MODULE */
 
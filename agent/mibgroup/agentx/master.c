@@ -203,80 +203,190 @@ real_init_master(void)
     DEBUGMSGTL(("agentx/master", "initializing...   DONE\n"));
 }
 
-        /*
-         * Handle the response from an AgentX subagent,
-         *   merging the answers back into the original query
-         */
-int
-agentx_got_response(int operation,
-                    netsnmp_session * session,
-                    int reqid, netsnmp_pdu *pdu, void *magic)
+/*
+ * Read requests outstanding to subagents.  With agentxCoalesce enabled,
+ * a request identical to one of these (same subagent session, context
+ * and varbinds, including the GETNEXT range ends) is not sent again, but
+ * is added to the waiters of the earlier one and answered from its
+ * response.
+ *
+ * With agentxBatch set, read requests are not sent straight away but
+ * queued until the alarms are next run (or the given delay is up).
+ * Requests queued in the meantime for the same subagent session, context
+ * and command are then sent together in a single PDU, up to that many
+ * varbinds, and the response is split up between them again.  These are
+ * queries from different managers, or GETBULK repetitions resumed by the
+ * same burst of responses from the subagent.
+ */
+typedef struct agentx_waiter_s {
+    netsnmp_delegated_cache *cache;
+    struct agentx_waiter_s  *next;
+} agentx_waiter;
+
+typedef struct agentx_request_s {
+    netsnmp_session *session;
+    int              command;
+    long             sessid;
+    char            *context;
+    size_t           context_len;
+    netsnmp_variable_list *vars;        /* NULL if not to be shared */
+    agentx_waiter   *waiters;
+    netsnmp_pdu     *pdu;               /* own PDU, if batched */
+    size_t           nvars;             /* number of varbinds in it */
+    size_t           batch_nvars;       /* total, in the first of a batch */
+    struct agentx_request_s *batch;     /* next request in the same PDU */
+    struct agentx_request_s *pending;   /* next batch waiting to be sent */
+    struct agentx_request_s *next;
+} agentx_request;
+
+static agentx_request *agentx_outstanding = NULL;
+static agentx_request *agentx_pending = NULL;
+static unsigned int agentx_pending_alarm = 0;
+
+static agentx_request *
+agentx_request_new(netsnmp_session *session, netsnmp_pdu *pdu,
+                   netsnmp_delegated_cache *cache, int shared)
 {
-    netsnmp_delegated_cache *cache = (netsnmp_delegated_cache *) magic;
-    int             i, ret;
-    netsnmp_request_info *requests, *request;
-    netsnmp_variable_list *var;
-    netsnmp_session *ax_session;
+    agentx_request *ar = SNMP_MALLOC_TYPEDEF(agentx_request);
+    agentx_waiter  *w = SNMP_MALLOC_TYPEDEF(agentx_waiter);
 
-    cache = netsnmp_handler_check_cache(cache);
-    if (!cache) {
-        DEBUGMSGTL(("agentx/master", "response too late on session %8p\n",
-                    session));
-        /* response is too late, free the cache */
-        if (magic)
-            netsnmp_free_delegated_cache((netsnmp_delegated_cache*) magic);
-        return 1;
+    if (!ar || !w) {
+        free(ar);
+        free(w);
+        return NULL;
     }
-    requests = cache->requests;
+    w->cache = cache;
+    ar->waiters = w;
+    ar->session = session;
+    ar->command = pdu->command;
+    ar->sessid = pdu->sessid;
+    if (shared) {
+        ar->vars = snmp_clone_varbind(pdu->variables);
+        if (ar->vars && pdu->community_len) {
+            ar->context = netsnmp_memdup(pdu->community, pdu->community_len);
+            ar->context_len = pdu->community_len;
+            if (!ar->context) {
+                snmp_free_varbind(ar->vars);
+                ar->vars = NULL;
+            }
+        }
+    }
+    ar->next = agentx_outstanding;
+    agentx_outstanding = ar;
+    return ar;
+}
 
-    switch (operation) {
-    case NETSNMP_CALLBACK_OP_TIMED_OUT:{
-            struct session_list *s = snmp_sess_pointer(session);
-            DEBUGMSGTL(("agentx/master", "timeout on session %8p req=0x%x\n",
-                        session, (unsigned)reqid));
+static void
+agentx_request_unlink(agentx_request *ar)
+{
+    agentx_request **prev;
 
-            netsnmp_handler_mark_requests_as_delegated(requests,
-                                       REQUEST_IS_NOT_DELEGATED);
-            netsnmp_set_request_error(cache->reqinfo, requests,
-                                      /* XXXWWW: should be index=0 */
-                                      SNMP_ERR_GENERR);
+    for (prev = &agentx_outstanding; *prev; prev = &(*prev)->next)
+        if (*prev == ar) {
+            *prev = ar->next;
+            break;
+        }
+}
 
-            /*
-             * This is a bit sledgehammer because the other sessions on this
-             * transport may be okay (e.g. some thread in the subagent has
-             * wedged, but the others are alright).  OTOH the overwhelming
-             * probability is that the whole agent has died somehow.  
-             */
+static void
+agentx_request_free(agentx_request *ar)
+{
+    agentx_waiter *w;
 
-            if (s != NULL) {
-                netsnmp_transport *t = snmp_sess_transport(s);
-                close_agentx_session(session, -1);
+    while ((w = ar->waiters) != NULL) {
+        ar->waiters = w->next;
+        free(w);
+    }
+    snmp_free_varbind(ar->vars);
+    snmp_free_pdu(ar->pdu);
+    free(ar->context);
+    free(ar);
+}
 
-                if (t != NULL) {
-                    DEBUGMSGTL(("agentx/master", "close transport\n"));
-                    t->f_close(t);
-                } else {
-                    DEBUGMSGTL(("agentx/master", "NULL transport??\n"));
-                }
-            } else {
-                DEBUGMSGTL(("agentx/master", "NULL sess_pointer??\n"));
-            }
-            ax_session = (netsnmp_session *) cache->localinfo;
-            netsnmp_free_agent_snmp_session_by_session(ax_session, NULL);
-            netsnmp_free_delegated_cache(cache);
-            return 0;
+static void
+agentx_request_free_batch(agentx_request *ar)
+{
+    agentx_request *next;
+
+    for (; ar; ar = next) {
+        next = ar->batch;
+        agentx_request_free(ar);
+    }
+}
+
+/*
+ * Take a request out of its batch, so that it can be sent again alone
+ */
+static agentx_request *
+agentx_request_detach(agentx_request *part)
+{
+    agentx_request *ar = SNMP_MALLOC_TYPEDEF(agentx_request);
+
+    if (!ar || !part->pdu) {
+        free(ar);
+        return NULL;
+    }
+    *ar = *part;
+    ar->batch = NULL;
+    ar->pending = NULL;
+    ar->batch_nvars = ar->nvars;
+    ar->next = agentx_outstanding;
+    agentx_outstanding = ar;
+    part->waiters = NULL;
+    part->vars = NULL;
+    part->pdu = NULL;
+    part->context = NULL;
+    return ar;
+}
+
+static void     agentx_send_batch(agentx_request *ar);
+
+static agentx_request *
+agentx_request_find(netsnmp_session *session, netsnmp_pdu *pdu)
+{
+    agentx_request *ar;
+    netsnmp_variable_list *v1, *v2;
+
+    for (ar = agentx_outstanding; ar; ar = ar->next) {
+        if (!ar->vars || ar->session != session ||
+            ar->command != pdu->command || ar->sessid != pdu->sessid ||
+            ar->context_len != pdu->community_len ||
+            (ar->context_len &&
+             memcmp(ar->context, pdu->community, ar->context_len) != 0))
+            continue;
+        for (v1 = ar->vars, v2 = pdu->variables; v1 && v2;
+             v1 = v1->next_variable, v2 = v2->next_variable) {
+            if (v1->type != v2->type || v1->val_len != v2->val_len ||
+                snmp_oid_compare(v1->name, v1->name_length,
+                                 v2->name, v2->name_length) != 0 ||
+                (v1->val_len &&
+                 memcmp(v1->val.string, v2->val.string, v1->val_len) != 0))
+                break;
         }
+        if (!v1 && !v2)
+            return ar;
+    }
+    return NULL;
+}
 
+        /*
+         * Merge the response from an AgentX subagent back into
+         *   one of the original queries waiting for it
+         */
+static int
+agentx_answer_waiter(int operation, netsnmp_delegated_cache *cache,
+                     netsnmp_pdu *pdu)
+{
+    int             i, ret;
+    netsnmp_request_info *requests, *request;
+    netsnmp_variable_list *var;
+
+    requests = cache->requests;
+
+    switch (operation) {
+    case NETSNMP_CALLBACK_OP_TIMED_OUT:
     case NETSNMP_CALLBACK_OP_DISCONNECT:
     case NETSNMP_CALLBACK_OP_SEND_FAILED:
-        if (operation == NETSNMP_CALLBACK_OP_DISCONNECT) {
-            DEBUGMSGTL(("agentx/master", "disconnect on session %8p\n",
-                        session));
-        } else {
-            DEBUGMSGTL(("agentx/master", "send failed on session %8p\n",
-                        session));
-        }
-        close_agentx_session(session, -1);
         netsnmp_handler_mark_requests_as_delegated(requests,
                                                    REQUEST_IS_NOT_DELEGATED);
         netsnmp_set_request_error(cache->reqinfo, requests,     /* XXXWWW: should be index=0 */
@@ -284,17 +394,9 @@ agentx_got_response(int operation,
         netsnmp_free_delegated_cache(cache);
         return 0;
 
-    case NETSNMP_CALLBACK_OP_RESEND:
-        DEBUGMSGTL(("agentx/master", "resend on session %8p req=0x%x\n",
-                    session, (unsigned)reqid));
-        return 0;
-
     case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
-        /*
-         * This session is alive 
-         */
-        CLEAR_SNMP_STRIKE_FLAGS(session->flags);
         break;
+
     default:
         snmp_log(LOG_ERR, "Unknown operation %d in agentx_got_response\n",
                  operation);
@@ -302,11 +404,6 @@ agentx_got_response(int operation,
         return 0;
     }
 
-    DEBUGMSGTL(("agentx/master", "got response errstat=%ld, (req=0x%x,trans="
-                "0x%x,sess=0x%x)\n",
-                pdu->errstat, (unsigned)pdu->reqid, (unsigned)pdu->transid,
-		(unsigned)pdu->sessid));
-
     if (pdu->errstat != AGENTX_ERR_NOERROR) {
         /* [RFC 2471 - 7.2.5.2.]
          *
@@ -426,6 +523,338 @@ agentx_got_response(int operation,
     return 1;
 }
 
+/*
+ * Split the response to a batch of requests between them.  If the
+ * subagent failed one of the varbinds, it will have stopped there, so
+ * the other requests of the batch are sent again on their own.
+ */
+static int
+agentx_answer_batch(agentx_request *ar, netsnmp_pdu *pdu)
+{
+    agentx_request *part, *retry;
+    agentx_waiter  *w;
+    netsnmp_variable_list *var = pdu->variables, *last, *rest;
+    netsnmp_pdu     answer;
+    long            first = 1;
+    size_t          i;
+    int             ret = 1;
+
+    for (part = ar; part; part = part->batch) {
+        answer = *pdu;
+        answer.variables = var;
+        for (i = 1, last = var; last && i < part->nvars; i++)
+            last = last->next_variable;
+        rest = last ? last->next_variable : NULL;
+        if (last)
+            last->next_variable = NULL;
+
+        retry = NULL;
+        if (pdu->errstat != AGENTX_ERR_NOERROR && pdu->errindex != 0) {
+            if (pdu->errindex >= first &&
+                pdu->errindex < first + (long) part->nvars)
+                answer.errindex = pdu->errindex - first + 1;
+            else
+                retry = agentx_request_detach(part);
+        }
+        if (retry) {
+            DEBUGMSGTL(("agentx/master", "resending unanswered request\n"));
+            agentx_send_batch(retry);
+        } else
+            for (w = part->waiters; w; w = w->next)
+                if (w->cache)
+                    ret = agentx_answer_waiter(
+                        NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE, w->cache,
+                        &answer);
+
+        if (last)
+            last->next_variable = rest;
+        var = rest;
+        first += part->nvars;
+    }
+    return ret;
+}
+
+        /*
+         * Handle the response from an AgentX subagent,
+         *   merging the answers back into the original queries
+         */
+int
+agentx_got_response(int operation,
+                    netsnmp_session * session,
+                    int reqid, netsnmp_pdu *pdu, void *magic)
+{
+    agentx_request *ar = (agentx_request *) magic, *part;
+    agentx_waiter  *w;
+    netsnmp_delegated_cache *cache;
+    netsnmp_session *ax_session = NULL;
+    int             ret = 1;
+
+    if (!ar)
+        return 1;
+
+    if (operation == NETSNMP_CALLBACK_OP_RESEND) {
+        DEBUGMSGTL(("agentx/master", "resend on session %8p req=0x%x\n",
+                    session, (unsigned)reqid));
+        return 0;
+    }
+
+    /*
+     * Drop the waiters whose queries have gone away in the meantime.
+     */
+    for (part = ar; part; part = part->batch) {
+        agentx_request_unlink(part);
+        for (w = part->waiters; w; w = w->next) {
+            cache = netsnmp_handler_check_cache(w->cache);
+            if (!cache) {
+                DEBUGMSGTL(("agentx/master",
+                            "response too late on session %8p\n", session));
+                /* response is too late, free the cache */
+                netsnmp_free_delegated_cache(w->cache);
+            } else
+                ax_session = (netsnmp_session *) cache->localinfo;
+            w->cache = cache;
+        }
+    }
+    if (!ax_session) {
+        agentx_request_free_batch(ar);
+        return 1;
+    }
+
+    switch (operation) {
+    case NETSNMP_CALLBACK_OP_TIMED_OUT:
+        DEBUGMSGTL(("agentx/master", "timeout on session %8p req=0x%x\n",
+                    session, (unsigned)reqid));
+        break;
+    case NETSNMP_CALLBACK_OP_DISCONNECT:
+        DEBUGMSGTL(("agentx/master", "disconnect on session %8p\n",
+                    session));
+        break;
+    case NETSNMP_CALLBACK_OP_SEND_FAILED:
+        DEBUGMSGTL(("agentx/master", "send failed on session %8p\n",
+                    session));
+        break;
+    case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
+        /*
+         * This session is alive 
+         */
+        CLEAR_SNMP_STRIKE_FLAGS(session->flags);
+        DEBUGMSGTL(("agentx/master", "got response errstat=%ld, (req=0x%x,trans="
+                    "0x%x,sess=0x%x)\n",
+                    pdu->errstat, (unsigned)pdu->reqid, (unsigned)pdu->transid,
+                    (unsigned)pdu->sessid));
+        break;
+    }
+
+    /*
+     * Answer every waiter before the session is closed below, as that
+     * may complete (and free) the agent sessions they belong to.
+     */
+    if (ar->batch && operation == NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE)
+        ret = agentx_answer_batch(ar, pdu);
+    else
+        for (part = ar; part; part = part->batch)
+            for (w = part->waiters; w; w = w->next)
+                if (w->cache)
+                    ret = agentx_answer_waiter(operation, w->cache, pdu);
+    agentx_request_free_batch(ar);
+
+    switch (operation) {
+    case NETSNMP_CALLBACK_OP_TIMED_OUT:{
+            struct session_list *s = snmp_sess_pointer(session);
+
+            /*
+             * This is a bit sledgehammer because the other sessions on this
+             * transport may be okay (e.g. some thread in the subagent has
+             * wedged, but the others are alright).  OTOH the overwhelming
+             * probability is that the whole agent has died somehow.  
+             */
+
+            if (s != NULL) {
+                netsnmp_transport *t = snmp_sess_transport(s);
+                close_agentx_session(session, -1);
+
+                if (t != NULL) {
+                    DEBUGMSGTL(("agentx/master", "close transport\n"));
+                    t->f_close(t);
+                } else {
+                    DEBUGMSGTL(("agentx/master", "NULL transport??\n"));
+                }
+            } else {
+                DEBUGMSGTL(("agentx/master", "NULL sess_pointer??\n"));
+            }
+            netsnmp_free_agent_snmp_session_by_session(ax_session, NULL);
+            break;
+        }
+
+    case NETSNMP_CALLBACK_OP_DISCONNECT:
+    case NETSNMP_CALLBACK_OP_SEND_FAILED:
+        close_agentx_session(session, -1);
+        break;
+    }
+    return ret;
+}
+
+/*
+ * Stop the queries waiting on a (batch of) request(s) that could not be
+ * sent, unless agentx_got_response() has already been told.  The caches
+ * of requests that were queued have to be checked first.
+ */
+static void
+agentx_request_fail(agentx_request *ar, int queued)
+{
+    agentx_request *part;
+    agentx_waiter  *w;
+    netsnmp_delegated_cache *cache;
+
+    for (part = agentx_outstanding; part; part = part->next)
+        if (part == ar)
+            break;
+    if (!part)
+        return;
+
+    for (part = ar; part; part = part->batch) {
+        agentx_request_unlink(part);
+        for (w = part->waiters; w; w = w->next) {
+            cache = queued ? netsnmp_handler_check_cache(w->cache) : w->cache;
+            if (cache)
+                agentx_answer_waiter(NETSNMP_CALLBACK_OP_SEND_FAILED,
+                                     cache, NULL);
+            else
+                netsnmp_free_delegated_cache(w->cache);
+        }
+    }
+    agentx_request_free_batch(ar);
+}
+
+/*
+ * Send a queued request, together with the others batched with it
+ */
+static void
+agentx_send_batch(agentx_request *ar)
+{
+    agentx_request *part;
+    netsnmp_variable_list *tail;
+    netsnmp_pdu    *pdu;
+
+    if (!ar->batch) {
+        pdu = ar->pdu;
+        ar->pdu = NULL;
+    } else {
+        pdu = snmp_clone_pdu(ar->pdu);
+        for (tail = pdu ? pdu->variables : NULL; tail && tail->next_variable;
+             tail = tail->next_variable)
+            ;
+        for (part = ar->batch; pdu && part; part = part->batch) {
+            if (!tail ||
+                !(tail->next_variable =
+                  snmp_clone_varbind(part->pdu->variables))) {
+                snmp_free_pdu(pdu);
+                pdu = NULL;
+                break;
+            }
+            while (tail->next_variable)
+                tail = tail->next_variable;
+        }
+        DEBUGMSGTL(("agentx/master", "batched %lu varbinds on session %8p\n",
+                    (unsigned long)ar->batch_nvars, ar->session));
+    }
+
+    if (pdu) {
+        DEBUGMSGTL(("agentx/master", "sending pdu (req=0x%x,trans=0x%x,sess=0x%x)\n",
+                    (unsigned)pdu->reqid, (unsigned)pdu->transid,
+                    (unsigned)pdu->sessid));
+        if (snmp_async_send(ar->session, pdu, agentx_got_response, ar))
+            return;
+        snmp_free_pdu(pdu);
+    }
+    agentx_request_fail(ar, 1);
+}
+
+static void
+agentx_send_pending(unsigned int clientreg, void *clientarg)
+{
+    agentx_request *ar;
+
+    agentx_pending_alarm = 0;
+    while ((ar = agentx_pending) != NULL) {
+        agentx_pending = ar->pending;
+        ar->pending = NULL;
+        agentx_send_batch(ar);
+    }
+}
+
+/*
+ * Queue a read request to be sent once the alarms are next run, adding
+ * it to an earlier one for the same subagent session if there is room.
+ * Returns 0 if it should be sent straight away instead.
+ */
+static int
+agentx_request_queue(agentx_request *ar, netsnmp_pdu *pdu, size_t max)
+{
+    agentx_request **prev, *head;
+    netsnmp_variable_list *var;
+
+    if (!agentx_pending_alarm) {
+        int             msec =
+            netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_AGENTX_BATCH_DELAY);
+        struct timeval  t;
+
+        t.tv_sec = msec / 1000;
+        t.tv_usec = msec % 1000 * 1000 + 1;
+        agentx_pending_alarm =
+            snmp_alarm_register_hr(t, 0, agentx_send_pending, NULL);
+        if (!agentx_pending_alarm)
+            return 0;
+    }
+
+    ar->pdu = pdu;
+    for (var = pdu->variables; var; var = var->next_variable)
+        ar->nvars++;
+    for (prev = &agentx_pending; (head = *prev) != NULL;
+         prev = &head->pending) {
+        if (head->session == ar->session && head->command == ar->command &&
+            head->sessid == ar->sessid &&
+            head->pdu->flags == pdu->flags &&
+            head->pdu->community_len == pdu->community_len &&
+            (!pdu->community_len ||
+             memcmp(head->pdu->community, pdu->community,
+                    pdu->community_len) == 0) &&
+            head->batch_nvars + ar->nvars <= max) {
+            ar->batch = head->batch;
+            head->batch = ar;
+            head->batch_nvars += ar->nvars;
+            return 1;
+        }
+    }
+    ar->batch_nvars = ar->nvars;
+    *prev = ar;
+    return 1;
+}
+
+/*
+ * Fail the requests still queued for a subagent session that is closing.
+ * This is either the transport session, which takes all its subsessions
+ * with it, or a single subsession.
+ */
+void
+agentx_cancel_pending(netsnmp_session *session)
+{
+    agentx_request **prev, *ar;
+
+    for (prev = &agentx_pending; (ar = *prev) != NULL;) {
+        if (ar->session == session || ar->session->subsession == session ||
+            ((session->flags & SNMP_FLAGS_SUBSESSION) &&
+             ar->session == session->subsession &&
+             ar->sessid == session->sessid)) {
+            *prev = ar->pending;
+            ar->pending = NULL;
+            agentx_request_fail(ar, 1);
+        } else
+            prev = &ar->pending;
+    }
+}
+
 /*
  *
  * AgentX State diagram.  [mode] = internal mode it's mapped from:
@@ -448,6 +877,8 @@ agentx_master_handler(netsnmp_mib_handler *handler,
     netsnmp_session *ax_session = (netsnmp_session *) handler->myvoid;
     netsnmp_request_info *request = requests;
     netsnmp_pdu    *pdu;
+    netsnmp_delegated_cache *cache;
+    agentx_request *ar;
     void           *cb_data;
     int             result;
 
@@ -472,7 +903,11 @@ agentx_master_handler(netsnmp_mib_handler *handler,
         pdu = snmp_pdu_create(AGENTX_MSG_GETNEXT);
         break;
 
-    case MODE_GETBULK:         /* WWWXXX */
+    case MODE_GETBULK:
+        /*
+         * each repetition is asked for as a GETNEXT; with agentxBatch,
+         * those for several subtrees of this subagent share one PDU
+         */
         pdu = snmp_pdu_create(AGENTX_MSG_GETNEXT);
         break;
 
@@ -602,11 +1037,45 @@ agentx_master_handler(netsnmp_mib_handler *handler,
      * back from the subagent. So we shouldn't allocate the
      * netsnmp_delegated_cache structure in this case.
      */
-    if (pdu->command != AGENTX_MSG_CLEANUPSET)
-        cb_data = netsnmp_create_delegated_cache(handler, reginfo,
-                                                 reqinfo, requests,
-                                                 (void *) ax_session);
-    else
+    if (pdu->command != AGENTX_MSG_CLEANUPSET) {
+        int read = (pdu->command == AGENTX_MSG_GET ||
+                    pdu->command == AGENTX_MSG_GETNEXT);
+        int shared = read &&
+            netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                                   NETSNMP_DS_AGENT_AGENTX_COALESCE);
+        int batch = read ?
+            netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_AGENTX_BATCH) : 0;
+
+        cache = netsnmp_create_delegated_cache(handler, reginfo,
+                                               reqinfo, requests,
+                                               (void *) ax_session);
+        if (shared && cache &&
+            (ar = agentx_request_find(ax_session, pdu)) != NULL) {
+            agentx_waiter *w = SNMP_MALLOC_TYPEDEF(agentx_waiter);
+            if (w) {
+                /*
+                 * an identical request is already on its way,
+                 * so just wait for its response
+                 */
+                DEBUGMSGTL(("agentx/master",
+                            "sharing outstanding request on session %8p\n",
+                            ax_session));
+                w->cache = cache;
+                w->next = ar->waiters;
+                ar->waiters = w;
+                snmp_free_pdu(pdu);
+                return SNMP_ERR_NOERROR;
+            }
+        }
+        cb_data = cache ? agentx_request_new(ax_session, pdu, cache, shared)
+                        : NULL;
+        if (cache && !cb_data)
+            netsnmp_free_delegated_cache(cache);
+        if (cb_data && batch > 0 &&
+            agentx_request_queue((agentx_request *) cb_data, pdu, batch))
+            return SNMP_ERR_NOERROR;
+    } else
         cb_data = NULL;
 
     /*
@@ -617,6 +1086,8 @@ agentx_master_handler(netsnmp_mib_handler *handler,
     result = snmp_async_send(ax_session, pdu, agentx_got_response, cb_data);
     if (result == 0) {
         snmp_free_pdu(pdu);
+        if (cb_data)
+            agentx_request_fail((agentx_request *) cb_data, 0);
     }
 
     return SNMP_ERR_NOERROR;
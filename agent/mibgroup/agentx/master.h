@@ -10,5 +10,6 @@ config_require(agentx/agentx_config)
      void            init_master(void);
      void            real_init_master(void);
      Netsnmp_Node_Handler agentx_master_handler;
+     void            agentx_cancel_pending(netsnmp_session *session);
 
 #endif                          /* _AGENTX_MASTER_H */
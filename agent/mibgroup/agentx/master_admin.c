@@ -136,6 +136,7 @@ close_agentx_session(netsnmp_session * session, int sessid)
          * requests, so that the delegated request will be completed and
          * further requests can be processed
          */
+        agentx_cancel_pending(session);
 	while (netsnmp_remove_delegated_requests_for_session(session)) {
 		DEBUGMSGTL(("agentx/master", "Continue removing delegated reqests\n"));
 	}
@@ -161,6 +162,7 @@ close_agentx_session(netsnmp_session * session, int sessid)
     for (sp = session->subsession; sp != NULL; sp = sp->next) {
 
         if (sp->sessid == sessid) {
+            agentx_cancel_pending(sp);
             netsnmp_remove_delegated_requests_for_session(sp);
             unregister_mibs_by_session(sp);
             unregister_index_by_session(sp);
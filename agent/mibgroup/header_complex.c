@@ -261,16 +261,104 @@ header_complex_get(struct header_complex_index *datalist,
     return header_complex_get_from_oid(datalist, searchfor, searchfor_len);
 }
 
+/*
+ * Besides the linked list, which callers walk directly, the entries of a
+ * list are kept sorted in a table_container shared by all of them.
+ * Entries are ordered by name and then, since duplicate names are
+ * allowed, by address. A search key has no index and sorts before every
+ * entry with the same name, so CONTAINER_NEXT on it returns the first
+ * entry at or after the name.
+ */
+static int
+_header_complex_compare(const void *lhs, const void *rhs)
+{
+    const struct header_complex_index *a = lhs, *b = rhs;
+    int             rc;
+
+    rc = snmp_oid_compare(a->name, a->namelen, b->name, b->namelen);
+    if (rc || a == b)
+        return rc;
+    if (NULL == a->index)
+        return -1;
+    if (NULL == b->index)
+        return 1;
+    return (a < b) ? -1 : 1;
+}
+
+/*
+ * returns the first entry of the list whose name is not before name
+ */
+static struct header_complex_index *
+_header_complex_first_from(struct header_complex_index *datalist,
+                           oid * name, size_t namelen)
+{
+    struct header_complex_index key, *nptr;
+
+    if (NULL == datalist)
+        return NULL;
+
+    if (NULL == datalist->index) {
+        for (nptr = datalist; nptr != NULL; nptr = nptr->next)
+            if (snmp_oid_compare(nptr->name, nptr->namelen,
+                                 name, namelen) >= 0)
+                break;
+        return nptr;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.name = name;
+    key.namelen = namelen;
+    nptr = (struct header_complex_index *)
+        CONTAINER_NEXT(datalist->index, &key);
+
+    /*
+     * duplicates are in insertion order in the list but not in the index,
+     * so back up to the first of them
+     */
+    while (nptr && nptr->prev &&
+           snmp_oid_compare(nptr->prev->name, nptr->prev->namelen,
+                            nptr->name, nptr->namelen) == 0)
+        nptr = nptr->prev;
+    return nptr;
+}
+
+static struct header_complex_index *
+_header_complex_last(struct header_complex_index *datalist)
+{
+    struct header_complex_index *last = NULL;
+    netsnmp_iterator *it;
+
+    if (NULL == datalist)
+        return NULL;
+
+    if (datalist->index) {
+        it = CONTAINER_ITERATOR(datalist->index);
+        if (it) {
+            last = (struct header_complex_index *) ITERATOR_LAST(it);
+            ITERATOR_RELEASE(it);
+        }
+    }
+    /*
+     * the index orders duplicates of the largest name by address, so
+     * this may be any of them rather than the tail of the list
+     */
+    if (NULL == last)
+        last = datalist;
+    while (last->next != NULL)
+        last = last->next;
+    return last;
+}
+
 void           *
 header_complex_get_from_oid(struct header_complex_index *datalist,
                             oid * searchfor, size_t searchfor_len)
 {
     struct header_complex_index *nptr;
-    for (nptr = datalist; nptr != NULL; nptr = nptr->next) {
-        if (netsnmp_oid_equals(searchfor, searchfor_len,
-                             nptr->name, nptr->namelen) == 0)
-            return nptr->data;
-    }
+
+    nptr = _header_complex_first_from(datalist, searchfor, searchfor_len);
+    if (nptr && netsnmp_oid_equals(searchfor, searchfor_len,
+                                   nptr->name, nptr->namelen) == 0)
+        return nptr->data;
     return NULL;
 }
 
@@ -283,10 +371,10 @@ header_complex(struct header_complex_index *datalist,
                int exact, size_t * var_len, WriteMethod ** write_method)
 {
 
-    struct header_complex_index *nptr, *found = NULL;
-    oid             indexOid[MAX_OID_LEN];
-    size_t          len;
-    int             result;
+    struct header_complex_index *found = NULL;
+    oid            *suffix = name;
+    size_t          suffix_len = *length;
+    int             result = 0;
 
     /*
      * set up some nice defaults for the user 
@@ -296,37 +384,43 @@ header_complex(struct header_complex_index *datalist,
     if (var_len)
         *var_len = sizeof(long);
 
-    for (nptr = datalist; nptr != NULL && found == NULL; nptr = nptr->next) {
-        if (vp) {
-            memcpy(indexOid, vp->name, vp->namelen * sizeof(oid));
-            memcpy(indexOid + vp->namelen, nptr->name,
-                   nptr->namelen * sizeof(oid));
-            len = vp->namelen + nptr->namelen;
-        } else {
-            memcpy(indexOid, nptr->name, nptr->namelen * sizeof(oid));
-            len = nptr->namelen;
-        }
-        result = snmp_oid_compare(name, *length, indexOid, len);
-        DEBUGMSGTL(("header_complex", "Checking: "));
-        DEBUGMSGOID(("header_complex", indexOid, len));
-        DEBUGMSG(("header_complex", "\n"));
+    /*
+     * the entries are all below vp->name, so only the part of the
+     * request past it needs looking up
+     */
+    if (vp) {
+        result = snmp_oid_compare(name, SNMP_MIN(*length, vp->namelen),
+                                  vp->name, vp->namelen);
+        suffix = name + vp->namelen;
+        suffix_len = (result == 0) ? *length - vp->namelen : 0;
+    }
+
+    DEBUGMSGTL(("header_complex", "Looking for: "));
+    DEBUGMSGOID(("header_complex", name, *length));
+    DEBUGMSG(("header_complex", " (%s)\n", exact ? "exact" : "next"));
 
+    if (result < 0) {
+        /*
+         * before the whole table
+         */
+        if (!exact)
+            found = datalist;
+    } else if (result == 0) {
+        found = _header_complex_first_from(datalist, suffix, suffix_len);
         if (exact) {
-            if (result == 0) {
-                found = nptr;
-            }
+            if (found && snmp_oid_compare(found->name, found->namelen,
+                                          suffix, suffix_len) != 0)
+                found = NULL;
         } else {
-            if (result == 0) {
-                /*
-                 * found an exact match.  Need the next one for !exact 
-                 */
-                if (nptr->next)
-                    found = nptr->next;
-            } else if (result == -1) {
-                found = nptr;
-            }
+            /*
+             * skip an exact match, and any duplicates of it
+             */
+            while (found && snmp_oid_compare(found->name, found->namelen,
+                                             suffix, suffix_len) == 0)
+                found = found->next;
         }
     }
+
     if (found) {
         if (vp) {
             memcpy(name, vp->name, vp->namelen * sizeof(oid));
@@ -413,16 +507,14 @@ _header_complex_add_between(struct header_complex_index **thedata,
     ourself->namelen = newoid_len;
 
     /*
-     * rewind to the head of the list and return it (since the new head
-     * could be us, we need to notify the above routine who the head now is. 
+     * return the head of the list (since the new head could be us, we
+     * need to notify the above routine who the head now is. 
      */
-    for (hciptrp = ourself; hciptrp->prev != NULL;
-         hciptrp = hciptrp->prev);
-
-    *thedata = hciptrp;
+    if (ourself->prev == NULL)
+        *thedata = ourself;
     DEBUGMSGTL(("header_complex_add_data", "adding something...\n"));
 
-    return hciptrp;
+    return *thedata;
 }
 
 
@@ -431,34 +523,66 @@ header_complex_maybe_add_data_by_oid(struct header_complex_index **thedata,
                                      oid * newoid, size_t newoid_len, void *data,
                                      int dont_allow_duplicates)
 {
-    struct header_complex_index *hciptrn, *hciptrp;
-    int rc;
+    struct header_complex_index *hciptrn, *hciptrp, *ourself, *ret;
+    netsnmp_container *index;
 
     if (thedata == NULL || newoid == NULL || data == NULL)
         return NULL;
 
-    for (hciptrn = *thedata, hciptrp = NULL;
-         hciptrn != NULL; hciptrp = hciptrn, hciptrn = hciptrn->next) {
+    /*
+     * the first entry of a list creates its index
+     */
+    if (NULL == *thedata) {
+        index = netsnmp_container_find("header_complex:table_container");
+        if (index)
+            index->compare = _header_complex_compare;
+    } else
+        index = (*thedata)->index;
+
+    /*
+     * XXX: check for == and error (overlapping table entries) 
+     * 8/2005 rks Ok, I added duplicate entry check, but only log
+     *            warning and continue, because it seems that nobody
+     *            that calls this fucntion does error checking!.
+     */
+    hciptrn = _header_complex_first_from(*thedata, newoid, newoid_len);
+    if (hciptrn && snmp_oid_compare(hciptrn->name, hciptrn->namelen,
+                                    newoid, newoid_len) == 0) {
+        snmp_log(LOG_WARNING, "header_complex_add_data_by_oid with "
+                 "duplicate index.\n");
+        if (dont_allow_duplicates)
+            return NULL;
         /*
-         * XXX: check for == and error (overlapping table entries) 
-         * 8/2005 rks Ok, I added duplicate entry check, but only log
-         *            warning and continue, because it seems that nobody
-         *            that calls this fucntion does error checking!.
+         * duplicates go after the existing entries
          */
-        rc = snmp_oid_compare(hciptrn->name, hciptrn->namelen,
-                              newoid, newoid_len);
-        if (rc > 0)
-            break;
-        else if (0 == rc) {
-            snmp_log(LOG_WARNING, "header_complex_add_data_by_oid with "
-                     "duplicate index.\n");
-            if (dont_allow_duplicates)
-                return NULL;
+        while (hciptrn && snmp_oid_compare(hciptrn->name, hciptrn->namelen,
+                                           newoid, newoid_len) == 0)
+            hciptrn = hciptrn->next;
+    }
+    hciptrp = hciptrn ? hciptrn->prev : _header_complex_last(*thedata);
+
+    ret = _header_complex_add_between(thedata, hciptrp, hciptrn,
+                                      newoid, newoid_len, data);
+    if (NULL == ret) {
+        if (index && NULL == *thedata)
+            CONTAINER_FREE(index);
+        return NULL;
+    }
+
+    if (index) {
+        ourself = hciptrp ? hciptrp->next : *thedata;
+        ourself->index = index;
+        if (CONTAINER_INSERT(index, ourself) != 0) {
+            snmp_log(LOG_ERR, "header_complex: could not index entry\n");
+            ourself->index = NULL;
+            header_complex_extract_entry(thedata, ourself);
+            if (NULL == *thedata)
+                CONTAINER_FREE(index);
+            return NULL;
         }
     }
 
-    return _header_complex_add_between(thedata, hciptrp, hciptrn,
-                                       newoid, newoid_len, data);
+    return ret;
 }
 
 struct header_complex_index *
@@ -492,6 +616,15 @@ header_complex_extract_entry(struct header_complex_index **thetop,
 
     retdata = thespot->data;
 
+    /*
+     * the last entry of a list frees its index
+     */
+    if (thespot->index) {
+        CONTAINER_REMOVE(thespot->index, thespot);
+        if (CONTAINER_SIZE(thespot->index) == 0)
+            CONTAINER_FREE(thespot->index);
+    }
+
     hciptrp = thespot->prev;
     hciptrn = thespot->next;
 
@@ -531,11 +664,23 @@ header_complex_free_all(struct header_complex_index *thestuff,
                         HeaderComplexCleaner * cleaner)
 {
     struct header_complex_index *hciptr, *hciptrn;
+    netsnmp_container *index = NULL;
+
+    /*
+     * when freeing a whole list, drop its index in one go rather than
+     * removing the entries from it one at a time
+     */
+    if (thestuff && thestuff->prev == NULL)
+        index = thestuff->index;
 
     for (hciptr = thestuff; hciptr != NULL; hciptr = hciptrn) {
         hciptrn = hciptr->next; /* need to extract this before deleting it */
+        if (index)
+            hciptr->index = NULL;
         header_complex_free_entry(hciptr, cleaner);
     }
+    if (index)
+        CONTAINER_FREE(index);
 }
 #endif /* NETSNMP_FEATURE_REMOVE_HEADER_COMPLEX_FREE_ALL */
 
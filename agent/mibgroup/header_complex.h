@@ -10,6 +10,12 @@ struct header_complex_index {
     void           *data;
     struct header_complex_index *next;
     struct header_complex_index *prev;
+    /*
+     * sorted index of every entry in the list, shared by all of them so
+     * that it can be found from whichever entry is the head. May be NULL,
+     * in which case the list is searched linearly.
+     */
+    netsnmp_container *index;
 };
 
 /*
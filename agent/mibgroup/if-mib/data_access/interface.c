@@ -39,6 +39,7 @@ netsnmp_feature_require(interface_arch_set_admin_status);
 static netsnmp_conf_if_list *conf_list = NULL;
 static int need_wrap_check = -1;
 static int _access_interface_init = 0;
+static int _access_interface_loaded = 0;
 static netsnmp_include_if_list *include_list;
 static int ifmib_max_num_ifaces = 0;
 
@@ -47,6 +48,7 @@ static int ifmib_max_num_ifaces = 0;
  */
 static int _access_interface_entry_compare_name(const void *lhs,
                                                 const void *rhs);
+static u_int _access_interface_entry_hash_name(const void *entry);
 static void _access_interface_entry_release(netsnmp_interface_entry * entry,
                                             void *unused);
 static void _access_interface_entry_save_name(const char *name, oid index);
@@ -96,16 +98,28 @@ init_interface(void)
 void
 netsnmp_access_interface_init(void)
 {
-    if (1 == _access_interface_init)
+    if (0 == _access_interface_init) {
+        _access_interface_init = 1;
+        netsnmp_arch_interface_init();
+    }
+
+    /*
+     * the configuration may leave loading the interfaces to the first
+     * request (lazyInit), so wait for it; _load_if_list calls us again
+     */
+    if (1 == _access_interface_loaded ||
+        !netsnmp_ds_get_boolean(NETSNMP_DS_LIBRARY_ID,
+                                NETSNMP_DS_LIB_HAVE_READ_CONFIG))
         return;
 
-    _access_interface_init = 1;
+    _access_interface_loaded = 1;
+    if (netsnmp_ds_get_boolean(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_LAZY_INIT))
+        return;
 
     {
         netsnmp_container * ifcontainer;
 
-        netsnmp_arch_interface_init();
-        
         /*
          * load once to set up ifIndexes
          */
@@ -131,7 +145,7 @@ netsnmp_access_interface_container_init(u_int flags)
 
     /*
      * create the containers. one indexed by ifIndex, the other
-     * indexed by ifName.
+     * indexed by ifName, which is only used for exact lookups.
      */
     container1 = netsnmp_container_find("access_interface:table_container");
     if (NULL == container1)
@@ -140,12 +154,14 @@ netsnmp_access_interface_container_init(u_int flags)
     container1->container_name = strdup("interface container");
     if (flags & NETSNMP_ACCESS_INTERFACE_INIT_ADDL_IDX_BY_NAME) {
         netsnmp_container *container2 =
-            netsnmp_container_find("access_interface_by_name:access_interface:table_container");
+            netsnmp_container_find("access_interface_by_name:access_interface:hash");
         if (NULL == container2)
             return NULL;
 
         container2->container_name = strdup("interface name container");
         container2->compare = _access_interface_entry_compare_name;
+        netsnmp_container_hash_set_func(container2,
+                                        _access_interface_entry_hash_name);
         
         netsnmp_container_add_index(container1, container2);
     }
@@ -178,7 +194,11 @@ netsnmp_access_interface_container_load(netsnmp_container* container, u_int load
         return NULL;
     }
 
+    CONTAINER_LOAD_BEGIN(container);
     rc =  netsnmp_arch_interface_container_load(container, load_flags);
+    CONTAINER_LOAD_END(container,
+                       (netsnmp_container_obj_func*)_access_interface_entry_release,
+                       NULL);
     if (0 != rc) {
         netsnmp_access_interface_container_free(container,
                                                 NETSNMP_ACCESS_INTERFACE_FREE_NOFLAGS);
@@ -480,6 +500,15 @@ _access_interface_entry_compare_name(const void *lhs, const void *rhs)
                   ((const netsnmp_interface_entry *) rhs)->name);
 }
 
+/**
+ */
+static u_int
+_access_interface_entry_hash_name(const void *entry)
+{
+    return netsnmp_hash_direct_cstring(((const netsnmp_interface_entry *)
+                                        entry)->name);
+}
+
 /**
  */
 static void
@@ -44,7 +44,11 @@ netsnmp_access_route_container_load(netsnmp_container* container, u_int load_fla
 
     container->container_name = strdup("_route");
 
+    CONTAINER_LOAD_BEGIN(container);
     rc =  netsnmp_access_route_container_arch_load(container, load_flags);
+    CONTAINER_LOAD_END(container,
+                       (netsnmp_container_obj_func*)_access_route_entry_release,
+                       NULL);
     if (0 != rc) {
         netsnmp_access_route_container_free(container, NETSNMP_ACCESS_ROUTE_FREE_NOFLAGS);
         container = NULL;
@@ -2334,7 +2334,7 @@ _inetCidrRouteTable_container_init(inetCidrRouteTable_interface_ctx *
     inetCidrRouteTable_container_init(&if_ctx->container, if_ctx->cache);
     if (NULL == if_ctx->container) {
         if_ctx->container =
-            netsnmp_container_find("inetCidrRouteTable:table_container");
+            netsnmp_container_find("inetCidrRouteTable:large_table:table_container");
         if (NULL == if_ctx->container) {
             snmp_log(LOG_ERR, "error creating container in "
                      "inetCidrRouteTable_container_init\n");
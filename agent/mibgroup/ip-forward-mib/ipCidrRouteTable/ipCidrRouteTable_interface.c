@@ -2288,7 +2288,7 @@ _ipCidrRouteTable_container_init(ipCidrRouteTable_interface_ctx * if_ctx)
     ipCidrRouteTable_container_init(&if_ctx->container, if_ctx->cache);
     if (NULL == if_ctx->container) {
         if_ctx->container =
-            netsnmp_container_find("ipCidrRouteTable:table_container");
+            netsnmp_container_find("ipCidrRouteTable:large_table:table_container");
         if (NULL == if_ctx->container) {
             snmp_log(LOG_ERR, "error creating container in "
                      "ipCidrRouteTable_container_init\n");
@@ -118,6 +118,7 @@ _remove_duplicates(netsnmp_container *container, u_int container_flags)
 	 * to 'ret'
 	 */
 	prev_entry = NULL;
+	CONTAINER_LOAD_BEGIN(ret);
 	for (entry = ITERATOR_FIRST(it); entry; entry = ITERATOR_NEXT(it)) {
 		if (prev_entry && _access_ipaddress_entry_compare_addr(prev_entry, entry) == 0) {
 			/* 'entry' is duplicate of the previous one -> delete it */
@@ -127,6 +128,9 @@ _remove_duplicates(netsnmp_container *container, u_int container_flags)
 			prev_entry = entry;
 		}
 	}
+	CONTAINER_LOAD_END(ret,
+	                   (netsnmp_container_obj_func*)_access_ipaddress_entry_release,
+	                   NULL);
 	CONTAINER_FREE(container);
 	free(it);
 	return ret;
@@ -156,7 +160,11 @@ netsnmp_access_ipaddress_container_load(netsnmp_container* container,
         return NULL;
     }
 
+    CONTAINER_LOAD_BEGIN(container);
     rc =  netsnmp_arch_ipaddress_container_load(container, load_flags);
+    CONTAINER_LOAD_END(container,
+                       (netsnmp_container_obj_func*)_access_ipaddress_entry_release,
+                       NULL);
     if (0 != rc) {
         netsnmp_access_ipaddress_container_free(container,
                                                 NETSNMP_ACCESS_IPADDRESS_FREE_NOFLAGS);
@@ -22,6 +22,8 @@
 
 netsnmp_feature_require(container_lifo);
 static netsnmp_arp_access * arp_access = NULL;
+static netsnmp_cache * arp_cache = NULL;
+static int arp_loading = 0;
 
 /** @ingroup interface 
  * @addtogroup data_access data_access: Routines to access data
@@ -149,8 +151,42 @@ _add_or_update_arp_entry(netsnmp_arp_entry *arp_entry,
     }
 }
 
+/**
+ * apply a change queued by _arp_hook_update, or free it
+ */
+static int
+_arp_cache_apply(netsnmp_cache *cache, int op, void *data, void *magic)
+{
+    netsnmp_arp_entry *entry = (netsnmp_arp_entry *) data;
+
+    if (NETSNMP_CACHE_CHANGE_DISCARD == op) {
+        netsnmp_access_arp_entry_free(entry);
+        return 0;
+    }
+    if (NULL == magic) {
+        netsnmp_access_arp_entry_free(entry);
+        return -1;
+    }
+
+    _add_or_update_arp_entry(entry, (netsnmp_container *) magic);
+    return 0;
+}
+
 static void  _arp_hook_update(netsnmp_arp_access *access, netsnmp_arp_entry *entry)
 {
+    /*
+     * entries read while loading go straight into the container; later
+     * notifications are queued until the table is next used
+     */
+    if (!arp_loading && NULL != arp_cache &&
+        SNMPERR_SUCCESS ==
+        netsnmp_cache_report_change(arp_cache,
+                                    (entry->flags &
+                                     NETSNMP_ACCESS_ARP_ENTRY_FLAG_DELETE) ?
+                                    NETSNMP_CACHE_CHANGE_DELETE :
+                                    NETSNMP_CACHE_CHANGE_UPDATE, entry))
+        return;
+
     _add_or_update_arp_entry(entry, access->magic);
 }
 
@@ -241,6 +277,9 @@ inetNetToMediaTable_container_init(netsnmp_container **container_ptr_ptr,
         return;
     }
 
+    arp_cache = cache;
+    cache->apply_change = _arp_cache_apply;
+
     arp_access = netsnmp_access_arp_create(
                            NETSNMP_ACCESS_ARP_CREATE_NOFLAGS,
                            _arp_hook_update,
@@ -280,6 +319,7 @@ inetNetToMediaTable_container_shutdown(netsnmp_container *container_ptr)
         netsnmp_access_arp_delete(arp_access);
         arp_access = NULL;
     }
+    arp_cache = NULL;
 
     if (NULL == container_ptr) {
         snmp_log(LOG_ERR,
@@ -324,10 +364,15 @@ inetNetToMediaTable_container_shutdown(netsnmp_container *container_ptr)
 int
 inetNetToMediaTable_container_load(netsnmp_container *container)
 {
+    int             rc;
+
     DEBUGMSGTL(("verbose:inetNetToMediaTable:inetNetToMediaTable_cache_load", "called\n"));
 
     arp_access->magic = container;
-    if (netsnmp_access_arp_load(arp_access) < 0)
+    arp_loading = 1;
+    rc = netsnmp_access_arp_load(arp_access);
+    arp_loading = 0;
+    if (rc < 0)
         return MFD_ERROR;
 
     return MFD_SUCCESS;
@@ -124,10 +124,8 @@ ipIfStatsTable_container_init(netsnmp_container ** container_ptr_ptr,
      */
     *container_ptr_ptr =
         netsnmp_container_find("ipIfStatsTable:table_container");
-    if (NULL != *container_ptr_ptr) {
+    if (NULL != *container_ptr_ptr)
         (*container_ptr_ptr)->container_name = strdup("ipIfStatsTable");
-        ipIfStatsTable_container_load(*container_ptr_ptr);
-    }
     if (NULL == cache) {
         snmp_log(LOG_ERR,
                  "bad cache param to ipIfStatsTable_container_init\n");
@@ -144,9 +142,12 @@ ipIfStatsTable_container_init(netsnmp_container ** container_ptr_ptr,
      */
     cache->timeout = IPIFSTATSTABLE_CACHE_TIMEOUT;      /* seconds */
 
+    /*
+     * load once up front (unless lazyInit leaves it to the first request)
+     */
     cache->flags |=
         (NETSNMP_CACHE_DONT_AUTO_RELEASE | NETSNMP_CACHE_DONT_FREE_EXPIRED
-         | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+         | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD | NETSNMP_CACHE_PRELOAD |
          NETSNMP_CACHE_AUTO_RELOAD);
 }                               /* ipIfStatsTable_container_init */
 
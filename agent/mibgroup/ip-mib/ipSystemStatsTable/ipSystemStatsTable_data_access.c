@@ -139,13 +139,13 @@ ipSystemStatsTable_container_init(netsnmp_container **container_ptr_ptr,
     cache->timeout = IPSYSTEMSTATSTABLE_CACHE_TIMEOUT;  /* seconds */
 
     /*
-     * don't release resources
+     * don't release resources, and load once up front (unless lazyInit
+     * leaves it to the first request)
      */
     cache->flags |=
         (NETSNMP_CACHE_DONT_AUTO_RELEASE | NETSNMP_CACHE_DONT_FREE_EXPIRED
-         | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD |
+         | NETSNMP_CACHE_DONT_FREE_BEFORE_LOAD | NETSNMP_CACHE_PRELOAD |
          NETSNMP_CACHE_AUTO_RELOAD);
-    ipSystemStatsTable_container_load(*container_ptr_ptr);
 }                               /* ipSystemStatsTable_container_init */
 
 /**
@@ -227,7 +227,7 @@ init_sysORTable(void)
         netsnmp_create_handler_registration(
             "mibII/sysORLastChange", NULL,
             sysORLastChange_oid, OID_LENGTH(sysORLastChange_oid),
-            HANDLER_CAN_RONLY);
+            HANDLER_CAN_RONLY | HANDLER_CAN_THREADSAFE);
     netsnmp_init_watcher_info(
 	    &sysORLastChange_winfo,
             &sysORLastChange, sizeof(u_long),
@@ -238,7 +238,8 @@ init_sysORTable(void)
     sysORTable_reg =
         netsnmp_create_handler_registration(
             "mibII/sysORTable", sysORTable_handler,
-            sysORTable_oid, OID_LENGTH(sysORTable_oid), HANDLER_CAN_RONLY);
+            sysORTable_oid, OID_LENGTH(sysORTable_oid),
+            HANDLER_CAN_RONLY | HANDLER_CAN_THREADSAFE);
     netsnmp_container_table_register(sysORTable_reg, sysORTable_table_info,
                                      table, TABLE_CONTAINER_KEY_NETSNMP_INDEX);
 
@@ -204,6 +204,8 @@ init_tcpTable(void)
 #if defined (WIN32) || defined (cygwin)
     iinfo->flags               |= NETSNMP_ITERATOR_FLAG_SORTED;
 #endif /* WIN32 || cygwin */
+    /* the entries stay put until the cache is reloaded */
+    iinfo->flags               |= NETSNMP_ITERATOR_FLAG_SNAPSHOT;
 
 
     /*
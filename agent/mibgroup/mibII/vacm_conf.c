@@ -1259,6 +1259,20 @@ vacm_check_view(netsnmp_pdu *pdu, oid * name, size_t namelen,
                                     VACM_CHECK_VIEW_CONTENTS_NO_FLAGS);
 }
 
+/*
+ * The access entry found for the last PDU checked.  Access is checked
+ * for every varbind of a request (and again for every step of a
+ * getnext), so this saves mapping the PDU to a security name, group and
+ * access entry each time.  Parsed PDUs carry a unique transid, and the
+ * vacm generation changes whenever entries are added or removed.
+ */
+static struct {
+    netsnmp_pdu    *pdu;
+    long            transid;
+    u_int           generation;
+    struct vacm_accessEntry *ap;
+} vacm_pdu_cache;
+
 int
 vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
                          int check_subtree, int viewtype, int flags)
@@ -1280,6 +1294,14 @@ vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
 #define CONTEXTNAMEINDEXLEN 32
     char            contextNameIndex[CONTEXTNAMEINDEXLEN + 1];
 
+    if (pdu->transid != 0 && pdu == vacm_pdu_cache.pdu &&
+        pdu->transid == vacm_pdu_cache.transid &&
+        vacm_pdu_cache.generation == vacm_get_generation()) {
+        ap = vacm_pdu_cache.ap;
+        DEBUGMSGTL(("mibII/vacm_vars", "vacm_in_view: cached access"));
+        goto check_view;
+    }
+
 #if !defined(NETSNMP_DISABLE_SNMPV1) || !defined(NETSNMP_DISABLE_SNMPV2C)
 #if defined(NETSNMP_DISABLE_SNMPV1)
     if (pdu->version == SNMP_VERSION_2c)
@@ -1453,6 +1475,15 @@ vacm_check_view_contents(netsnmp_pdu *pdu, oid * name, size_t namelen,
         return VACM_NOACCESS;
     }
 
+    /* only cache a decision that included the context check */
+    if (!(flags & VACM_CHECK_VIEW_CONTENTS_DNE_CONTEXT_OK)) {
+        vacm_pdu_cache.pdu = pdu;
+        vacm_pdu_cache.transid = pdu->transid;
+        vacm_pdu_cache.generation = vacm_get_generation();
+        vacm_pdu_cache.ap = ap;
+    }
+
+  check_view:
     if (name == NULL) { /* only check the setup of the vacm for the request */
         DEBUGMSG(("mibII/vacm_vars", ", Done checking setup\n"));
         return VACM_SUCCESS;
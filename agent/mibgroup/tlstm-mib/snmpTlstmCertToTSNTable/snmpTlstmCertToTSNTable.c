@@ -1032,6 +1032,7 @@ _cert_map_remove(certToTSN_entry *entry)
     if (CONTAINER_REMOVE(maps, &map) != 0) {
         snmp_log(LOG_ERR, "could not remove certificate map");
     }
+    netsnmp_cert_secname_cache_clear();
     entry->map_flags = 0;
 }
 
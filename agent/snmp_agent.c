@@ -83,6 +83,7 @@ SOFTWARE.
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <net-snmp/library/large_fd_set.h>
 #include <net-snmp/library/snmp_assert.h>
+#include <net-snmp/library/vacm.h>
 #include "agent_global_vars.h"
 
 #ifdef HAVE_SYSLOG_H
@@ -268,6 +269,327 @@ _dump_pdu_stats(void)
 }
 #endif /* NETSNMP_NO_PDU_STATS */
 
+/*
+ * Response memo: the answers to GET and GETNEXT requests for the subtrees
+ * named by "responseMemo" directives are kept for a few seconds, and
+ * identical requests from the same principal are answered from the memo
+ * without calling any handler.  The key is made up of the request type,
+ * the security model and level, the principal (the security name, or the
+ * community and source address for SNMPv1/v2c), the context and the
+ * requested OID.  The memo is emptied after every SET.
+ */
+#define AGENT_MEMO_KEY_MAX      512
+#define AGENT_MEMO_MAX          10000
+
+typedef struct agent_memo_subtree_s {
+    oid             name[MAX_OID_LEN];
+    size_t          name_len;
+    int             ttl;        /* seconds */
+    struct agent_memo_subtree_s *next;
+} agent_memo_subtree;
+
+typedef struct agent_memo_s {
+    u_char         *key;
+    size_t          key_len;
+    u_int           generation; /* of the VACM tables */
+    struct timeval  expiresM;
+    netsnmp_variable_list *var;
+} agent_memo;
+
+static agent_memo_subtree *_memo_subtrees = NULL;
+static netsnmp_container *_memo = NULL;
+u_long          netsnmp_response_memo_hits = 0;
+u_long          netsnmp_response_memo_misses = 0;
+
+static int
+_memo_compare(const void *lhs, const void *rhs)
+{
+    const agent_memo *l = (const agent_memo *) lhs;
+    const agent_memo *r = (const agent_memo *) rhs;
+    int             rc;
+
+    rc = memcmp(l->key, r->key, SNMP_MIN(l->key_len, r->key_len));
+    if (rc)
+        return rc;
+    if (l->key_len == r->key_len)
+        return 0;
+    return l->key_len < r->key_len ? -1 : 1;
+}
+
+static void
+_memo_free(void *data, void *context)
+{
+    agent_memo     *entry = (agent_memo *) data;
+
+    if (NULL == entry)
+        return;
+    snmp_free_var(entry->var);
+    free(entry->key);
+    free(entry);
+}
+
+static void
+_memo_flush(void)
+{
+    if (_memo && CONTAINER_SIZE(_memo))
+        CONTAINER_CLEAR(_memo, _memo_free, NULL);
+}
+
+/** parses "responseMemo OID SECONDS" */
+void
+netsnmp_response_memo_parse(const char *token, char *line)
+{
+    agent_memo_subtree *st;
+    char            name[SNMP_MAXBUF_SMALL];
+    char           *cp;
+
+    st = SNMP_MALLOC_TYPEDEF(agent_memo_subtree);
+    if (NULL == st)
+        return;
+    cp = copy_nword(line, name, sizeof(name));
+    st->name_len = MAX_OID_LEN;
+    if (!snmp_parse_oid(name, st->name, &st->name_len)) {
+        config_perror("unknown OID");
+        free(st);
+        return;
+    }
+    if (!cp || (st->ttl = atoi(cp)) <= 0) {
+        config_perror("expected a time to live (in seconds) after the OID");
+        free(st);
+        return;
+    }
+
+    if (NULL == _memo) {
+        _memo = netsnmp_container_find("agent_memo:binary_array");
+        if (NULL == _memo) {
+            free(st);
+            return;
+        }
+        _memo->compare = _memo_compare;
+    }
+    st->next = _memo_subtrees;
+    _memo_subtrees = st;
+    DEBUGMSGTL(("snmp_agent:memo", "memo of %d s for ", st->ttl));
+    DEBUGMSGOID(("snmp_agent:memo", st->name, st->name_len));
+    DEBUGMSG(("snmp_agent:memo", "\n"));
+}
+
+/** drops the "responseMemo" configuration and everything memorized */
+void
+netsnmp_response_memo_free(void)
+{
+    agent_memo_subtree *st;
+
+    while ((st = _memo_subtrees) != NULL) {
+        _memo_subtrees = st->next;
+        free(st);
+    }
+    if (_memo) {
+        _memo_flush();
+        CONTAINER_FREE(_memo);
+        _memo = NULL;
+    }
+}
+
+/* the most specific memo subtree containing name, if any */
+static agent_memo_subtree *
+_memo_subtree(const oid *name, size_t name_len)
+{
+    agent_memo_subtree *st, *best = NULL;
+
+    for (st = _memo_subtrees; st; st = st->next) {
+        if (netsnmp_oid_is_subtree(st->name, st->name_len,
+                                   name, name_len) == 0 &&
+            (NULL == best || st->name_len > best->name_len))
+            best = st;
+    }
+    return best;
+}
+
+static int
+_memo_key_add(u_char *key, size_t *len, const void *data, size_t data_len)
+{
+    if (*len + sizeof(data_len) + data_len > AGENT_MEMO_KEY_MAX)
+        return 0;
+    memcpy(key + *len, &data_len, sizeof(data_len));
+    *len += sizeof(data_len);
+    if (data_len)
+        memcpy(key + *len, data, data_len);
+    *len += data_len;
+    return 1;
+}
+
+/*
+ * builds the memo key for looking up name on behalf of the sender of pdu,
+ * returning its length, or 0 if the request can't be memorized
+ */
+static size_t
+_memo_key(const netsnmp_pdu *pdu, int command, const oid *name,
+          size_t name_len, u_char *key)
+{
+    size_t          len = 0;
+    int             id[3];
+
+    id[0] = command;
+    id[1] = pdu->securityModel;
+    id[2] = pdu->securityLevel;
+    if (!_memo_key_add(key, &len, id, sizeof(id)))
+        return 0;
+
+    if (pdu->version == SNMP_VERSION_1 || pdu->version == SNMP_VERSION_2c) {
+        const netsnmp_addr_pair *addr =
+            (const netsnmp_addr_pair *) pdu->transport_data;
+
+        /* the community, and where it was sent from, select the view */
+        if (NULL == addr ||
+            pdu->transport_data_length < (int) sizeof(netsnmp_addr_pair))
+            return 0;
+        if (!_memo_key_add(key, &len, pdu->community, pdu->community_len))
+            return 0;
+        if (addr->remote_addr.sa.sa_family == AF_INET) {
+            if (!_memo_key_add(key, &len, &addr->remote_addr.sin.sin_addr,
+                               sizeof(addr->remote_addr.sin.sin_addr)))
+                return 0;
+#ifdef NETSNMP_ENABLE_IPV6
+        } else if (addr->remote_addr.sa.sa_family == AF_INET6) {
+            if (!_memo_key_add(key, &len, &addr->remote_addr.sin6.sin6_addr,
+                               sizeof(addr->remote_addr.sin6.sin6_addr)))
+                return 0;
+#endif
+        } else
+            return 0;
+    } else if (pdu->version == SNMP_VERSION_3) {
+        if (!_memo_key_add(key, &len, pdu->securityName,
+                           pdu->securityNameLen) ||
+            !_memo_key_add(key, &len, pdu->contextName, pdu->contextNameLen))
+            return 0;
+    } else
+        return 0;
+
+    if (!_memo_key_add(key, &len, name, name_len * sizeof(oid)))
+        return 0;
+    return len;
+}
+
+/* fills in var from the memo, if it is there */
+static int
+_memo_lookup(netsnmp_agent_session *asp, netsnmp_variable_list *var)
+{
+    u_char          key[AGENT_MEMO_KEY_MAX];
+    agent_memo      probe, *entry;
+    struct timeval  now;
+
+    if (NULL == _memo_subtree(var->name, var->name_length))
+        return 0;
+    probe.key = key;
+    probe.key_len = _memo_key(asp->pdu, asp->pdu->command, var->name,
+                              var->name_length, key);
+    if (0 == probe.key_len)
+        return 0;
+
+    entry = (agent_memo *) CONTAINER_FIND(_memo, &probe);
+    if (entry) {
+        netsnmp_get_monotonic_clock(&now);
+        if (!timercmp(&now, &entry->expiresM, <) ||
+            entry->generation != vacm_get_generation()) {
+            CONTAINER_REMOVE(_memo, entry);
+            _memo_free(entry, NULL);
+            entry = NULL;
+        }
+    }
+    if (NULL == entry) {
+        netsnmp_response_memo_misses++;
+        return 0;
+    }
+
+    if (snmp_set_var_objid(var, entry->var->name, entry->var->name_length) ||
+        snmp_set_var_typed_value(var, entry->var->type,
+                                 entry->var->val.string,
+                                 entry->var->val_len))
+        return 0;
+    netsnmp_response_memo_hits++;
+    DEBUGMSGTL(("snmp_agent:memo", "answered "));
+    DEBUGMSGOID(("snmp_agent:memo", var->name, var->name_length));
+    DEBUGMSG(("snmp_agent:memo", " from the memo\n"));
+    return 1;
+}
+
+/* drops expired entries, to make room for new ones */
+static void
+_memo_purge(void)
+{
+    agent_memo     *entry;
+    struct timeval  now;
+    int             x;
+
+    netsnmp_get_monotonic_clock(&now);
+    for (x = CONTAINER_SIZE(_memo) - 1; x >= 0; x--) {
+        CONTAINER_GET_AT(_memo, x, (void **) &entry);
+        if (entry && !timercmp(&now, &entry->expiresM, <)) {
+            CONTAINER_REMOVE(_memo, entry);
+            _memo_free(entry, NULL);
+        }
+    }
+}
+
+/* remembers the answers in a finished GET or GETNEXT response */
+static void
+_memo_store(netsnmp_agent_session *asp)
+{
+    netsnmp_variable_list *ovar, *var;
+    agent_memo_subtree *st;
+    agent_memo      probe, *entry;
+    u_char          key[AGENT_MEMO_KEY_MAX];
+    struct timeval  now;
+
+    netsnmp_get_monotonic_clock(&now);
+    for (ovar = asp->orig_pdu->variables, var = asp->pdu->variables;
+         ovar && var; ovar = ovar->next_variable, var = var->next_variable) {
+        st = _memo_subtree(ovar->name, ovar->name_length);
+        if (NULL == st)
+            continue;
+        /* don't let a walk carry the memo beyond the configured subtree */
+        if (asp->pdu->command == SNMP_MSG_GETNEXT &&
+            netsnmp_oid_is_subtree(st->name, st->name_len,
+                                   var->name, var->name_length) != 0)
+            continue;
+        probe.key = key;
+        probe.key_len = _memo_key(asp->pdu, asp->pdu->command, ovar->name,
+                                  ovar->name_length, key);
+        if (0 == probe.key_len)
+            continue;
+
+        /* answered from the memo, or asked twice in the same request */
+        entry = (agent_memo *) CONTAINER_FIND(_memo, &probe);
+        if (entry) {
+            if (timercmp(&now, &entry->expiresM, <))
+                continue;
+            CONTAINER_REMOVE(_memo, entry);
+            _memo_free(entry, NULL);
+        }
+
+        if (CONTAINER_SIZE(_memo) >= AGENT_MEMO_MAX) {
+            _memo_purge();
+            if (CONTAINER_SIZE(_memo) >= AGENT_MEMO_MAX)
+                return;
+        }
+        entry = SNMP_MALLOC_TYPEDEF(agent_memo);
+        if (NULL == entry)
+            return;
+        entry->key = (u_char *) netsnmp_memdup(key, probe.key_len);
+        entry->key_len = probe.key_len;
+        entry->generation = vacm_get_generation();
+        entry->expiresM.tv_sec = now.tv_sec + st->ttl;
+        entry->expiresM.tv_usec = now.tv_usec;
+        entry->var = SNMP_MALLOC_TYPEDEF(netsnmp_variable_list);
+        if (NULL == entry->key || NULL == entry->var ||
+            snmp_clone_var(var, entry->var) ||
+            CONTAINER_INSERT(_memo, entry)) {
+            _memo_free(entry, NULL);
+        }
+    }
+}
+
 
 NETSNMP_INLINE void
 netsnmp_agent_add_list_data(netsnmp_agent_request_info *ari,
@@ -368,6 +690,10 @@ netsnmp_agent_session *netsnmp_agent_queued_list = NULL;
 
 
 int             handle_pdu(netsnmp_agent_session *asp);
+static void     _agent_session_pool_clear(void);
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+static void     _agent_threads_stop(void);
+#endif
 int             netsnmp_handle_request(netsnmp_agent_session *asp,
                                        int status);
 int             check_delayed_request(netsnmp_agent_session *asp);
@@ -449,6 +775,7 @@ typedef struct agent_set_cache_s {
 
     int             vbcount;
     netsnmp_request_info *requests;
+    int             requests_len;
     netsnmp_variable_list *saved_vars;
     netsnmp_data_list *agent_data;
 
@@ -484,6 +811,7 @@ save_set_cache(netsnmp_agent_session *asp)
     ptr->treecache_num = asp->treecache_num;
     ptr->agent_data = asp->reqinfo->agent_data;
     ptr->requests = asp->requests;
+    ptr->requests_len = asp->requests_len;
     ptr->saved_vars = asp->pdu->variables; /* requests contains pointers to variables */
     ptr->vbcount = asp->vbcount;
 
@@ -559,6 +887,7 @@ get_set_cache(netsnmp_agent_session *asp)
                 netsnmp_assert(NULL != ptr->saved_vars);
             }
             asp->requests = ptr->requests;
+            asp->requests_len = ptr->requests_len;
 
             netsnmp_assert(NULL != asp->reqinfo);
             asp->reqinfo->asp = asp;
@@ -1554,21 +1883,149 @@ void
 shutdown_master_agent(void)
 {
     clear_nsap_list();
+    _agent_session_pool_clear();
+    netsnmp_response_memo_free();
 
 #ifndef NETSNMP_NO_PDU_STATS
     _pdu_stats_shutdown();
 #endif /* NETSNMP_NO_PDU_STATS */
 }
 
+/*
+ * Stops the "agentThreads" workers, if any.  Called on the way out of
+ * every agent, master or subagent, from shutdown_agent() and the library
+ * shutdown callback.
+ */
+void
+netsnmp_agent_threads_shutdown(void)
+{
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+    _agent_threads_stop();
+#endif
+}
+
+/*
+ * Agent sessions are recycled instead of being freed, along with their
+ * agent request info, and the request and subtree cache arrays go back
+ * to small stacks of spares, so that a steady flow of requests doesn't
+ * allocate any of them again.  agent_session_allocs counts the
+ * allocations that were needed anyway.
+ */
+#define AGENT_SESSION_POOL_MAX  16
+#define AGENT_ARRAY_POOL_MAX    8
+
+typedef struct agent_array_pool_s {
+    void           *array[AGENT_ARRAY_POOL_MAX];
+    int             len[AGENT_ARRAY_POOL_MAX];
+    int             count;
+} agent_array_pool;
+
+static netsnmp_agent_session *agent_session_pool = NULL;
+static int      agent_session_pool_len = 0;
+static agent_array_pool agent_requests_pool;
+static agent_array_pool agent_treecache_pool;
+static u_long   agent_session_allocs = 0;
+
+/** returns the number of agent sessions, request infos, request arrays
+ *  and subtree caches allocated so far, as opposed to recycled */
+u_long
+netsnmp_get_agent_session_allocs(void)
+{
+    return agent_session_allocs;
+}
+
+/*
+ * returns a zeroed array of at least want entries of size bytes, and its
+ * length in *len
+ */
+static void    *
+_agent_array_get(agent_array_pool *pool, int want, size_t size, int *len)
+{
+    void           *array;
+    int             i;
+
+    for (i = pool->count - 1; i >= 0; i--) {
+        if (pool->len[i] >= want)
+            break;
+    }
+    if (i >= 0) {
+        array = pool->array[i];
+        *len = pool->len[i];
+        pool->count--;
+        pool->array[i] = pool->array[pool->count];
+        pool->len[i] = pool->len[pool->count];
+        memset(array, 0, *len * size);
+        return array;
+    }
+
+    array = calloc(want, size);
+    if (array) {
+        agent_session_allocs++;
+        *len = want;
+    }
+    return array;
+}
+
+static void
+_agent_array_put(agent_array_pool *pool, void *array, int len)
+{
+    int             i;
+
+    if (NULL == array)
+        return;
+    if (pool->count < AGENT_ARRAY_POOL_MAX) {
+        pool->array[pool->count] = array;
+        pool->len[pool->count++] = len;
+        return;
+    }
+    /* full; keep the larger array */
+    for (i = 0; i < pool->count; i++) {
+        if (pool->len[i] < len) {
+            free(pool->array[i]);
+            pool->array[i] = array;
+            pool->len[i] = len;
+            return;
+        }
+    }
+    free(array);
+}
+
+static void
+_agent_array_clear(agent_array_pool *pool)
+{
+    while (pool->count > 0)
+        free(pool->array[--pool->count]);
+}
+
+static void
+_agent_session_pool_clear(void)
+{
+    netsnmp_agent_session *asp;
+
+    while ((asp = agent_session_pool) != NULL) {
+        agent_session_pool = asp->next;
+        SNMP_FREE(asp->reqinfo);
+        free(asp);
+    }
+    agent_session_pool_len = 0;
+    _agent_array_clear(&agent_requests_pool);
+    _agent_array_clear(&agent_treecache_pool);
+}
 
 netsnmp_agent_session *
 init_agent_snmp_session(netsnmp_session * session, netsnmp_pdu *pdu)
 {
-    netsnmp_agent_session *asp = (netsnmp_agent_session *)
-        calloc(1, sizeof(netsnmp_agent_session));
+    netsnmp_agent_session *asp = agent_session_pool;
 
-    if (asp == NULL) {
-        return NULL;
+    if (asp) {
+        agent_session_pool = asp->next;
+        agent_session_pool_len--;
+    } else {
+        asp = (netsnmp_agent_session *)
+            calloc(1, sizeof(netsnmp_agent_session));
+        if (asp == NULL)
+            return NULL;
+        agent_session_allocs++;
     }
 
     DEBUGMSGTL(("snmp_agent","agent_sesion %8p created\n", asp));
@@ -1588,7 +2045,10 @@ init_agent_snmp_session(netsnmp_session * session, netsnmp_pdu *pdu)
     asp->oldmode = 0;
     asp->treecache_num = -1;
     asp->treecache_len = 0;
-    asp->reqinfo = SNMP_MALLOC_TYPEDEF(netsnmp_agent_request_info);
+    if (NULL == asp->reqinfo) {
+        asp->reqinfo = SNMP_MALLOC_TYPEDEF(netsnmp_agent_request_info);
+        agent_session_allocs++;
+    }
     asp->flags = SNMP_AGENT_FLAGS_NONE;
     DEBUGMSGTL(("verbose:asp", "asp %p reqinfo %p created\n",
                 asp, asp->reqinfo));
@@ -1598,6 +2058,7 @@ init_agent_snmp_session(netsnmp_session * session, netsnmp_pdu *pdu)
 err:
     snmp_free_pdu(asp->orig_pdu);
     snmp_free_pdu(asp->pdu);
+    SNMP_FREE(asp->reqinfo);
     free(asp);
     return NULL;
 }
@@ -1619,21 +2080,38 @@ free_agent_snmp_session(netsnmp_agent_session *asp)
         snmp_free_pdu(asp->orig_pdu);
     if (asp->pdu)
         snmp_free_pdu(asp->pdu);
-    if (asp->reqinfo)
-        netsnmp_free_agent_request_info(asp->reqinfo);
-    SNMP_FREE(asp->treecache);
+    if (asp->treecache)
+        _agent_array_put(&agent_treecache_pool, asp->treecache,
+                         asp->treecache_len);
     SNMP_FREE(asp->bulkcache);
     if (asp->requests) {
         int             i;
         for (i = 0; i < asp->vbcount; i++) {
             netsnmp_free_request_data_sets(&asp->requests[i]);
         }
-        SNMP_FREE(asp->requests);
+        _agent_array_put(&agent_requests_pool, asp->requests,
+                         asp->requests_len);
     }
     if (asp->cache_store) {
         netsnmp_free_cachemap(asp->cache_store);
         asp->cache_store = NULL;
     }
+
+    if (asp->reqinfo && agent_session_pool_len < AGENT_SESSION_POOL_MAX) {
+        netsnmp_agent_request_info *reqinfo = asp->reqinfo;
+
+        if (reqinfo->agent_data)
+            netsnmp_free_all_list_data(reqinfo->agent_data);
+        memset(reqinfo, 0, sizeof(*reqinfo));
+        memset(asp, 0, sizeof(*asp));
+        asp->reqinfo = reqinfo;
+        asp->next = agent_session_pool;
+        agent_session_pool = asp;
+        agent_session_pool_len++;
+        return;
+    }
+    if (asp->reqinfo)
+        netsnmp_free_agent_request_info(asp->reqinfo);
     SNMP_FREE(asp);
 }
 
@@ -1943,6 +2421,16 @@ netsnmp_wrap_up_request(netsnmp_agent_session *asp, int status)
                 break;
         }
 
+        if (_memo_subtrees) {
+            if (asp->orig_pdu && asp->orig_pdu->command == SNMP_MSG_SET)
+                _memo_flush();
+            else if (status == SNMP_ERR_NOERROR &&
+                     asp->status == SNMP_ERR_NOERROR &&
+                     (asp->pdu->command == SNMP_MSG_GET ||
+                      asp->pdu->command == SNMP_MSG_GETNEXT))
+                _memo_store(asp);
+        }
+
         /*
          * May need to "dumb down" a SET error status for a
          * v1 query.  See RFC2576 - section 4.3
@@ -2469,6 +2957,7 @@ netsnmp_add_varbind_to_cache(netsnmp_agent_session *asp, int vbcount,
                             asp->treecache_len);
                 if (asp->treecache == NULL)
                     return NULL;
+                agent_session_allocs++;
                 memset(asp->treecache + cacheid, 0,
                        sizeof(netsnmp_tree_cache) * (CACHE_GROW_SIZE));
             }
@@ -2585,7 +3074,7 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
 {
     netsnmp_subtree *tp;
     netsnmp_variable_list *varbind_ptr, *vbsave, *vbptr, **prevNext;
-    int             view;
+    int             view, memo_hit;
     int             vbcount = 0;
     int             bulkcount = 0, bulkrep = 0;
     int             i = 0, n = 0, r = 0;
@@ -2599,9 +3088,10 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
     DEBUGMSGTL(("msgMaxSize", "pdu max size %lu\n", asp->pdu->msgMaxSize));
 
     if (asp->treecache == NULL && asp->treecache_len == 0) {
-        asp->treecache_len = SNMP_MAX(1 + asp->vbcount / 4, 16);
-        asp->treecache =
-            (netsnmp_tree_cache *)calloc(asp->treecache_len, sizeof(netsnmp_tree_cache));
+        asp->treecache = (netsnmp_tree_cache *)
+            _agent_array_get(&agent_treecache_pool,
+                             SNMP_MAX(1 + asp->vbcount / 4, 16),
+                             sizeof(netsnmp_tree_cache), &asp->treecache_len);
         if (asp->treecache == NULL)
             return SNMP_ERR_GENERR;
     }
@@ -2768,6 +3258,7 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
         /*
          * check access control 
          */
+        memo_hit = 0;
         switch (asp->pdu->command) {
         case SNMP_MSG_GET:
             view = in_a_view(varbind_ptr->name, &varbind_ptr->name_length,
@@ -2775,6 +3266,8 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
             if (view != VACM_SUCCESS)
                 snmp_set_var_typed_value(varbind_ptr, SNMP_NOSUCHOBJECT,
                                          NULL, 0);
+            else if (_memo_subtrees)
+                memo_hit = _memo_lookup(asp, varbind_ptr);
             break;
 
 #ifndef NETSNMP_NO_WRITE_SUPPORT
@@ -2789,6 +3282,11 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
 
         case SNMP_MSG_GETNEXT:
+            view = VACM_SUCCESS;
+            if (_memo_subtrees)
+                memo_hit = _memo_lookup(asp, varbind_ptr);
+            break;
+
         case SNMP_MSG_GETBULK:
         default:
             view = VACM_SUCCESS;
@@ -2796,7 +3294,8 @@ netsnmp_create_subtree_cache(netsnmp_agent_session *asp)
              * XXXWWW: check VACM here to see if "tp" is even worthwhile 
              */
         }
-        if (view == VACM_SUCCESS) {
+        /* answers found in the memo don't need a handler */
+        if (view == VACM_SUCCESS && !memo_hit) {
             request = netsnmp_add_varbind_to_cache(asp, vbcount, varbind_ptr,
 						   tp);
             if (request && asp->pdu->command == SNMP_MSG_GETBULK) {
@@ -2825,19 +3324,11 @@ netsnmp_reassign_requests(netsnmp_agent_session *asp)
     int             i;
 
     /*
-     * get old info 
+     * start over with an empty cache, reusing the old array
      */
-    netsnmp_tree_cache *old_treecache = asp->treecache;
-
-    /*
-     * malloc new space 
-     */
-    asp->treecache =
-        (netsnmp_tree_cache *) calloc(asp->treecache_len,
-                                      sizeof(netsnmp_tree_cache));
-
     if (asp->treecache == NULL)
         return SNMP_ERR_GENERR;
+    memset(asp->treecache, 0, asp->treecache_len * sizeof(netsnmp_tree_cache));
 
     asp->treecache_num = -1;
     if (asp->cache_store) {
@@ -2854,25 +3345,20 @@ netsnmp_reassign_requests(netsnmp_agent_session *asp)
             continue;
         }
         if (asp->requests[i].requestvb->type == ASN_NULL) {
-            if (!netsnmp_add_varbind_to_cache(asp, asp->requests[i].index,
-                                              asp->requests[i].requestvb,
-                                              asp->requests[i].subtree->next)) {
-                SNMP_FREE(old_treecache);
-            }
+            netsnmp_add_varbind_to_cache(asp, asp->requests[i].index,
+                                         asp->requests[i].requestvb,
+                                         asp->requests[i].subtree->next);
         } else if (asp->requests[i].requestvb->type == ASN_PRIV_RETRY) {
             /*
              * re-add the same subtree 
              */
             asp->requests[i].requestvb->type = ASN_NULL;
-            if (!netsnmp_add_varbind_to_cache(asp, asp->requests[i].index,
-                                              asp->requests[i].requestvb,
-                                              asp->requests[i].subtree)) {
-                SNMP_FREE(old_treecache);
-            }
+            netsnmp_add_varbind_to_cache(asp, asp->requests[i].index,
+                                         asp->requests[i].requestvb,
+                                         asp->requests[i].subtree);
         }
     }
 
-    SNMP_FREE(old_treecache);
     return SNMP_ERR_NOERROR;
 }
 
@@ -2987,16 +3473,320 @@ netsnmp_check_all_requests_status(netsnmp_agent_session *asp,
     return asp->status;
 }
 
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+/*
+ * Worker threads for read-only requests.
+ *
+ * With "agentThreads N" configured, the subtrees of a GET, GETNEXT or
+ * GETBULK pass of handle_var_requests() that are registered with
+ * HANDLER_CAN_THREADSAFE are split into one job per registration, and N
+ * workers plus the main thread run those jobs in parallel.  The main
+ * thread waits for the jobs before calling the remaining handlers itself
+ * and looking at the results, so registry lookups, access control,
+ * delegation, queued requests and SETs all stay where they were; only
+ * the threadsafe handlers run concurrently.  Passes with fewer than two
+ * threadsafe registrations are not dispatched at all.
+ *
+ * A registration is never called from two threads at once: helpers keep
+ * per call state in their handler (MIB_HANDLER_AUTO_NEXT_OVERRIDE_ONCE),
+ * so the requests of one registration are always handled by one job.
+ * Each job gets its own copy of the agent request info, and data the
+ * handlers attach to it is merged back once the pass is over.
+ */
+typedef struct agent_thread_job_s {
+    netsnmp_handler_registration *reginfo;
+    netsnmp_agent_request_info reqinfo;
+    netsnmp_agent_session *asp;
+    int             first;      /* first subtree cache entry of this job */
+    int            *statuses;
+    struct agent_thread_job_s *next;
+} agent_thread_job;
+
+#define AGENT_THREAD_NOT_CALLED (-1)
+
+static pthread_mutex_t agent_thread_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t agent_thread_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t agent_thread_done = PTHREAD_COND_INITIALIZER;
+static pthread_t *agent_threads = NULL;
+static int      agent_thread_count = 0;
+static int      agent_thread_stopping = 0;
+static int      agent_thread_pending = 0;  /* jobs queued or running */
+static agent_thread_job *agent_thread_queue = NULL;
+
+/*
+ * per pass buffers, indexed by subtree cache entry; they only ever grow,
+ * so that a pass doesn't allocate anything once the agent is warmed up
+ */
+static agent_thread_job *agent_thread_jobs = NULL;
+static int     *agent_thread_chain = NULL;  /* next entry of the same job */
+static int     *agent_thread_last = NULL;   /* last entry of each job */
+static int     *agent_thread_statuses = NULL;
+static int      agent_thread_buf_len = 0;
+
+static void
+_agent_thread_run(agent_thread_job *job)
+{
+    netsnmp_agent_session *asp = job->asp;
+    int             i;
+
+    for (i = job->first; i >= 0; i = agent_thread_chain[i])
+        job->statuses[i] =
+            netsnmp_call_handlers(job->reginfo, &job->reqinfo,
+                                  asp->treecache[i].requests_begin);
+}
+
+/*
+ * runs queued jobs until the queue is empty; called with the lock held
+ */
+static void
+_agent_thread_drain(void)
+{
+    agent_thread_job *job;
+
+    while ((job = agent_thread_queue) != NULL) {
+        agent_thread_queue = job->next;
+        pthread_mutex_unlock(&agent_thread_lock);
+
+        _agent_thread_run(job);
+
+        pthread_mutex_lock(&agent_thread_lock);
+        if (--agent_thread_pending == 0)
+            pthread_cond_signal(&agent_thread_done);
+    }
+}
+
+static void    *
+_agent_thread_main(void *arg)
+{
+    pthread_mutex_lock(&agent_thread_lock);
+    while (!agent_thread_stopping) {
+        _agent_thread_drain();
+        if (!agent_thread_stopping)
+            pthread_cond_wait(&agent_thread_work, &agent_thread_lock);
+    }
+    pthread_mutex_unlock(&agent_thread_lock);
+    return NULL;
+}
+
+static void
+_agent_threads_stop(void)
+{
+    int             i;
+
+    if (NULL != agent_threads) {
+        pthread_mutex_lock(&agent_thread_lock);
+        agent_thread_stopping = 1;
+        pthread_cond_broadcast(&agent_thread_work);
+        pthread_mutex_unlock(&agent_thread_lock);
+
+        for (i = 0; i < agent_thread_count; i++)
+            pthread_join(agent_threads[i], NULL);
+        DEBUGMSGTL(("snmp_agent:threads", "stopped %d worker threads\n",
+                    agent_thread_count));
+        SNMP_FREE(agent_threads);
+    }
+
+    SNMP_FREE(agent_thread_jobs);
+    SNMP_FREE(agent_thread_chain);
+    SNMP_FREE(agent_thread_last);
+    SNMP_FREE(agent_thread_statuses);
+    agent_thread_buf_len = 0;
+    agent_thread_count = 0;
+    agent_thread_stopping = 0;
+}
+
+static void
+_agent_threads_start(int count)
+{
+    agent_threads = calloc(count, sizeof(pthread_t));
+    if (NULL == agent_threads)
+        return;
+
+    for (agent_thread_count = 0; agent_thread_count < count;
+         agent_thread_count++) {
+        if (pthread_create(&agent_threads[agent_thread_count], NULL,
+                           _agent_thread_main, NULL) != 0) {
+            snmp_log(LOG_WARNING, "agentThreads: only %d of %d worker "
+                     "threads could be started\n", agent_thread_count,
+                     count);
+            break;
+        }
+    }
+    if (0 == agent_thread_count)
+        SNMP_FREE(agent_threads);
+    DEBUGMSGTL(("snmp_agent:threads", "started %d worker threads\n",
+                agent_thread_count));
+}
+
+/*
+ * makes room for len subtree cache entries in the per pass buffers
+ */
+static int
+_agent_threads_grow(int len)
+{
+    agent_thread_job *jobs;
+    int            *chain, *last, *statuses;
+
+    if (len <= agent_thread_buf_len)
+        return SNMPERR_SUCCESS;
+
+    len += 16;
+    jobs = realloc(agent_thread_jobs, len * sizeof(agent_thread_job));
+    if (NULL == jobs)
+        return SNMPERR_GENERR;
+    agent_thread_jobs = jobs;
+    chain = realloc(agent_thread_chain, len * sizeof(int));
+    if (NULL == chain)
+        return SNMPERR_GENERR;
+    agent_thread_chain = chain;
+    last = realloc(agent_thread_last, len * sizeof(int));
+    if (NULL == last)
+        return SNMPERR_GENERR;
+    agent_thread_last = last;
+    statuses = realloc(agent_thread_statuses, len * sizeof(int));
+    if (NULL == statuses)
+        return SNMPERR_GENERR;
+    agent_thread_statuses = statuses;
+
+    agent_thread_buf_len = len;
+    return SNMPERR_SUCCESS;
+}
+
+static int
+_agent_thread_safe(netsnmp_agent_session *asp, int i)
+{
+    netsnmp_handler_registration *reginfo = asp->treecache[i].subtree->reginfo;
+
+    return (NULL != reginfo && (reginfo->modes & HANDLER_CAN_THREADSAFE));
+}
+
+/*
+ * Calls the threadsafe handlers for one pass over the subtree cache of
+ * asp through the worker threads.
+ *
+ * Returns an array with the status of each subtree, owned by this code
+ * and valid until the next pass, where the subtrees that have not been
+ * called are set to AGENT_THREAD_NOT_CALLED.  Returns NULL if the pass
+ * has to be done on the main thread (nothing has been called then).
+ */
+static int     *
+_agent_threads_call_handlers(netsnmp_agent_session *asp)
+{
+    netsnmp_handler_registration *reginfo, *first = NULL;
+    netsnmp_data_list *data;
+    agent_thread_job *jobs, *job;
+    int             i, count, njobs;
+
+    switch (asp->mode) {
+    case MODE_GET:
+    case MODE_GETNEXT:
+    case MODE_GETBULK:
+        break;
+    default:
+        return NULL;
+    }
+
+    count = netsnmp_ds_get_int(NETSNMP_DS_APPLICATION_ID,
+                               NETSNMP_DS_AGENT_THREADS);
+    if (count < 0)
+        count = 0;
+    if (count != agent_thread_count) {
+        /* (re)configured; nothing is running between passes */
+        _agent_threads_stop();
+        if (count > 0)
+            _agent_threads_start(count);
+    }
+    if (0 == agent_thread_count || asp->treecache_num < 1)
+        return NULL;
+
+    /*
+     * only worth it with at least two threadsafe registrations
+     */
+    for (i = 0; i <= asp->treecache_num; i++) {
+        if (!_agent_thread_safe(asp, i))
+            continue;
+        reginfo = asp->treecache[i].subtree->reginfo;
+        if (NULL == first)
+            first = reginfo;
+        else if (reginfo != first)
+            break;
+    }
+    if (i > asp->treecache_num)
+        return NULL;
+
+    if (_agent_threads_grow(asp->treecache_num + 1) != SNMPERR_SUCCESS)
+        return NULL;
+    jobs = agent_thread_jobs;
+
+    /*
+     * one job per threadsafe registration, chaining its subtree cache
+     * entries
+     */
+    for (i = 0, njobs = 0; i <= asp->treecache_num; i++) {
+        agent_thread_statuses[i] = AGENT_THREAD_NOT_CALLED;
+        agent_thread_chain[i] = -1;
+        if (!_agent_thread_safe(asp, i))
+            continue;
+        reginfo = asp->treecache[i].subtree->reginfo;
+        for (job = jobs; job < jobs + njobs; job++)
+            if (job->reginfo == reginfo)
+                break;
+        if (job == jobs + njobs) {
+            memset(job, 0, sizeof(*job));
+            job->reginfo = reginfo;
+            job->reqinfo.mode = asp->reqinfo->mode;
+            job->reqinfo.asp = asp;
+            job->asp = asp;
+            job->statuses = agent_thread_statuses;
+            job->first = i;
+            njobs++;
+        } else
+            agent_thread_chain[agent_thread_last[job - jobs]] = i;
+        agent_thread_last[job - jobs] = i;
+    }
+
+    for (job = jobs; job < jobs + njobs - 1; job++)
+        job->next = job + 1;
+    DEBUGMSGTL(("snmp_agent:threads", "asp %p: %d subtrees, %d jobs\n",
+                asp, asp->treecache_num + 1, njobs));
+
+    pthread_mutex_lock(&agent_thread_lock);
+    agent_thread_queue = jobs;
+    agent_thread_pending = njobs;
+    pthread_cond_broadcast(&agent_thread_work);
+    _agent_thread_drain();
+    while (agent_thread_pending > 0)
+        pthread_cond_wait(&agent_thread_done, &agent_thread_lock);
+    pthread_mutex_unlock(&agent_thread_lock);
+
+    for (job = jobs; job < jobs + njobs; job++) {
+        while ((data = job->reqinfo.agent_data) != NULL) {
+            job->reqinfo.agent_data = data->next;
+            data->next = NULL;
+            netsnmp_agent_add_list_data(asp->reqinfo, data);
+        }
+    }
+    return agent_thread_statuses;
+}
+#endif /* NETSNMP_REENTRANT && HAVE_PTHREAD_H */
+
 int
 handle_var_requests(netsnmp_agent_session *asp)
 {
     int             i, retstatus = SNMP_ERR_NOERROR,
         status = SNMP_ERR_NOERROR, final_status = SNMP_ERR_NOERROR;
     netsnmp_handler_registration *reginfo;
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+    int            *statuses = NULL;
+#endif
 
     asp->reqinfo->asp = asp;
     asp->reqinfo->mode = asp->mode;
 
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+    statuses = _agent_threads_call_handlers(asp);
+#endif
+
     /*
      * now, have the subtrees in the cache go search for their results 
      */
@@ -3007,6 +3797,11 @@ handle_var_requests(netsnmp_agent_session *asp)
          * - should this case encompass more of this subroutine?
          *   - does check_request_status make send if handlers weren't called?
          */
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+        if (statuses && statuses[i] != AGENT_THREAD_NOT_CALLED)
+            status = statuses[i];
+        else
+#endif
         if(NULL != asp->treecache[i].subtree->reginfo) {
             reginfo = asp->treecache[i].subtree->reginfo;
             status = netsnmp_call_handlers(reginfo, asp->reqinfo,
@@ -3071,6 +3866,8 @@ handle_var_requests(netsnmp_agent_session *asp)
             final_status = status;
         }
     }
+#if defined(NETSNMP_REENTRANT) && defined(HAVE_PTHREAD_H)
+#endif
 
     return final_status;
 }
@@ -3766,7 +4563,11 @@ handle_pdu(netsnmp_agent_session *asp)
     case SNMP_MSG_INTERNAL_SET_RESERVE1:
 #endif /* NETSNMP_NO_WRITE_SUPPORT */
         asp->vbcount = count_varbinds(asp->pdu->variables);
-        asp->requests = calloc(asp->vbcount, sizeof(netsnmp_request_info));
+        if (asp->vbcount > 0)
+            asp->requests = (netsnmp_request_info *)
+                _agent_array_get(&agent_requests_pool, asp->vbcount,
+                                 sizeof(netsnmp_request_info),
+                                 &asp->requests_len);
         /*
          * collect varbinds 
          */
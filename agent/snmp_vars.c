@@ -237,6 +237,13 @@ u_char          return_buf[256];        /* nee 64 */
 static int
 _warn_if_all_disabled(int maj, int min, void *serverarg, void *clientarg);
 
+static int
+_shutdown_agent_threads(int maj, int min, void *serverarg, void *clientarg)
+{
+    netsnmp_agent_threads_shutdown();
+    return SNMP_ERR_NOERROR;
+}
+
 int             callback_master_num = -1;
 
 #ifdef NETSNMP_TRANSPORT_CALLBACK_DOMAIN
@@ -309,6 +316,8 @@ init_agent(const char *app)
                            SNMP_CALLBACK_POST_READ_CONFIG,
                            _warn_if_all_disabled, NULL);
 #endif /* NETSNMP_FEATURE_REMOVE_RUNTIME_DISABLE_VERSION */
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_SHUTDOWN,
+                           _shutdown_agent_threads, NULL);
 
     netsnmp_init_helpers();
     init_traps();
@@ -370,6 +379,7 @@ void
 shutdown_agent(void) {
 
     /* probably some of this can be called as shutdown callback */
+    netsnmp_agent_threads_shutdown();
     shutdown_tree();
     clear_context();
     netsnmp_clear_callback_list();
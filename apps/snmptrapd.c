@@ -502,6 +502,12 @@ parse_config_addForwarderInfo(const char *token, char *cptr)
     }
 }
 
+/*
+ * Number of queued notifications handled per idle poll of the main loop
+ * before checking for new input again.
+ */
+#define SNMPTRAPD_QUEUE_BATCH 32
+
 static void
 snmptrapd_main_loop(void)
 {
@@ -521,6 +527,11 @@ snmptrapd_main_loop(void)
                 netsnmp_logging_restart();
                 snmp_log(LOG_INFO, "NET-SNMP version %s restarted\n",
                          netsnmp_get_version());
+            /*
+             * Queued notifications were accepted under the old
+             * configuration, so handle them before it is discarded.
+             */
+            snmptrapd_run_queue(0);
             trapd_update_config();
             if (trap1_fmt_str_remember) {
                 parse_format( NULL, trap1_fmt_str_remember );
@@ -538,6 +549,14 @@ snmptrapd_main_loop(void)
 #ifndef NETSNMP_FEATURE_REMOVE_FD_EVENT_MANAGER
         netsnmp_external_event_info(&numfds, &readfds, &writefds, &exceptfds);
 #endif /* NETSNMP_FEATURE_REMOVE_FD_EVENT_MANAGER */
+        if (snmptrapd_queue_pending()) {
+            /*
+             * Deferred output handlers are waiting: just poll, so that
+             * they run as soon as there is no more input to read.
+             */
+            block = 0;
+            timerclear(&timeout);
+        }
         timeout2.tv_sec = timeout.tv_sec;
         timeout2.tv_usec = timeout.tv_usec;
         count = select(numfds, &readfds, &writefds, &exceptfds,
@@ -556,6 +575,7 @@ snmptrapd_main_loop(void)
             switch (count) {
             case 0:
                 snmp_timeout();
+                snmptrapd_run_queue(SNMPTRAPD_QUEUE_BATCH);
                 break;
             case -1:
                 if (errno == EINTR)
@@ -1320,6 +1340,7 @@ main(int argc, char *argv[])
                  tm->tm_min, tm->tm_sec, netsnmp_get_version());
     }
     snmp_log(LOG_INFO, "Stopping snmptrapd\n");
+    snmptrapd_run_queue(0);
     
 #ifdef NETSNMP_EMBEDDED_PERL
     shutdown_perl();
@@ -187,3 +187,23 @@ netsnmp_trapd_check_auth(int authtypes)
     return ((authtypes & lastlookup) == authtypes);
 }
 
+/**
+ * Returns the result of the most recent authorization lookup, so that
+ * a notification whose handlers are run later can carry it along.
+ */
+int
+netsnmp_trapd_get_auth(void)
+{
+    return lastlookup;
+}
+
+/**
+ * Restores an authorization result previously saved with
+ * netsnmp_trapd_get_auth() before running deferred handlers.
+ */
+void
+netsnmp_trapd_set_auth(int authtypes)
+{
+    lastlookup = authtypes;
+}
+
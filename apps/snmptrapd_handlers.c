@@ -53,6 +53,12 @@ char *exec_format2   = NULL;
 int   SyslogTrap = 0;
 int   dropauth = 0;
 
+/*
+ * Maximum number of received notifications waiting for their output
+ * handlers.  Zero (the default) runs every handler inline on receipt.
+ */
+static int trapd_queue_max = 0;
+
 const char     *trap1_std_str = "%.4y-%.2m-%.2l %.2h:%.2j:%.2k %B [%b] (via %A [%a]): %N\n\t%W Trap (%q) Uptime: %#T\n%v\n";
 const char     *trap2_std_str = "%.4y-%.2m-%.2l %.2h:%.2j:%.2k %B [%b]:\n%v\n";
 
@@ -323,6 +329,24 @@ free_trap2_fmt(void)
 }
 
 
+static void
+parse_trapd_queue_length(const char *token, char *line)
+{
+    int len = atoi(line);
+
+    if (len < 0) {
+        config_perror("trapdQueueLength must not be negative");
+        return;
+    }
+    trapd_queue_max = len;
+}
+
+static void
+free_trapd_queue_length(void)
+{
+    trapd_queue_max = 0;
+}
+
 void
 snmptrapd_register_configs( void )
 {
@@ -339,6 +363,9 @@ snmptrapd_register_configs( void )
 			    "[print{,1,2}|syslog{,1,2}|execute{,1,2}] format");
     register_config_handler("snmptrapd", "forward",
                             parse_forward, NULL, "OID|\"default\" destination");
+    register_config_handler("snmptrapd", "trapdQueueLength",
+                            parse_trapd_queue_length, free_trapd_queue_length,
+                            "integer");
 }
 
 
@@ -1069,6 +1096,224 @@ int   notification_handler(netsnmp_pdu           *pdu,
 }
 #endif 
 
+/*
+ * Determine the OID that identifies the trap being handled.
+ * Returns 0 on success, or 1 if the PDU should be dropped.
+ */
+static int
+_trapd_get_trap_oid(netsnmp_pdu *pdu, oid *trapOid, int *trapOidLen)
+{
+    oid stdTrapOidRoot[] = { 1, 3, 6, 1, 6, 3, 1, 1, 5 };
+    oid snmpTrapOid[]    = { 1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
+    netsnmp_variable_list *vars;
+
+    DEBUGMSGTL(("snmptrapd", "input: %x\n", pdu->command));
+    switch (pdu->command) {
+    case SNMP_MSG_TRAP:
+        /*
+         * Convert v1 traps into a v2-style trap OID
+         *    (following RFC 2576)
+         */
+        if (pdu->trap_type == SNMP_TRAP_ENTERPRISESPECIFIC) {
+            *trapOidLen = pdu->enterprise_length;
+            memcpy(trapOid, pdu->enterprise, sizeof(oid) * *trapOidLen);
+            if (trapOid[*trapOidLen - 1] != 0) {
+                trapOid[(*trapOidLen)++] = 0;
+            }
+            trapOid[(*trapOidLen)++] = pdu->specific_type;
+        } else {
+            memcpy(trapOid, stdTrapOidRoot, sizeof(stdTrapOidRoot));
+            *trapOidLen = OID_LENGTH(stdTrapOidRoot);  /* 9 */
+            trapOid[(*trapOidLen)++] = pdu->trap_type+1;
+        }
+        break;
+
+    case SNMP_MSG_TRAP2:
+    case SNMP_MSG_INFORM:
+        /*
+         * v2c/v3 notifications *should* have snmpTrapOID as the
+         *    second varbind, so we can go straight there.
+         *    But check, just to make sure
+         */
+        vars = pdu->variables;
+        if (vars)
+            vars = vars->next_variable;
+        if (!vars || snmp_oid_compare(vars->name, vars->name_length,
+                                      snmpTrapOid, OID_LENGTH(snmpTrapOid))) {
+            /*
+             * Didn't find it!
+             * Let's look through the full list....
+             */
+            for ( vars = pdu->variables; vars; vars=vars->next_variable) {
+                if (!snmp_oid_compare(vars->name, vars->name_length,
+                                      snmpTrapOid, OID_LENGTH(snmpTrapOid)))
+                    break;
+            }
+            if (!vars) {
+                /*
+                 * Still can't find it!  Give up.
+                 */
+                snmp_log(LOG_ERR, "Cannot find TrapOID in TRAP2 PDU\n");
+                return 1;		/* ??? */
+            }
+        }
+        memcpy(trapOid, vars->val.objid, vars->val_len);
+        *trapOidLen = vars->val_len /sizeof(oid);
+        break;
+
+    default:
+        /* SHOULDN'T HAPPEN! */
+        return 1;	/* ??? */
+    }
+    DEBUGMSGTL(( "snmptrapd", "Trap OID: "));
+    DEBUGMSGOID(("snmptrapd", trapOid, *trapOidLen));
+    DEBUGMSG(( "snmptrapd", "\n"));
+    return 0;
+}
+
+/*
+ *  Call the lists of handlers handlers[first] up to (but not including)
+ *  handlers[last], or the end of the table if last is -1.
+ *
+ *  Returns NETSNMPTRAPD_HANDLER_FINISH if a handler aborted all further
+ *  processing of this trap, NETSNMPTRAPD_HANDLER_OK otherwise.
+ */
+static int
+_trapd_run_handlers(netsnmp_pdu *pdu, netsnmp_transport *transport,
+                    oid *trapOid, int trapOidLen, int first, int last)
+{
+    netsnmp_trapd_handler *traph;
+    int ret, idx;
+
+    for( idx = first; handlers[idx].descr && idx != last; ++idx ) {
+        DEBUGMSGTL(("snmptrapd", "Running %s handlers\n",
+                    handlers[idx].descr));
+        if (NULL == handlers[idx].handler) /* specific */
+            traph = netsnmp_get_traphandler(trapOid, trapOidLen);
+        else
+            traph = *handlers[idx].handler;
+
+        for( ; traph; traph = traph->nexth) {
+            if (!netsnmp_trapd_check_auth(traph->authtypes))
+                continue; /* we continue on and skip this one */
+
+            ret = (*(traph->handler))(pdu, transport, traph);
+            if(NETSNMPTRAPD_HANDLER_FINISH == ret)
+                return NETSNMPTRAPD_HANDLER_FINISH;
+            if (ret == NETSNMPTRAPD_HANDLER_BREAK)
+                break; /* move on to next type */
+        } /* traph */
+    } /* handlers */
+
+    return NETSNMPTRAPD_HANDLER_OK;
+}
+
+/*-----------------------------
+ *
+ * Deferred output handlers
+ *
+ *   When "trapdQueueLength" is set, the receive path only decodes the
+ *   notification, runs the authorization handlers and acknowledges
+ *   INFORMs.  The remaining (potentially slow) output handlers are run
+ *   from the main loop once no further input is waiting, so that a burst
+ *   of notifications is drained from the socket before it overflows.
+ *   The queue is strictly FIFO, so the order in which notifications
+ *   from any one source are handled is unchanged.
+ *
+ *-----------------------------*/
+
+typedef struct netsnmp_trapd_queued_s {
+    netsnmp_pdu       *pdu;
+    netsnmp_transport *transport;
+    int                authtypes;
+    oid                trapOid[MAX_OID_LEN+2];
+    int                trapOidLen;
+    struct netsnmp_trapd_queued_s *next;
+} netsnmp_trapd_queued;
+
+static netsnmp_trapd_queued *trapd_queue_head = NULL;
+static netsnmp_trapd_queued *trapd_queue_tail = NULL;
+static int                   trapd_queue_len  = 0;
+
+/*
+ * Returns non-zero if notifications are waiting for their output handlers.
+ */
+int
+snmptrapd_queue_pending(void)
+{
+    return trapd_queue_head != NULL;
+}
+
+/*
+ * Runs the output handlers for up to max queued notifications
+ * (all of them if max is 0), oldest first.
+ */
+void
+snmptrapd_run_queue(int max)
+{
+    netsnmp_trapd_queued *item;
+    int saved_auth = netsnmp_trapd_get_auth();
+    int count = 0;
+
+    while ((item = trapd_queue_head) != NULL && (max == 0 || count < max)) {
+        trapd_queue_head = item->next;
+        if (trapd_queue_head == NULL)
+            trapd_queue_tail = NULL;
+        trapd_queue_len--;
+        count++;
+
+        DEBUGMSGTL(("snmptrapd:queue", "running deferred handlers (%d left)\n",
+                    trapd_queue_len));
+        netsnmp_trapd_set_auth(item->authtypes);
+        _trapd_run_handlers(item->pdu, item->transport,
+                            item->trapOid, item->trapOidLen, 1, -1);
+        snmp_free_pdu(item->pdu);
+        free(item);
+    }
+    netsnmp_trapd_set_auth(saved_auth);
+}
+
+/*
+ * Queues a notification that has passed authorization.
+ * Returns 0 on success, or 1 if it could not be queued.
+ */
+static int
+_trapd_queue_add(netsnmp_pdu *pdu, netsnmp_transport *transport,
+                 oid *trapOid, int trapOidLen)
+{
+    netsnmp_trapd_queued *item;
+
+    /*
+     * Queue full: make room by handling the oldest entry now,
+     * which keeps the processing order intact.
+     */
+    if (trapd_queue_len >= trapd_queue_max)
+        snmptrapd_run_queue(trapd_queue_len - trapd_queue_max + 1);
+
+    item = SNMP_MALLOC_TYPEDEF(netsnmp_trapd_queued);
+    if (!item)
+        return 1;
+    item->pdu = snmp_clone_pdu(pdu);
+    if (!item->pdu) {
+        free(item);
+        return 1;
+    }
+    item->transport  = transport;
+    item->authtypes  = netsnmp_trapd_get_auth();
+    memcpy(item->trapOid, trapOid, trapOidLen * sizeof(oid));
+    item->trapOidLen = trapOidLen;
+
+    if (trapd_queue_tail)
+        trapd_queue_tail->next = item;
+    else
+        trapd_queue_head = item;
+    trapd_queue_tail = item;
+    trapd_queue_len++;
+    DEBUGMSGTL(("snmptrapd:queue", "queued notification (%d waiting)\n",
+                trapd_queue_len));
+    return 0;
+}
+
 /*-----------------------------
  *
  * Main driving code, to process an incoming trap
@@ -1081,14 +1326,10 @@ int
 snmp_input(int op, netsnmp_session *session,
            int reqid, netsnmp_pdu *pdu, void *magic)
 {
-    oid stdTrapOidRoot[] = { 1, 3, 6, 1, 6, 3, 1, 1, 5 };
-    oid snmpTrapOid[]    = { 1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
     oid trapOid[MAX_OID_LEN+2] = {0};
     int trapOidLen;
-    netsnmp_variable_list *vars;
-    netsnmp_trapd_handler *traph;
     netsnmp_transport *transport = (netsnmp_transport *) magic;
-    int ret, idx;
+    int deferred;
 
     switch (op) {
     case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
@@ -1100,71 +1341,8 @@ snmp_input(int op, netsnmp_session *session,
             return 1;
         }
 
-        /*
-	 * Determine the OID that identifies the trap being handled
-	 */
-        DEBUGMSGTL(("snmptrapd", "input: %x\n", pdu->command));
-        switch (pdu->command) {
-        case SNMP_MSG_TRAP:
-            /*
-	     * Convert v1 traps into a v2-style trap OID
-	     *    (following RFC 2576)
-	     */
-            if (pdu->trap_type == SNMP_TRAP_ENTERPRISESPECIFIC) {
-                trapOidLen = pdu->enterprise_length;
-                memcpy(trapOid, pdu->enterprise, sizeof(oid) * trapOidLen);
-                if (trapOid[trapOidLen - 1] != 0) {
-                    trapOid[trapOidLen++] = 0;
-                }
-                trapOid[trapOidLen++] = pdu->specific_type;
-            } else {
-                memcpy(trapOid, stdTrapOidRoot, sizeof(stdTrapOidRoot));
-                trapOidLen = OID_LENGTH(stdTrapOidRoot);  /* 9 */
-                trapOid[trapOidLen++] = pdu->trap_type+1;
-            }
-            break;
-
-        case SNMP_MSG_TRAP2:
-        case SNMP_MSG_INFORM:
-            /*
-	     * v2c/v3 notifications *should* have snmpTrapOID as the
-	     *    second varbind, so we can go straight there.
-	     *    But check, just to make sure
-	     */
-            vars = pdu->variables;
-            if (vars)
-                vars = vars->next_variable;
-            if (!vars || snmp_oid_compare(vars->name, vars->name_length,
-                                          snmpTrapOid, OID_LENGTH(snmpTrapOid))) {
-	        /*
-		 * Didn't find it!
-		 * Let's look through the full list....
-		 */
-		for ( vars = pdu->variables; vars; vars=vars->next_variable) {
-                    if (!snmp_oid_compare(vars->name, vars->name_length,
-                                          snmpTrapOid, OID_LENGTH(snmpTrapOid)))
-                        break;
-                }
-                if (!vars) {
-	            /*
-		     * Still can't find it!  Give up.
-		     */
-		    snmp_log(LOG_ERR, "Cannot find TrapOID in TRAP2 PDU\n");
-		    return 1;		/* ??? */
-		}
-	    }
-            memcpy(trapOid, vars->val.objid, vars->val_len);
-            trapOidLen = vars->val_len /sizeof(oid);
-            break;
-
-        default:
-            /* SHOULDN'T HAPPEN! */
-            return 1;	/* ??? */
-	}
-        DEBUGMSGTL(( "snmptrapd", "Trap OID: "));
-        DEBUGMSGOID(("snmptrapd", trapOid, trapOidLen));
-        DEBUGMSG(( "snmptrapd", "\n"));
-
+        if (_trapd_get_trap_oid(pdu, trapOid, &trapOidLen))
+            return 1;
 
         /*
 	 *  OK - We've found the Trap OID used to identify this trap.
@@ -1173,7 +1351,7 @@ snmp_input(int op, netsnmp_session *session,
          *     b) other handlers to be applied to all traps
          *		(*before* trap-specific handlers)
          *     c) the handler(s) specific to this trap
-t        *     d) any other global handlers
+         *     d) any other global handlers
          *
 	 *  In each case, a particular trap handler can abort further
          *     processing - either just for that particular list,
@@ -1182,28 +1360,24 @@ t        *     d) any other global handlers
 	 *  This is particularly designed for authentication-related
 	 *     handlers, but can also be used elsewhere.
          *
+         *  If output handlers are deferred, only the authentication
+         *     handlers are run here and the rest are queued.
+         *
          *  OK - Enough waffling, let's get to work.....
 	 */
 
-        for( idx = 0; handlers[idx].descr; ++idx ) {
-            DEBUGMSGTL(("snmptrapd", "Running %s handlers\n",
-                        handlers[idx].descr));
-            if (NULL == handlers[idx].handler) /* specific */
-                traph = netsnmp_get_traphandler(trapOid, trapOidLen);
-            else
-                traph = *handlers[idx].handler;
-
-            for( ; traph; traph = traph->nexth) {
-                if (!netsnmp_trapd_check_auth(traph->authtypes))
-                    continue; /* we continue on and skip this one */
-
-                ret = (*(traph->handler))(pdu, transport, traph);
-                if(NETSNMPTRAPD_HANDLER_FINISH == ret)
-                    return 1;
-                if (ret == NETSNMPTRAPD_HANDLER_BREAK)
-                    break; /* move on to next type */
-            } /* traph */
-        } /* handlers */
+        deferred = (trapd_queue_max > 0);
+        if (_trapd_run_handlers(pdu, transport, trapOid, trapOidLen,
+                                0, deferred ? 1 : -1)
+            == NETSNMPTRAPD_HANDLER_FINISH)
+            return 1;
+        if (deferred &&
+            _trapd_queue_add(pdu, transport, trapOid, trapOidLen)) {
+            snmp_log(LOG_ERR, "couldn't queue notification; handling it now\n");
+            if (_trapd_run_handlers(pdu, transport, trapOid, trapOidLen,
+                                    1, -1) == NETSNMPTRAPD_HANDLER_FINISH)
+                return 1;
+        }
 
 
 	if (pdu->command == SNMP_MSG_INFORM) {
@@ -67,4 +67,7 @@ int snmp_input(int op, netsnmp_session *session,
 
 void parse_format(const char *token, char *line);
 
+int  snmptrapd_queue_pending(void);
+void snmptrapd_run_queue(int max);
+
 #endif                          /* SNMPTRAPD_HANDLERS_H */
@@ -87,6 +87,7 @@ typedef struct netsnmp_mib_handler_s {
 #define HANDLER_CAN_NOT_CREATE        0x08         /* auto set if ! CAN_SET */
 #define HANDLER_CAN_BABY_STEP         0x10
 #define HANDLER_CAN_STASH             0x20
+#define HANDLER_CAN_THREADSAFE        0x40      /* reads may run in a thread */
 
 
 #define HANDLER_CAN_RONLY   (HANDLER_CAN_GETANDGETNEXT)
@@ -136,8 +137,33 @@ typedef struct netsnmp_handler_registration_s {
          */
         void *          my_reg_void;
 
+        /**
+         * handler call counts and latencies, allocated on first call
+         */
+        struct netsnmp_handler_stats_s *stats;
+
 } netsnmp_handler_registration;
 
+/*
+ * Handler call statistics, kept per registration and per kind of request.
+ * Bucket 0 counts calls that took less than a microsecond, and bucket i
+ * those that took from 2^(i-1) up to 2^i microseconds; the last bucket
+ * also counts everything slower.
+ */
+#define NETSNMP_HANDLER_STATS_GET      0
+#define NETSNMP_HANDLER_STATS_GETNEXT  1
+#define NETSNMP_HANDLER_STATS_GETBULK  2
+#define NETSNMP_HANDLER_STATS_SET      3
+#define NETSNMP_HANDLER_STATS_MODES    4
+#define NETSNMP_HANDLER_STATS_BUCKETS  24
+
+typedef struct netsnmp_handler_stats_s {
+        u_long          calls[NETSNMP_HANDLER_STATS_MODES];
+        u_long          max_usec[NETSNMP_HANDLER_STATS_MODES];
+        u_long          buckets[NETSNMP_HANDLER_STATS_MODES]
+                               [NETSNMP_HANDLER_STATS_BUCKETS];
+} netsnmp_handler_stats;
+
 /*
  * function handler definitions 
  */
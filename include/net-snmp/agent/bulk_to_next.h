@@ -19,8 +19,10 @@ netsnmp_mib_handler *netsnmp_get_bulk_to_next_handler(void);
 void            netsnmp_init_bulk_to_next_helper(void);
 void            netsnmp_bulk_to_next_fix_requests(netsnmp_request_info
                                                   *requests);
+netsnmp_mib_handler *netsnmp_get_table_bulk_handler(void);
 
 Netsnmp_Node_Handler netsnmp_bulk_to_next_helper;
+Netsnmp_Node_Handler netsnmp_table_bulk_helper;
 
 #ifdef __cplusplus
 }
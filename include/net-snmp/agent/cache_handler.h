@@ -30,6 +30,17 @@ extern          "C" {
 
     typedef int  (NetsnmpCacheLoad)(netsnmp_cache *, void*);
     typedef void (NetsnmpCacheFree)(netsnmp_cache *, void*);
+    typedef int  (NetsnmpCacheApply)(netsnmp_cache *, int, void*, void*);
+
+    /*
+     * A change to the cached data, as reported by the data access code
+     * through netsnmp_cache_report_change().
+     */
+    typedef struct netsnmp_cache_change_s {
+        int      op;            /* NETSNMP_CACHE_CHANGE_* */
+        void    *data;
+        struct netsnmp_cache_change_s *next;
+    } netsnmp_cache_change;
 
     struct netsnmp_cache_s {
 	/** Number of handlers whose myvoid member points at this structure. */
@@ -67,6 +78,23 @@ extern          "C" {
         oid *rootoid;
         int  rootoid_len;
 
+        /*
+         * For background reloads (NETSNMP_CACHE_BACKGROUND_RELOAD)
+         */
+        u_long   reload_alarm;  /* pending reload alarm id */
+        u_long   load_time;     /* duration of the last load (in ms) */
+
+        /*
+         * For incremental updates (see netsnmp_cache_report_change)
+         */
+        NetsnmpCacheApply    *apply_change;
+        netsnmp_cache_change *changes, *changes_tail;
+
+        /*
+         * Bumped whenever the cached data is loaded, changed or freed,
+         * for users that keep data derived from it.
+         */
+        u_int    generation;
     };
 
 
@@ -104,12 +132,18 @@ extern          "C" {
     netsnmp_cache_handler_get(netsnmp_cache* cache);
     void netsnmp_cache_handler_owns_cache(netsnmp_mib_handler *handler);
 
+    void netsnmp_init_cache_handler(void);
+
     netsnmp_cache * netsnmp_cache_find_by_oid(const oid * rootoid,
                                               int rootoid_len);
 
     unsigned int netsnmp_cache_timer_start(netsnmp_cache *cache);
     void netsnmp_cache_timer_stop(netsnmp_cache *cache);
 
+    int  netsnmp_cache_report_change(netsnmp_cache *cache, int op,
+                                     void *data);
+    void netsnmp_cache_discard_changes(netsnmp_cache *cache);
+
 /*
  * Flags affecting cache handler operation
  */
@@ -120,9 +154,19 @@ extern          "C" {
 #define NETSNMP_CACHE_PRELOAD                               0x0010
 #define NETSNMP_CACHE_AUTO_RELOAD                           0x0020
 #define NETSNMP_CACHE_RESET_TIMER_ON_USE                    0x0040
+#define NETSNMP_CACHE_BACKGROUND_RELOAD                     0x0080
+#define NETSNMP_CACHE_PRELOAD_PENDING                       0x0100
 
 #define NETSNMP_CACHE_HINT_HANDLER_ARGS                     0x1000
 
+/*
+ * Operations for netsnmp_cache_report_change() and the apply_change hook
+ */
+#define NETSNMP_CACHE_CHANGE_INSERT                         1
+#define NETSNMP_CACHE_CHANGE_UPDATE                         2
+#define NETSNMP_CACHE_CHANGE_DELETE                         3
+#define NETSNMP_CACHE_CHANGE_DISCARD                        4
+
 
 #ifdef __cplusplus
 }
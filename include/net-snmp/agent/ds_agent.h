@@ -40,6 +40,10 @@
 #define NETSNMP_DS_AGENT_DISKIO_NO_FD   18      /* 1 = don't report /dev/fd*   entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_LOOP 19      /* 1 = don't report /dev/loop* entries in diskIOTable */
 #define NETSNMP_DS_AGENT_DISKIO_NO_RAM  20      /* 1 = don't report /dev/ram*  entries in diskIOTable */
+#define NETSNMP_DS_AGENT_NO_TABLE_BULK  21      /* 1 = GETBULK on tables one row per pass */
+#define NETSNMP_DS_AGENT_AGENTX_COALESCE 22     /* 1 = share identical AgentX reads */
+#define NETSNMP_DS_AGENT_NO_HANDLER_STATS 23    /* 1 = don't time handler calls */
+#define NETSNMP_DS_AGENT_LAZY_INIT      24      /* 1 = defer startup cache preload until a request uses the cache */
 
 /* WARNING: The trap receiver also uses DS flags and must not conflict with these!
  * If you define additional boolean entries, check in "apps/snmptrapd_ds.h" first */
@@ -77,4 +81,8 @@
 #define NETSNMP_DS_AGENT_AVG_BULKVARBINDSIZE 15 /* avg varbind size estimate */
 #define NETSNMP_DS_AGENT_PDU_STATS_MAX       16 /* size of top N array*/
 #define NETSNMP_DS_AGENT_PDU_STATS_THRESHOLD 17 /* minimum threshold time */
+#define NETSNMP_DS_AGENT_THREADS        18      /* read-only worker threads */
+#define NETSNMP_DS_AGENT_LAZY_PREWARM   19      /* seconds before lazy preloads */
+#define NETSNMP_DS_AGENT_AGENTX_BATCH   20      /* max varbinds per AgentX read */
+#define NETSNMP_DS_AGENT_AGENTX_BATCH_DELAY 21  /* msec to gather AgentX reads */
 #endif
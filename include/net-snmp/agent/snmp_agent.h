@@ -216,6 +216,7 @@ extern          "C" {
         netsnmp_cachemap *cache_store;
         int             vbcount;
         int             flags;
+        int             requests_len;   /* length of requests array */
     } netsnmp_agent_session;
 
     /*
@@ -236,6 +237,16 @@ extern          "C" {
     netsnmp_agent_session *init_agent_snmp_session(netsnmp_session *,
                                                    netsnmp_pdu *);
     void            free_agent_snmp_session(netsnmp_agent_session *);
+    u_long          netsnmp_get_agent_session_allocs(void);
+
+    /*
+     * response memo ("responseMemo" directive)
+     */
+    extern u_long   netsnmp_response_memo_hits;
+    extern u_long   netsnmp_response_memo_misses;
+    void            netsnmp_response_memo_parse(const char *token,
+                                                char *line);
+    void            netsnmp_response_memo_free(void);
     void           
         netsnmp_remove_and_free_agent_snmp_session(netsnmp_agent_session
                                                    *asp);
@@ -250,6 +261,7 @@ extern          "C" {
     void            dump_sess_list(void);
     int             init_master_agent(void);
     void            shutdown_master_agent(void);
+    void            netsnmp_agent_threads_shutdown(void);
     int             agent_check_and_process(int block);
     void            netsnmp_check_delegated_requests(void);
     void            netsnmp_check_outstanding_agent_requests(void);
@@ -36,6 +36,11 @@ extern          "C" {
         int             store_indexes;
         netsnmp_table_row *first_row;
         netsnmp_table_row *last_row;
+        /*
+         * index over the rows, kept in step with the list above by the
+         * add/remove functions below (rows must not be linked in by hand)
+         */
+        netsnmp_container *rows;
     } netsnmp_table_data;
 
 /* =================================
@@ -98,6 +98,7 @@ extern          "C" {
         int             flags;
 #define NETSNMP_ITERATOR_FLAG_SORTED	0x01
 #define NETSNMP_HANDLER_OWNS_IINFO	0x02
+#define NETSNMP_ITERATOR_FLAG_SNAPSHOT	0x04
 
        /** A pointer to the netsnmp_table_registration_info object
            this iterator is registered along with. */
@@ -107,6 +108,10 @@ extern          "C" {
            (these two fields may change/disappear without warning) */
         Netsnmp_First_Data_Point *get_row_indexes;
         netsnmp_variable_list *indexes;
+
+        /** Sorted copy of the row indexes, kept by the helper itself
+            (see NETSNMP_ITERATOR_FLAG_SNAPSHOT) */
+        void           *snapshot;
     } netsnmp_iterator_info;
 
 #define TABLE_ITERATOR_NAME "table_iterator"
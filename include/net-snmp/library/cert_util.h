@@ -161,6 +161,12 @@ extern "C" {
     netsnmp_cert_map *netsnmp_certToTSN_parse_common(char **line);
     int netsnmp_cert_get_secname_maps(netsnmp_container *cm);
 
+    char *netsnmp_cert_chain_fingerprint(netsnmp_container *chain_maps);
+    char *netsnmp_cert_secname_cache_find(const char *chain_fp);
+    void netsnmp_cert_secname_cache_add(const char *chain_fp,
+                                        const char *secname);
+    void netsnmp_cert_secname_cache_clear(void);
+
     /*************************************************************************
      *
      *  snmpTlstmParamsTable data
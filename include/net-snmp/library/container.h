@@ -294,6 +294,14 @@ extern "C" {
         */
        struct netsnmp_container_s *next, *prev;
 
+       /*
+        * OPTIONAL functions for loading many entries at once (see
+        * CONTAINER_LOAD_BEGIN). load_end passes entries it drops as
+        * duplicates to the given function.
+        */
+       netsnmp_container_rc           *load_begin;
+       netsnmp_container_func         *load_end;
+
     } netsnmp_container;
 
     /*
@@ -456,6 +464,21 @@ extern "C" {
     NETSNMP_IMPORT
     void CONTAINER_FREE_ALL(netsnmp_container *x, void *c);
 
+    /*
+     * load many entries into all containers at once. Between these calls,
+     * containers that support it just append inserted entries, without
+     * looking for their place or for duplicates. CONTAINER_LOAD_END then
+     * sorts each container once and drops entries with duplicate keys
+     * (unless duplicates are allowed), keeping the one inserted first:
+     * dropped entries are removed from the other containers and passed
+     * to f. Inserts into other containers behave as usual.
+     */
+    NETSNMP_IMPORT
+    void CONTAINER_LOAD_BEGIN(netsnmp_container *x);
+    NETSNMP_IMPORT
+    void CONTAINER_LOAD_END(netsnmp_container *x,
+                            netsnmp_container_obj_func *f, void *c);
+
     /*
      * free all containers
      */
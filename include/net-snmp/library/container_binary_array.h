@@ -29,12 +29,24 @@ extern          "C" {
      */
     netsnmp_factory *     netsnmp_container_get_binary_array_factory(void);
 
+    /*
+     * get a factory for producing binary_array objects that turn into
+     * btree containers once they hold more entries than the
+     * tableContainerBtreeThreshold snmp.conf setting.  It is registered
+     * as "large_table"; the positional get_at/insert_before/remove_at
+     * calls fail after the switch.
+     */
+    netsnmp_factory *     netsnmp_container_get_binary_array_growable_factory(void);
+
 
     int netsnmp_binary_array_remove(netsnmp_container *c, const void *key,
                                     void **save);
 
     void netsnmp_binary_array_release(netsnmp_container *c);
 
+    void **netsnmp_binary_array_get_subset(netsnmp_container *c, void *key,
+                                           int *len);
+
     void netsnmp_container_binary_array_init(void);
 
     int netsnmp_binary_array_options_set(netsnmp_container *c, int set, u_int flags);
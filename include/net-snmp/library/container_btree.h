@@ -0,0 +1,53 @@
+/*
+ * container_btree.h
+ * $Id$
+ *
+ */
+#ifndef NETSNMP_CONTAINER_BTREE_H
+#define NETSNMP_CONTAINER_BTREE_H
+
+
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/factory.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * initialize btree container. call at startup.
+     */
+    void netsnmp_container_btree_init(void);
+
+    /*
+     * get a container which uses a B+tree for storage
+     */
+    netsnmp_container *netsnmp_container_get_btree(void);
+
+    /*
+     * get a factory for producing btree objects
+     */
+    netsnmp_factory   *netsnmp_container_get_btree_factory(void);
+
+    /*
+     * turn c into a btree container holding the count entries of data,
+     * which must already be sorted by c->compare. Used by the binary_array
+     * container to switch storage once a table grows large; the previous
+     * container_data is left for the caller to release.
+     */
+    int netsnmp_container_btree_adopt(netsnmp_container *c, void **data,
+                                      size_t count);
+
+    /*
+     * remove the entry matching key from a btree container, preferring
+     * key itself among duplicates, and return it in save.
+     */
+    int netsnmp_container_btree_remove(netsnmp_container *c,
+                                       const void *key, void **save);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /** NETSNMP_CONTAINER_BTREE_H */
@@ -0,0 +1,58 @@
+/*
+ * container_hash.h
+ * $Id$
+ *
+ */
+#ifndef NETSNMP_CONTAINER_HASH_H
+#define NETSNMP_CONTAINER_HASH_H
+
+
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/factory.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * hash the key of an entry. Entries which compare equal must have the
+     * same hash value.
+     */
+    typedef u_int (netsnmp_container_hash_func)(const void *data);
+
+    /*
+     * initialize hash container. call at startup.
+     */
+    void netsnmp_container_hash_init(void);
+
+    /*
+     * get a container which uses a hash table for storage
+     */
+    netsnmp_container *netsnmp_container_get_hash(void);
+
+    /*
+     * get a factory for producing hash objects
+     */
+    netsnmp_factory   *netsnmp_container_get_hash_factory(void);
+
+    /*
+     * set the hash function for a hash container. Only needed when the
+     * container's compare function is not one of netsnmp_compare_netsnmp_index,
+     * netsnmp_compare_cstring or netsnmp_compare_direct_cstring, for which
+     * the matching function below is picked automatically. Must be called
+     * while the container is empty.
+     */
+    int netsnmp_container_hash_set_func(netsnmp_container *c,
+                                        netsnmp_container_hash_func *f);
+
+    u_int netsnmp_hash_netsnmp_index(const void *data);
+    u_int netsnmp_hash_cstring(const void *data);
+    u_int netsnmp_hash_direct_cstring(const void *data);
+    u_int netsnmp_hash_mem(const void *buf, size_t len, u_int hash);
+
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif /** NETSNMP_CONTAINER_HASH_H */
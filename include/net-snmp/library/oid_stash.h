@@ -6,7 +6,11 @@
  * Storage is done in an efficient tree manner for fast lookups.
  */
 
-#define OID_STASH_CHILDREN_SIZE 31
+/*
+ * initial number of child pointers for nodes created with
+ * netsnmp_oid_stash_create_node(); nodes grow their child arrays as needed.
+ */
+#define OID_STASH_CHILDREN_SIZE 2
 
 #ifdef __cplusplus
 extern          "C" {
@@ -22,14 +26,16 @@ extern          "C" {
     typedef void    (NetSNMPStashFreeNode) (void *);
     
     typedef struct netsnmp_oid_stash_node_s {
-        oid             value;
-        struct netsnmp_oid_stash_node_s **children;     /* array of children */
-        size_t          children_size;
-        struct netsnmp_oid_stash_node_s *next_sibling;  /* cache too small links */
-        struct netsnmp_oid_stash_node_s *prev_sibling;
+        struct netsnmp_oid_stash_node_s **children;     /* sorted by prefix[0] */
+        size_t          children_count;
+        size_t          children_size;                  /* allocated */
         struct netsnmp_oid_stash_node_s *parent; 
 
         void           *thedata;
+
+        /* the sub-identifiers between the parent and this node */
+        size_t          prefix_len;
+        oid             prefix[1];      /* allocated to prefix_len */
     } netsnmp_oid_stash_node;
 
     typedef struct netsnmp_oid_stash_save_info_s {
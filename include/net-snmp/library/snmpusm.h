@@ -190,6 +190,10 @@ extern          "C" {
     NETSNMP_IMPORT
     int             usm_create_user_from_session(netsnmp_session * session);
     NETSNMP_IMPORT
+    int             usm_rediscover_engineid(netsnmp_session *session,
+                                            netsnmp_pdu *reqpdu,
+                                            netsnmp_pdu *report);
+    NETSNMP_IMPORT
     void            usm_parse_create_usmUser(const char *token,
                                              char *line);
     NETSNMP_IMPORT
@@ -235,6 +235,18 @@ extern          "C" {
     struct vacm_securityEntry *vacm_scanSecurityEntry(void);
     NETSNMP_IMPORT
     int             vacm_is_configured(void);
+    /*
+     * Must be called after changing the subtree or mask of an existing
+     * entry in place, so that cached lookups are rebuilt.
+     */
+    NETSNMP_IMPORT
+    void            vacm_mark_changed(void);
+    /*
+     * Returns a counter that changes whenever entries are added, removed
+     * or marked changed.
+     */
+    NETSNMP_IMPORT
+    u_int           vacm_get_generation(void);
 
     void            vacm_save(const char *token, const char *type);
     void            vacm_save_view(struct vacm_viewEntry *view,
@@ -50,6 +50,8 @@
 #include <net-snmp/library/check_varbind.h>
 #include <net-snmp/library/container.h>
 #include <net-snmp/library/container_binary_array.h>
+#include <net-snmp/library/container_btree.h>
+#include <net-snmp/library/container_hash.h>
 #include <net-snmp/library/container_list_ssll.h>
 #include <net-snmp/library/container_iterator.h>
 
@@ -95,6 +95,7 @@ static netsnmp_container *_keys = NULL;
 static netsnmp_container *_maps = NULL;
 static netsnmp_container *_tlstmParams = NULL;
 static netsnmp_container *_tlstmAddr = NULL;
+static netsnmp_container *_secname_cache = NULL;
 static struct snmp_enum_list *_certindexes = NULL;
 
 static netsnmp_container *_trusted_certs = NULL;
@@ -251,6 +252,11 @@ void
 netsnmp_certs_shutdown(void)
 {
     DEBUGMSGT(("cert:util:shutdown","shutdown\n"));
+    if (_secname_cache) {
+        CONTAINER_FREE_ALL(_secname_cache, NULL);
+        CONTAINER_FREE(_secname_cache);
+        _secname_cache = NULL;
+    }
     if (_maps) {
         CONTAINER_FREE_ALL(_maps, NULL);
         CONTAINER_FREE(_maps);
@@ -2755,6 +2761,8 @@ netsnmp_cert_map_add(netsnmp_cert_map *map)
 
     if ((rc = CONTAINER_INSERT(_maps, map)) != 0)
         snmp_log(LOG_ERR, "could not insert new certificate map");
+    else
+        netsnmp_cert_secname_cache_clear();
 
     return rc;
 }
@@ -2773,6 +2781,8 @@ netsnmp_cert_map_remove(netsnmp_cert_map *map)
 
     if ((rc = CONTAINER_REMOVE(_maps, map)) != 0)
         snmp_log(LOG_ERR, "could not remove certificate map");
+    else
+        netsnmp_cert_secname_cache_clear();
 
     return rc;
 }
@@ -2906,6 +2916,8 @@ _purge_config_entries(void)
     netsnmp_container  *cert_maps = netsnmp_cert_map_container();
     netsnmp_container  *tmp_maps = NULL;
 
+    netsnmp_cert_secname_cache_clear();
+
     if ((NULL == cert_maps) || (CONTAINER_SIZE(cert_maps) == 0))
         return;
 
@@ -3200,6 +3212,204 @@ netsnmp_cert_get_secname_maps(netsnmp_container *cert_maps)
     return -1;
 }
 
+/*
+ * cache of securityNames derived from peer certificate chains
+ *
+ * Mapping a chain to a securityName means looking up every fingerprint in
+ * the chain in the certToTSN maps and then extracting the name from the
+ * peer certificate. Peers tend to reconnect with the same chain, so the
+ * result is remembered, keyed by the fingerprints of the whole chain. The
+ * cache is flushed whenever the maps change. It doesn't replace the
+ * certificate verification OpenSSL performs on every handshake.
+ */
+#define SECNAME_CACHE_MAX  256
+
+typedef struct netsnmp_cert_secname_cache_s {
+    char           *chain_fp;   /* fingerprints of the chain, peer first */
+    char           *secname;
+    u_int           last_used;
+} netsnmp_cert_secname_cache;
+
+static u_int              _secname_cache_clock = 0;
+
+static int
+_secname_cache_compare(netsnmp_cert_secname_cache *lhs,
+                       netsnmp_cert_secname_cache *rhs)
+{
+    netsnmp_assert((lhs != NULL) && (rhs != NULL));
+
+    return strcmp(lhs->chain_fp, rhs->chain_fp);
+}
+
+static void
+_secname_cache_free(netsnmp_cert_secname_cache *entry, void *context)
+{
+    if (NULL == entry)
+        return;
+
+    SNMP_FREE(entry->chain_fp);
+    SNMP_FREE(entry->secname);
+    free(entry);
+}
+
+/**
+ * build the secname cache key for a container of netsnmp_cert_map
+ * structures, as returned by netsnmp_openssl_get_cert_chain().
+ *
+ * @return a newly allocated string, which the caller must free, or NULL.
+ */
+char *
+netsnmp_cert_chain_fingerprint(netsnmp_container *chain_maps)
+{
+    netsnmp_iterator   *itr;
+    netsnmp_cert_map   *cert_map;
+    char               *key = NULL;
+    size_t              key_len = 0, fp_len;
+
+    if ((NULL == chain_maps) || (CONTAINER_SIZE(chain_maps) == 0))
+        return NULL;
+
+    itr = CONTAINER_ITERATOR(chain_maps);
+    if (NULL == itr)
+        return NULL;
+
+    for (cert_map = ITERATOR_FIRST(itr); cert_map;
+         cert_map = ITERATOR_NEXT(itr)) {
+        char *tmp;
+
+        if (NULL == cert_map->fingerprint)
+            continue;
+        fp_len = strlen(cert_map->fingerprint);
+        tmp = realloc(key, key_len + fp_len + 2);
+        if (NULL == tmp) {
+            SNMP_FREE(key);
+            break;
+        }
+        key = tmp;
+        if (key_len)
+            key[key_len++] = '/';
+        memcpy(&key[key_len], cert_map->fingerprint, fp_len + 1);
+        key_len += fp_len;
+    }
+    ITERATOR_RELEASE(itr);
+
+    return key;
+}
+
+/**
+ * look up the securityName previously mapped for a certificate chain.
+ *
+ * @return a copy of the securityName, which the caller must free, or NULL.
+ */
+char *
+netsnmp_cert_secname_cache_find(const char *chain_fp)
+{
+    netsnmp_cert_secname_cache  index, *entry;
+
+    if ((NULL == _secname_cache) || (NULL == chain_fp))
+        return NULL;
+
+    index.chain_fp = NETSNMP_REMOVE_CONST(char *, chain_fp);
+    entry = CONTAINER_FIND(_secname_cache, &index);
+    if (NULL == entry) {
+        DEBUGMSGT(("cert:map:secname:cache", "miss for %s\n", chain_fp));
+        return NULL;
+    }
+
+    DEBUGMSGT(("cert:map:secname:cache", "hit for %s: %s\n", chain_fp,
+               entry->secname));
+    entry->last_used = ++_secname_cache_clock;
+    return strdup(entry->secname);
+}
+
+/**
+ * remember the securityName mapped for a certificate chain. When the
+ * cache is full, the least recently used entry is dropped.
+ */
+void
+netsnmp_cert_secname_cache_add(const char *chain_fp, const char *secname)
+{
+    netsnmp_cert_secname_cache  index, *entry, *oldest;
+    netsnmp_iterator           *itr;
+
+    if ((NULL == chain_fp) || (NULL == secname))
+        return;
+
+    if (NULL == _secname_cache) {
+        _secname_cache =
+            netsnmp_container_find("cert_secname_cache:binary_array");
+        if (NULL == _secname_cache) {
+            snmp_log(LOG_ERR, "could not create secname cache container\n");
+            return;
+        }
+        _secname_cache->container_name = strdup("cert_secname_cache");
+        _secname_cache->compare =
+            (netsnmp_container_compare*)_secname_cache_compare;
+        _secname_cache->free_item =
+            (netsnmp_container_obj_func*)_secname_cache_free;
+    }
+
+    index.chain_fp = NETSNMP_REMOVE_CONST(char *, chain_fp);
+    entry = CONTAINER_FIND(_secname_cache, &index);
+    if (NULL != entry) {
+        if (strcmp(entry->secname, secname) != 0) {
+            char *tmp = strdup(secname);
+            if (NULL == tmp)
+                return;
+            free(entry->secname);
+            entry->secname = tmp;
+        }
+        entry->last_used = ++_secname_cache_clock;
+        return;
+    }
+
+    if (CONTAINER_SIZE(_secname_cache) >= SECNAME_CACHE_MAX) {
+        itr = CONTAINER_ITERATOR(_secname_cache);
+        if (NULL == itr)
+            return;
+        oldest = entry = ITERATOR_FIRST(itr);
+        for ( ; entry; entry = ITERATOR_NEXT(itr))
+            if (entry->last_used < oldest->last_used)
+                oldest = entry;
+        ITERATOR_RELEASE(itr);
+        if (NULL != oldest) {
+            DEBUGMSGT(("cert:map:secname:cache", "evicting %s\n",
+                       oldest->chain_fp));
+            CONTAINER_REMOVE(_secname_cache, oldest);
+            _secname_cache_free(oldest, NULL);
+        }
+    }
+
+    entry = SNMP_MALLOC_TYPEDEF(netsnmp_cert_secname_cache);
+    if (NULL == entry)
+        return;
+    entry->chain_fp = strdup(chain_fp);
+    entry->secname = strdup(secname);
+    entry->last_used = ++_secname_cache_clock;
+    if ((NULL == entry->chain_fp) || (NULL == entry->secname) ||
+        (CONTAINER_INSERT(_secname_cache, entry) != 0)) {
+        _secname_cache_free(entry, NULL);
+        return;
+    }
+    DEBUGMSGT(("cert:map:secname:cache", "added %s: %s\n", chain_fp,
+               secname));
+}
+
+/**
+ * forget all cached securityNames; must be called whenever the certToTSN
+ * maps change.
+ */
+void
+netsnmp_cert_secname_cache_clear(void)
+{
+    if ((NULL == _secname_cache) || (CONTAINER_SIZE(_secname_cache) == 0))
+        return;
+
+    DEBUGMSGT(("cert:map:secname:cache", "flushing %" NETSNMP_PRIz
+               "u entries\n", CONTAINER_SIZE(_secname_cache)));
+    CONTAINER_FREE_ALL(_secname_cache, NULL);
+}
+
 /* ***************************************************************************
  * ***************************************************************************
  *
@@ -18,6 +18,8 @@
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/library/container.h>
 #include <net-snmp/library/container_binary_array.h>
+#include <net-snmp/library/container_btree.h>
+#include <net-snmp/library/container_hash.h>
 #include <net-snmp/library/container_list_ssll.h>
 #include <net-snmp/library/container_null.h>
 
@@ -94,6 +96,8 @@ netsnmp_container_init_list(void)
      * register containers
      */
     netsnmp_container_binary_array_init();
+    netsnmp_container_btree_init();
+    netsnmp_container_hash_init();
 #ifndef NETSNMP_FEATURE_REMOVE_CONTAINER_LINKED_LIST
     netsnmp_container_ssll_init();
 #endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_LINKED_LIST */
@@ -511,6 +515,60 @@ void CONTAINER_FREE_ALL(netsnmp_container *x, void *c)
 }
 #endif /* NETSNMP_FEATURE_REMOVE_CONTAINER_FREE_ALL */
 
+/*
+ * start loading many entries into all containers at once.
+ */
+void CONTAINER_LOAD_BEGIN(netsnmp_container *x)
+{
+    /** start at first container */
+    while(x->prev)
+        x = x->prev;
+    for(; x; x = x->next)
+        if (x->load_begin)
+            x->load_begin(x);
+}
+
+typedef struct container_load_drop_s {
+    netsnmp_container          *first, *from;
+    netsnmp_container_obj_func *f;
+    void                       *context;
+} container_load_drop;
+
+static void
+_container_load_drop(void *data, void *context)
+{
+    container_load_drop *info = (container_load_drop *)context;
+    netsnmp_container   *x;
+
+    /** remove it from the other containers (ignoring errors) */
+    for(x = info->first; x; x = x->next)
+        if (x != info->from)
+            x->remove(x, data);
+    if (info->f)
+        info->f(data, info->context);
+}
+
+/*
+ * finish loading; sort each container and drop duplicate entries.
+ */
+void CONTAINER_LOAD_END(netsnmp_container *x, netsnmp_container_obj_func *f,
+                        void *c)
+{
+    container_load_drop info;
+
+    /** start at first container */
+    while(x->prev)
+        x = x->prev;
+    info.first = x;
+    info.f = f;
+    info.context = c;
+    for(; x; x = x->next)
+        if (x->load_end) {
+            info.from = x;
+            x->load_end(x, _container_load_drop, &info);
+        }
+}
+
 #ifndef NETSNMP_FEATURE_REMOVE_SUBCONTAINER_FIND
 /*
  * Find a sub-container with the given name
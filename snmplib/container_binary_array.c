@@ -37,6 +37,7 @@
 #include <net-snmp/library/snmp_api.h>
 #include <net-snmp/library/container.h>
 #include <net-snmp/library/container_binary_array.h>
+#include <net-snmp/library/container_btree.h>
 #include <net-snmp/library/tools.h>
 #include <net-snmp/library/snmp_assert.h>
 
@@ -44,9 +45,14 @@ typedef struct binary_array_table_s {
     size_t                     max_size;   /* Size of the current data table */
     size_t                     count;      /* Index of the next free entry */
     int                        dirty;
+    int                        growable;   /* may switch to a btree */
+    int                        loading;    /* between load_begin/end */
     void                     **data;       /* The table itself */
 } binary_array_table;
 
+/* default for the tableContainerBtreeThreshold setting */
+#define BA_BTREE_THRESHOLD 10000
+
 typedef struct binary_array_iterator_s {
     netsnmp_iterator base;
 
@@ -54,12 +60,57 @@ typedef struct binary_array_iterator_s {
 } binary_array_iterator;
 
 static netsnmp_iterator *_ba_iterator_get(netsnmp_container *c);
+static int _ba_options(netsnmp_container *c, int set, u_int flags);
 
 /**********************************************************************
  *
  * 
  *
  */
+/*
+ * stable merge sort, so that entries with the same key stay in the order
+ * they were inserted in while loading (see _ba_load_end). Runs that are
+ * already in order are just copied, which makes sorted input cheap.
+ */
+static int
+_ba_merge_sort(netsnmp_container *c)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+    void              **tmp, **src, **dst, **swap;
+    size_t              width, lo, mid, hi, i, j, k;
+
+    tmp = (void**) malloc(t->count * sizeof(void*));
+    if (NULL == tmp)
+        return -1;
+
+    src = t->data;
+    dst = tmp;
+    for (width = 1; width < t->count; width *= 2) {
+        for (lo = 0; lo < t->count; lo += 2 * width) {
+            mid = SNMP_MIN(lo + width, t->count);
+            hi = SNMP_MIN(lo + 2 * width, t->count);
+            if (mid == hi || c->compare(src[mid - 1], src[mid]) <= 0) {
+                memcpy(&dst[lo], &src[lo], (hi - lo) * sizeof(void*));
+                continue;
+            }
+            for (i = lo, j = mid, k = lo; i < mid && j < hi; )
+                dst[k++] = c->compare(src[j], src[i]) < 0 ? src[j++] : src[i++];
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != t->data)
+        memcpy(t->data, src, t->count * sizeof(void*));
+    free(tmp);
+
+    return 0;
+}
+
 static int
 Sort_Array(netsnmp_container *c)
 {
@@ -74,7 +125,8 @@ Sort_Array(netsnmp_container *c)
         /*
          * Sort the table 
          */
-        qsort(t->data, t->count, sizeof(t->data[0]), c->compare);
+        if (!t->loading || t->count < 2 || _ba_merge_sort(c) != 0)
+            qsort(t->data, t->count, sizeof(t->data[0]), c->compare);
         t->dirty = 0;
 
         /*
@@ -203,10 +255,24 @@ netsnmp_binary_array_initialize(void)
     return t;
 }
 
+/*
+ * a growable array hands its entries over to a btree once it is large
+ * (see _ba_grow_check); the exported functions below must then use the
+ * btree's methods instead of looking at container_data.
+ */
+#define BA_SWITCHED(c) ((c)->options != _ba_options)
+
 void
 netsnmp_binary_array_release(netsnmp_container *c)
 {
-    binary_array_table *t = (binary_array_table*)c->container_data;
+    binary_array_table *t;
+
+    if (BA_SWITCHED(c)) {
+        c->cfree(c);
+        return;
+    }
+
+    t = (binary_array_table*)c->container_data;
     SNMP_FREE(t->data);
     SNMP_FREE(t);
     SNMP_FREE(c);
@@ -217,6 +283,9 @@ netsnmp_binary_array_options_set(netsnmp_container *c, int set, u_int flags)
 {
 #define BA_FLAGS (CONTAINER_KEY_ALLOW_DUPLICATES|CONTAINER_KEY_UNSORTED)
 
+    if (BA_SWITCHED(c))
+        return c->options(c, set, flags);
+
     if (set) {
         if ((flags & BA_FLAGS) == flags) {
             /** if turning off unsorted, do sort */
@@ -354,6 +423,9 @@ netsnmp_binary_array_remove(netsnmp_container *c, const void *key, void **save)
 
     if (save)
         *save = NULL;
+
+    if (BA_SWITCHED(c))
+        return netsnmp_container_btree_remove(c, key, save);
     
     /*
      * if there is no data, return NULL;
@@ -373,6 +445,25 @@ netsnmp_binary_array_remove(netsnmp_container *c, const void *key, void **save)
     if ((index = binary_search(key, c, 1, NULL)) == -1)
         return -1;
 
+    /*
+     * among duplicates, prefer the entry that was passed in
+     */
+    if (t->data[index] != key &&
+        ((c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) || t->loading)) {
+        int i;
+
+        for (i = index - 1; i >= 0 && c->compare(t->data[i], key) == 0; --i)
+            if (t->data[i] == key)
+                break;
+        if (i < 0 || t->data[i] != key)
+            for (i = index + 1; i < t->count &&
+                     c->compare(t->data[i], key) == 0; ++i)
+                if (t->data[i] == key)
+                    break;
+        if (i >= 0 && i < t->count && t->data[i] == key)
+            index = i;
+    }
+
     return netsnmp_binary_array_remove_at(c, (size_t)index, save);
 }
 
@@ -438,6 +529,37 @@ _ba_resize_check(binary_array_table *t)
     return 1; /* resized */
 }
 
+/*
+ * switch a growable array that has become large over to a btree, which
+ * doesn't move the whole tail of the table around on every insert.
+ */
+static void
+_ba_grow_check(netsnmp_container *c)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+    int                 threshold;
+
+    threshold = netsnmp_ds_get_int(NETSNMP_DS_LIBRARY_ID,
+                                   NETSNMP_DS_LIB_TABLE_BTREE_THRESHOLD);
+    if (0 == threshold)
+        threshold = BA_BTREE_THRESHOLD;
+    if (threshold < 0 || t->count < (size_t)threshold ||
+        (c->flags & CONTAINER_KEY_UNSORTED))
+        return;
+
+    if (t->dirty)
+        Sort_Array(c);
+    if (netsnmp_container_btree_adopt(c, t->data, t->count) != 0) {
+        t->growable = 0;
+        return;
+    }
+    DEBUGMSGTL(("container", "%s switched to a btree at %" NETSNMP_PRIz
+                "u entries\n", c->container_name ? c->container_name : "",
+                t->count));
+    SNMP_FREE(t->data);
+    free(t);
+}
+
 static int
 netsnmp_binary_array_insert_before(netsnmp_container *c, size_t index,
                                    const void *entry, int dirty)
@@ -488,6 +610,12 @@ netsnmp_binary_array_insert(netsnmp_container *c, const void *const_entry)
     if (NULL == entry)
         return -1;
 
+    /*
+     * while loading, sort and look for duplicates once at the end
+     */
+    if (t->loading)
+        return netsnmp_binary_array_insert_before(c, t->count, entry, 1);
+
     /*
      * check key if we have at least 1 item and duplicates aren't allowed
      */
@@ -521,7 +649,63 @@ netsnmp_binary_array_insert(netsnmp_container *c, const void *const_entry)
                 ++pos;
     }
 
-    return netsnmp_binary_array_insert_before(c, pos, entry, dirty);
+    if (netsnmp_binary_array_insert_before(c, pos, entry, dirty) != 0)
+        return -1;
+
+    if (t->growable)
+        _ba_grow_check(c);
+
+    return 0;
+}
+
+static int
+_ba_load_begin(netsnmp_container *c)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+
+    if (c->flags & CONTAINER_KEY_UNSORTED)
+        return -1;
+    t->loading = 1;
+
+    return 0;
+}
+
+static void
+_ba_load_end(netsnmp_container *c, netsnmp_container_obj_func *f,
+             void *context)
+{
+    binary_array_table *t = (binary_array_table*)c->container_data;
+    size_t              i, kept;
+
+    if (!t->loading)
+        return;
+
+    if (t->dirty)
+        Sort_Array(c);
+    t->loading = 0;
+
+    /*
+     * keep the first of any entries with the same key
+     */
+    if (!(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) && t->count > 1) {
+        for (i = kept = 1; i < t->count; ++i) {
+            if (c->compare(t->data[kept - 1], t->data[i]) == 0) {
+                DEBUGMSGTL(("container","dropping duplicate key in %s\n",
+                            c->container_name ? c->container_name : ""));
+                if (f)
+                    (*f) (t->data[i], context);
+                continue;
+            }
+            t->data[kept++] = t->data[i];
+        }
+        if (kept != t->count) {
+            t->count = kept;
+            ++c->sync;
+        }
+    }
+
+    if (t->growable)
+        _ba_grow_check(c);
 }
 
 /**********************************************************************
@@ -576,6 +760,17 @@ netsnmp_binary_array_get_subset(netsnmp_container *c, void *key, int *len)
     if (!c || !key || !len)
         return NULL;
 
+    if (BA_SWITCHED(c)) {
+        netsnmp_void_array *va = c->get_subset(c, key);
+
+        if (NULL == va)
+            return NULL;
+        subset = va->array;
+        *len = va->size;
+        free(va);
+        return subset;
+    }
+
     t = (binary_array_table*)c->container_data;
     netsnmp_assert(c->ncompare);
     if (!t->count || !c->ncompare)
@@ -735,6 +930,7 @@ _ba_duplicate(netsnmp_container *c, void *ctx, u_int flags)
     dupt->max_size = t->max_size;
     dupt->count = t->count;
     dupt->dirty = t->dirty;
+    dupt->growable = t->growable;
 
     /*
      * shallow copy
@@ -780,6 +976,8 @@ netsnmp_container_get_binary_array(void)
     c->get_at = netsnmp_binary_array_get_at;
     c->remove_at = netsnmp_binary_array_remove_at;
     c->insert_before = _ba_insert_before;
+    c->load_begin = _ba_load_begin;
+    c->load_end = _ba_load_end;
 
     return c;
 }
@@ -794,11 +992,33 @@ netsnmp_container_get_binary_array_factory(void)
     return &f;
 }
 
+static netsnmp_container *
+_ba_get_growable(void)
+{
+    netsnmp_container *c = netsnmp_container_get_binary_array();
+
+    if (c && c->container_data)
+        ((binary_array_table*)c->container_data)->growable = 1;
+    return c;
+}
+
+netsnmp_factory *
+netsnmp_container_get_binary_array_growable_factory(void)
+{
+    static netsnmp_factory f = { "binary_array",
+                                 (netsnmp_factory_produce_f*)
+                                 _ba_get_growable };
+
+    return &f;
+}
+
 void
 netsnmp_container_binary_array_init(void)
 {
     netsnmp_container_register("binary_array",
                                netsnmp_container_get_binary_array_factory());
+    netsnmp_container_register("large_table",
+                               netsnmp_container_get_binary_array_growable_factory());
 }
 
 /**********************************************************************
@@ -821,6 +1041,10 @@ _ba_it2cont(binary_array_iterator *it)
         netsnmp_assert(NULL != it->base.container->container_data);
         return NULL;
     }
+    if(it->base.container->get_iterator != _ba_iterator_get) {
+        DEBUGMSGTL(("container:iterator", "container no longer an array\n"));
+        return NULL;
+    }
 
     return (binary_array_table*)(it->base.container->container_data);
 }
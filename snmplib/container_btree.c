@@ -0,0 +1,1123 @@
+/*
+ * container_btree.c
+ * $Id$
+ *
+ * see comments in header file.
+ *
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-features.h>
+
+#ifdef HAVE_IO_H
+#include <io.h>
+#endif
+#include <stdio.h>
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#include <sys/types.h>
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/types.h>
+#include <net-snmp/library/snmp_api.h>
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/container_btree.h>
+#include <net-snmp/library/tools.h>
+#include <net-snmp/library/snmp_assert.h>
+
+/** @defgroup btree_container btree_container
+ *  A sorted container for large tables.
+ *  @ingroup container
+ *
+ *  The entries are kept in the leaves of a B+tree, in nodes of up to
+ *  BT_MAX pointers, and the leaves are linked in order for find_next and
+ *  iterators.  Inserts and removes only move the entries of one node
+ *  around, instead of the whole tail of the table as the binary_array
+ *  container does, and no single allocation grows with the table.
+ *
+ *  Each key in an inner node is the first entry of the subtree to its
+ *  right, so the keys are always entries that are still in the
+ *  container.  Duplicate keys are supported (CONTAINER_KEY_ALLOW_DUPLICATES),
+ *  unsorted mode and the positional get_at/insert_before/remove_at calls
+ *  are not.
+ *
+ *  @{
+ */
+
+#define BT_MAX     64                  /* entries or keys per node */
+#define BT_MIN     (BT_MAX / 2)
+#define BT_DEPTH   16                  /* enough for BT_MIN^BT_DEPTH entries */
+
+typedef struct bt_node_s {
+    u_short         leaf;
+    u_short         count;              /* entries, or keys if inner */
+    void           *key[BT_MAX + 1];    /* one spare for splits */
+} bt_node;
+
+typedef struct bt_leaf_s {
+    bt_node         n;
+    struct bt_leaf_s *prev, *next;
+} bt_leaf;
+
+typedef struct bt_inner_s {
+    bt_node         n;
+    bt_node        *child[BT_MAX + 2];
+} bt_inner;
+
+typedef struct btree_s {
+    bt_node        *root;
+    bt_leaf        *first, *last;
+    size_t          count;
+} btree;
+
+/* the inner nodes passed on the way down to a leaf */
+typedef struct bt_path_s {
+    int             depth;
+    bt_inner       *node[BT_DEPTH];
+    int             pos[BT_DEPTH];
+} bt_path;
+
+typedef struct btree_iterator_s {
+    netsnmp_iterator base;
+
+    bt_leaf        *leaf;
+    int             pos;
+    void           *next;     /* entry to continue at after a remove */
+} btree_iterator;
+
+static netsnmp_iterator *_bt_iterator_get(netsnmp_container *c);
+
+/**********************************************************************
+ *
+ * tree
+ *
+ */
+static bt_leaf *
+_bt_new_leaf(void)
+{
+    bt_leaf        *l = SNMP_MALLOC_TYPEDEF(bt_leaf);
+
+    if (l)
+        l->n.leaf = 1;
+    return l;
+}
+
+static void
+_bt_free_node(bt_node *n)
+{
+    int             i;
+
+    if (!n->leaf)
+        for (i = 0; i <= n->count; ++i)
+            _bt_free_node(((bt_inner *)n)->child[i]);
+    free(n);
+}
+
+static btree *
+_bt_initialize(void)
+{
+    btree          *t = SNMP_MALLOC_TYPEDEF(btree);
+
+    if (NULL == t)
+        return NULL;
+    t->first = t->last = _bt_new_leaf();
+    if (NULL == t->first) {
+        free(t);
+        return NULL;
+    }
+    t->root = &t->first->n;
+    return t;
+}
+
+/*
+ * number of keys of n that sort before key, or if upper is set, that
+ * don't sort after it.
+ */
+static int
+_bt_bound(netsnmp_container_compare *cmp, const bt_node *n, const void *key,
+          int upper)
+{
+    int             lo = 0, hi = n->count, mid, rc;
+
+    while (lo < hi) {
+        mid = (lo + hi) >> 1;
+        rc = cmp(n->key[mid], key);
+        if (rc < 0 || (upper && rc == 0))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * find the leaf for key. With upper set this is the leaf holding the
+ * last entry not after key, which is also the leaf holding an entry equal
+ * to key if there is one; otherwise it is the leaf holding the last entry
+ * before key.
+ */
+static bt_leaf *
+_bt_descend(btree *t, netsnmp_container_compare *cmp, const void *key,
+            int upper, bt_path *path)
+{
+    bt_node        *n = t->root;
+    int             i;
+
+    if (path)
+        path->depth = 0;
+    while (!n->leaf) {
+        i = _bt_bound(cmp, n, key, upper);
+        if (path) {
+            netsnmp_assert(path->depth < BT_DEPTH);
+            path->node[path->depth] = (bt_inner *)n;
+            path->pos[path->depth++] = i;
+        }
+        n = ((bt_inner *)n)->child[i];
+    }
+    return (bt_leaf *)n;
+}
+
+static void *
+_bt_get(netsnmp_container *c, const void *key, int exact)
+{
+    btree          *t = (btree *)c->container_data;
+    bt_leaf        *l;
+    int             pos;
+
+    if (!t->count)
+        return NULL;
+    if (!key)
+        return t->first->n.key[0];
+
+    l = _bt_descend(t, c->compare, key, 1, NULL);
+    if (exact) {
+        pos = _bt_bound(c->compare, &l->n, key, 0);
+        if (pos < l->n.count && c->compare(l->n.key[pos], key) == 0)
+            return l->n.key[pos];
+        return NULL;
+    }
+
+    /* skips any duplicates of key as well */
+    pos = _bt_bound(c->compare, &l->n, key, 1);
+    if (pos == l->n.count) {
+        if (NULL == (l = l->next))
+            return NULL;
+        pos = 0;
+    }
+    return l->n.key[pos];
+}
+
+/* find the leaf and position of this very entry */
+static int
+_bt_locate(netsnmp_container *c, const void *entry, bt_leaf **leaf, int *pos)
+{
+    btree          *t = (btree *)c->container_data;
+    bt_leaf        *l;
+    int             i;
+
+    l = _bt_descend(t, c->compare, entry, 0, NULL);
+    for (i = _bt_bound(c->compare, &l->n, entry, 0); l; l = l->next, i = 0)
+        for (; i < l->n.count; ++i) {
+            if (l->n.key[i] == entry) {
+                *leaf = l;
+                *pos = i;
+                return 0;
+            }
+            if (c->compare(l->n.key[i], entry) != 0)
+                return -1;
+        }
+    return -1;
+}
+
+/* move path on to the next leaf */
+static bt_leaf *
+_bt_path_next(bt_path *path)
+{
+    bt_node        *n;
+    int             d;
+
+    for (d = path->depth - 1; d >= 0; --d)
+        if (path->pos[d] < path->node[d]->n.count)
+            break;
+    if (d < 0)
+        return NULL;
+
+    n = path->node[d]->child[++path->pos[d]];
+    path->depth = d + 1;
+    while (!n->leaf) {
+        path->node[path->depth] = (bt_inner *)n;
+        path->pos[path->depth++] = 0;
+        n = ((bt_inner *)n)->child[0];
+    }
+    return (bt_leaf *)n;
+}
+
+static void
+_bt_node_insert(bt_node *n, int pos, void *key, bt_node *right)
+{
+    memmove(&n->key[pos + 1], &n->key[pos],
+            (n->count - pos) * sizeof(n->key[0]));
+    n->key[pos] = key;
+    if (!n->leaf) {
+        bt_inner       *in = (bt_inner *)n;
+
+        memmove(&in->child[pos + 2], &in->child[pos + 1],
+                (n->count - pos) * sizeof(in->child[0]));
+        in->child[pos + 1] = right;
+    }
+    ++n->count;
+}
+
+static void
+_bt_node_delete(bt_node *n, int pos)
+{
+    --n->count;
+    memmove(&n->key[pos], &n->key[pos + 1],
+            (n->count - pos) * sizeof(n->key[0]));
+    if (!n->leaf) {
+        bt_inner       *in = (bt_inner *)n;
+
+        memmove(&in->child[pos + 1], &in->child[pos + 2],
+                (n->count - pos) * sizeof(in->child[0]));
+    }
+}
+
+/*
+ * split the overfull leaf at the end of path, and any ancestors that
+ * overflow in turn, using the nodes the caller allocated up front.
+ */
+static void
+_bt_split(btree *t, bt_path *path, bt_leaf *l, bt_leaf *nl,
+          bt_inner **spare)
+{
+    bt_node        *n = &l->n, *right;
+    bt_inner       *p, *r;
+    void           *sep;
+    int             d = path->depth, half;
+
+    half = n->count / 2;
+    nl->n.count = n->count - half;
+    memcpy(nl->n.key, &n->key[half], nl->n.count * sizeof(n->key[0]));
+    n->count = half;
+    nl->prev = l;
+    nl->next = l->next;
+    if (l->next)
+        l->next->prev = nl;
+    else
+        t->last = nl;
+    l->next = nl;
+    right = &nl->n;
+    sep = nl->n.key[0];
+
+    for (;;) {
+        if (--d < 0) {
+            /* grow a new root */
+            r = *spare++;
+            r->n.count = 1;
+            r->n.key[0] = sep;
+            r->child[0] = t->root;
+            r->child[1] = right;
+            t->root = &r->n;
+            return;
+        }
+        p = path->node[d];
+        _bt_node_insert(&p->n, path->pos[d], sep, right);
+        if (p->n.count <= BT_MAX)
+            return;
+
+        /* the middle key moves up, the keys right of it to the new node */
+        r = *spare++;
+        half = p->n.count / 2;
+        sep = p->n.key[half];
+        r->n.count = p->n.count - half - 1;
+        memcpy(r->n.key, &p->n.key[half + 1],
+               r->n.count * sizeof(p->n.key[0]));
+        memcpy(r->child, &p->child[half + 1],
+               (r->n.count + 1) * sizeof(p->child[0]));
+        p->n.count = half;
+        right = &r->n;
+    }
+}
+
+static int
+_bt_insert(netsnmp_container *c, const void *data)
+{
+    btree          *t = (btree *)c->container_data;
+    void           *entry = NETSNMP_REMOVE_CONST(void *, data);
+    bt_inner       *spare[BT_DEPTH + 1];
+    bt_leaf        *l, *nl = NULL;
+    bt_path         path;
+    int             pos, d, need = 0, i;
+
+    if (NULL == entry)
+        return -1;
+
+    if (!(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) && t->count &&
+        _bt_get(c, entry, 1)) {
+        DEBUGMSGTL(("container","not inserting duplicate key\n"));
+        return -1;
+    }
+
+    /* after any duplicates, like the binary_array container */
+    l = _bt_descend(t, c->compare, entry, 1, &path);
+    pos = _bt_bound(c->compare, &l->n, entry, 1);
+
+    /*
+     * get the nodes a split would need before changing anything
+     */
+    if (l->n.count == BT_MAX) {
+        for (d = path.depth - 1; d >= 0 && path.node[d]->n.count == BT_MAX;
+             --d)
+            ++need;
+        if (d < 0)
+            ++need;
+        nl = _bt_new_leaf();
+        for (i = 0; nl && i < need; ++i)
+            if (NULL == (spare[i] = SNMP_MALLOC_TYPEDEF(bt_inner)))
+                break;
+        if (NULL == nl || i < need) {
+            snmp_log(LOG_ERR, "malloc failed in btree insert\n");
+            while (nl && i-- > 0)
+                free(spare[i]);
+            free(nl);
+            return -1;
+        }
+    }
+
+    _bt_node_insert(&l->n, pos, entry, NULL);
+    if (nl)
+        _bt_split(t, &path, l, nl, spare);
+    ++t->count;
+    ++c->sync;
+
+    return 0;
+}
+
+/* the first entry of the leaf at the end of path has changed */
+static void
+_bt_fix_min(bt_path *path, void *min)
+{
+    int             d;
+
+    for (d = path->depth - 1; d >= 0; --d)
+        if (path->pos[d] > 0) {
+            path->node[d]->n.key[path->pos[d] - 1] = min;
+            return;
+        }
+}
+
+/* move the last entry of child ci-1 of p to child ci */
+static void
+_bt_borrow_left(bt_inner *p, int ci)
+{
+    bt_node        *n = p->child[ci], *left = p->child[ci - 1];
+
+    if (n->leaf) {
+        _bt_node_insert(n, 0, left->key[--left->count], NULL);
+        p->n.key[ci - 1] = n->key[0];
+    } else {
+        bt_inner       *in = (bt_inner *)n, *lin = (bt_inner *)left;
+
+        memmove(&n->key[1], &n->key[0], n->count * sizeof(n->key[0]));
+        memmove(&in->child[1], &in->child[0],
+                (n->count + 1) * sizeof(in->child[0]));
+        n->key[0] = p->n.key[ci - 1];
+        in->child[0] = lin->child[left->count];
+        ++n->count;
+        p->n.key[ci - 1] = left->key[--left->count];
+    }
+}
+
+/* move the first entry of child ci+1 of p to child ci */
+static void
+_bt_borrow_right(bt_inner *p, int ci)
+{
+    bt_node        *n = p->child[ci], *right = p->child[ci + 1];
+
+    if (n->leaf) {
+        n->key[n->count++] = right->key[0];
+        _bt_node_delete(right, 0);
+        p->n.key[ci] = right->key[0];
+    } else {
+        bt_inner       *in = (bt_inner *)n, *rin = (bt_inner *)right;
+
+        n->key[n->count] = p->n.key[ci];
+        in->child[n->count + 1] = rin->child[0];
+        ++n->count;
+        p->n.key[ci] = right->key[0];
+        --right->count;
+        memmove(&right->key[0], &right->key[1],
+                right->count * sizeof(right->key[0]));
+        memmove(&rin->child[0], &rin->child[1],
+                (right->count + 1) * sizeof(rin->child[0]));
+    }
+}
+
+/* merge child i+1 of p into child i */
+static void
+_bt_merge(btree *t, bt_inner *p, int i)
+{
+    bt_node        *n = p->child[i], *right = p->child[i + 1];
+
+    if (n->leaf) {
+        bt_leaf        *l = (bt_leaf *)n, *rl = (bt_leaf *)right;
+
+        memcpy(&n->key[n->count], right->key,
+               right->count * sizeof(n->key[0]));
+        n->count += right->count;
+        l->next = rl->next;
+        if (rl->next)
+            rl->next->prev = l;
+        else
+            t->last = l;
+    } else {
+        bt_inner       *in = (bt_inner *)n, *rin = (bt_inner *)right;
+
+        n->key[n->count] = p->n.key[i];
+        memcpy(&n->key[n->count + 1], right->key,
+               right->count * sizeof(n->key[0]));
+        memcpy(&in->child[n->count + 1], rin->child,
+               (right->count + 1) * sizeof(in->child[0]));
+        n->count += right->count + 1;
+    }
+    free(right);
+    _bt_node_delete(&p->n, i);
+}
+
+static void
+_bt_remove_at(netsnmp_container *c, bt_path *path, bt_leaf *l, int pos)
+{
+    btree          *t = (btree *)c->container_data;
+    bt_node        *n = &l->n, *old;
+    bt_inner       *p;
+    int             d, ci;
+
+    _bt_node_delete(n, pos);
+    --t->count;
+    ++c->sync;
+    if (pos == 0 && n->count)
+        _bt_fix_min(path, n->key[0]);
+
+    for (d = path->depth - 1; d >= 0 && n->count < BT_MIN; --d) {
+        p = path->node[d];
+        ci = path->pos[d];
+        if (ci > 0 && p->child[ci - 1]->count > BT_MIN) {
+            _bt_borrow_left(p, ci);
+            break;
+        }
+        if (ci < p->n.count && p->child[ci + 1]->count > BT_MIN) {
+            _bt_borrow_right(p, ci);
+            break;
+        }
+        _bt_merge(t, p, ci > 0 ? ci - 1 : ci);
+        n = &p->n;
+    }
+
+    if (!t->root->leaf && 0 == t->root->count) {
+        old = t->root;
+        t->root = ((bt_inner *)old)->child[0];
+        free(old);
+    }
+}
+
+/*
+ * remove the first entry equal to key, or if entry is set, that very
+ * entry among any duplicates.  The removed entry is returned in save.
+ */
+static int
+_bt_remove_entry(netsnmp_container *c, const void *key, const void *entry,
+                 void **save)
+{
+    btree          *t = (btree *)c->container_data;
+    bt_leaf        *l;
+    bt_path         path;
+    int             pos;
+
+    if (!t->count)
+        return 0;
+
+    l = _bt_descend(t, c->compare, key, 0, &path);
+    for (pos = _bt_bound(c->compare, &l->n, key, 0); l;
+         l = _bt_path_next(&path), pos = 0)
+        for (; pos < l->n.count; ++pos) {
+            if (c->compare(l->n.key[pos], key) != 0)
+                return -1;
+            if (NULL == entry || l->n.key[pos] == entry) {
+                if (save)
+                    *save = l->n.key[pos];
+                _bt_remove_at(c, &path, l, pos);
+                return 0;
+            }
+        }
+    return -1;
+}
+
+static void
+_bt_clear_nodes(btree *t)
+{
+    if (!t->root->leaf) {
+        _bt_free_node(t->root);
+        t->first = t->last = _bt_new_leaf();
+        if (NULL == t->first)
+            snmp_log(LOG_ERR, "malloc failed in btree clear\n");
+        t->root = &t->first->n;
+    }
+    t->root->count = 0;
+    t->count = 0;
+}
+
+/*
+ * build the tree from count entries sorted in data, into an empty tree.
+ * Leaves are filled up, and the entries spread evenly over them.
+ */
+static int
+_bt_load(btree *t, void **data, size_t count)
+{
+    bt_node       **level = NULL, **up = NULL;
+    void          **min = NULL;
+    bt_leaf        *l, *prev = NULL;
+    bt_inner       *in;
+    size_t          nodes, nup, i, j, k, take;
+
+    netsnmp_assert(0 == t->count && t->root->leaf);
+    if (count <= BT_MAX) {
+        memcpy(t->root->key, data, count * sizeof(data[0]));
+        t->root->count = count;
+        t->count = count;
+        return 0;
+    }
+
+    nodes = (count + BT_MAX - 1) / BT_MAX;
+    level = (bt_node **)calloc(nodes, sizeof(bt_node *));
+    up = (bt_node **)calloc(nodes, sizeof(bt_node *));
+    min = (void **)calloc(nodes, sizeof(void *));
+    if (!level || !up || !min)
+        goto err;
+
+    for (i = 0, k = 0; i < nodes; ++i) {
+        if (NULL == (l = _bt_new_leaf()))
+            goto err;
+        take = count / nodes + (i < count % nodes);
+        memcpy(l->n.key, &data[k], take * sizeof(data[0]));
+        l->n.count = take;
+        k += take;
+        l->prev = prev;
+        if (prev)
+            prev->next = l;
+        prev = l;
+        level[i] = &l->n;
+        min[i] = l->n.key[0];
+    }
+
+    while (nodes > 1) {
+        nup = (nodes + BT_MAX) / (BT_MAX + 1);
+        for (i = 0, k = 0; i < nup; ++i) {
+            if (NULL == (in = SNMP_MALLOC_TYPEDEF(bt_inner))) {
+                /* free what isn't owned by a new node yet */
+                for (j = k; j < nodes; ++j)
+                    _bt_free_node(level[j]);
+                for (j = 0; j < i; ++j)
+                    _bt_free_node(up[j]);
+                nodes = 0;
+                goto err;
+            }
+            take = nodes / nup + (i < nodes % nup);
+            for (j = 0; j < take; ++j) {
+                in->child[j] = level[k + j];
+                if (j)
+                    in->n.key[j - 1] = min[k + j];
+            }
+            in->n.count = take - 1;
+            up[i] = &in->n;
+            min[i] = min[k];
+            k += take;
+        }
+        memcpy(level, up, nup * sizeof(level[0]));
+        nodes = nup;
+    }
+
+    free(t->root);
+    t->root = level[0];
+    t->first = (bt_leaf *)t->root;
+    while (!t->first->n.leaf)
+        t->first = (bt_leaf *)((bt_inner *)t->first)->child[0];
+    t->last = prev;
+    t->count = count;
+    free(level);
+    free(up);
+    free(min);
+    return 0;
+
+  err:
+    snmp_log(LOG_ERR, "malloc failed in btree load\n");
+    if (level && level[0] && level[0]->leaf)
+        for (i = 0; i < nodes; ++i)
+            free(level[i]);
+    free(level);
+    free(up);
+    free(min);
+    return -1;
+}
+
+/**********************************************************************
+ *
+ * container
+ *
+ */
+static void *
+_bt_find(netsnmp_container *container, const void *data)
+{
+    return _bt_get(container, data, 1);
+}
+
+static void *
+_bt_find_next(netsnmp_container *container, const void *data)
+{
+    return _bt_get(container, data, 0);
+}
+
+static int
+_bt_remove(netsnmp_container *container, const void *data)
+{
+    return _bt_remove_entry(container, data, NULL, NULL);
+}
+
+static int
+_bt_free(netsnmp_container *container)
+{
+    btree          *t = (btree *)container->container_data;
+
+    _bt_free_node(t->root);
+    free(t);
+    free(container);
+    return 0;
+}
+
+static size_t
+_bt_size(netsnmp_container *container)
+{
+    btree          *t = (btree *)container->container_data;
+
+    return t ? t->count : 0;
+}
+
+static void
+_bt_for_each(netsnmp_container *container, netsnmp_container_obj_func *f,
+             void *context)
+{
+    btree          *t = (btree *)container->container_data;
+    bt_leaf        *l;
+    int             i;
+
+    for (l = t->first; l; l = l->next)
+        for (i = 0; i < l->n.count; ++i)
+            (*f) (l->n.key[i], context);
+}
+
+static void
+_bt_clear(netsnmp_container *container, netsnmp_container_obj_func *f,
+          void *context)
+{
+    btree          *t = (btree *)container->container_data;
+
+    if (NULL != f)
+        _bt_for_each(container, f, context);
+    _bt_clear_nodes(t);
+    ++container->sync;
+}
+
+static netsnmp_void_array *
+_bt_get_subset(netsnmp_container *container, void *data)
+{
+    btree          *t = (btree *)container->container_data;
+    netsnmp_void_array *va;
+    bt_node        *n;
+    bt_leaf        *l;
+    void          **array = NULL, **tmp;
+    size_t          len = 0, size = 0;
+    int             pos;
+
+    if (!data || !t->count)
+        return NULL;
+    netsnmp_assert(container->ncompare);
+    if (!container->ncompare)
+        return NULL;
+
+    for (n = t->root; !n->leaf; )
+        n = ((bt_inner *)n)->child[_bt_bound(container->ncompare, n,
+                                             data, 0)];
+    l = (bt_leaf *)n;
+    for (pos = _bt_bound(container->ncompare, n, data, 0); l;
+         l = l->next, pos = 0) {
+        for (; pos < l->n.count; ++pos) {
+            if (container->ncompare(l->n.key[pos], data) != 0)
+                goto done;
+            if (len == size) {
+                size = size ? 2 * size : 16;
+                tmp = (void **)realloc(array, size * sizeof(void *));
+                if (NULL == tmp) {
+                    free(array);
+                    return NULL;
+                }
+                array = tmp;
+            }
+            array[len++] = l->n.key[pos];
+        }
+    }
+  done:
+    if (0 == len)
+        return NULL;
+
+    va = SNMP_MALLOC_TYPEDEF(netsnmp_void_array);
+    if (va == NULL) {
+        free(array);
+        return NULL;
+    }
+    va->size = len;
+    va->array = array;
+
+    return va;
+}
+
+static int
+_bt_options(netsnmp_container *c, int set, u_int flags)
+{
+    if (set) {
+        if ((flags & CONTAINER_KEY_ALLOW_DUPLICATES) == flags)
+            c->flags = flags;
+        else
+            flags = (u_int)-1; /* unsupported flag */
+    }
+    else
+        return ((c->flags & flags) == flags);
+    return flags;
+}
+
+static void
+_bt_collect(void *data, void *context)
+{
+    void         ***p = (void ***)context;
+
+    *(*p)++ = data;
+}
+
+static netsnmp_container *
+_bt_duplicate(netsnmp_container *c, void *ctx, u_int flags)
+{
+    netsnmp_container *dup;
+    btree          *t = (btree *)c->container_data;
+    void          **data, **p;
+    int             rc;
+
+    if (flags) {
+        snmp_log(LOG_ERR, "btree duplicate does not support flags yet\n");
+        return NULL;
+    }
+
+    dup = netsnmp_container_get_btree();
+    if (NULL == dup) {
+        snmp_log(LOG_ERR," no memory for btree duplicate\n");
+        return NULL;
+    }
+    if (netsnmp_container_data_dup(dup, c) != 0) {
+        _bt_free(dup);
+        return NULL;
+    }
+
+    /*
+     * shallow copy
+     */
+    data = (void **)malloc((t->count ? t->count : 1) * sizeof(void *));
+    if (NULL == data) {
+        snmp_log(LOG_ERR, "no memory for btree duplicate\n");
+        _bt_free(dup);
+        return NULL;
+    }
+    p = data;
+    _bt_for_each(c, _bt_collect, &p);
+    rc = _bt_load((btree *)dup->container_data, data, t->count);
+    free(data);
+    if (rc != 0) {
+        _bt_free(dup);
+        return NULL;
+    }
+
+    return dup;
+}
+
+static void
+_bt_init_functions(netsnmp_container *c)
+{
+    /*
+     * NOTE: CHANGES HERE MUST BE DUPLICATED IN duplicate AS WELL!!
+     */
+    c->cfree = _bt_free;
+    c->get_size = _bt_size;
+    c->insert = _bt_insert;
+    c->remove = _bt_remove;
+    c->find = _bt_find;
+    c->find_next = _bt_find_next;
+    c->get_subset = _bt_get_subset;
+    c->get_iterator = _bt_iterator_get;
+    c->for_each = _bt_for_each;
+    c->clear = _bt_clear;
+    c->options = _bt_options;
+    c->duplicate = _bt_duplicate;
+    c->get_at = NULL;
+    c->remove_at = NULL;
+    c->insert_before = NULL;
+    c->insert_after = NULL;
+    c->load_begin = NULL;
+    c->load_end = NULL;
+}
+
+netsnmp_container *
+netsnmp_container_get_btree(void)
+{
+    /*
+     * allocate memory
+     */
+    netsnmp_container *c = SNMP_MALLOC_TYPEDEF(netsnmp_container);
+    if (NULL==c) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        return NULL;
+    }
+
+    c->container_data = _bt_initialize();
+    if (NULL == c->container_data) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        free(c);
+        return NULL;
+    }
+
+    netsnmp_init_container(c, NULL, _bt_free, _bt_size, NULL, _bt_insert,
+                           _bt_remove, _bt_find);
+    _bt_init_functions(c);
+
+    return c;
+}
+
+int
+netsnmp_container_btree_adopt(netsnmp_container *c, void **data,
+                              size_t count)
+{
+    btree          *t;
+
+    if (NULL == c || (c->flags & ~CONTAINER_KEY_ALLOW_DUPLICATES))
+        return -1;
+
+    t = _bt_initialize();
+    if (NULL == t)
+        return -1;
+    if (_bt_load(t, data, count) != 0) {
+        _bt_free_node(t->root);
+        free(t);
+        return -1;
+    }
+
+    c->container_data = t;
+    _bt_init_functions(c);
+    ++c->sync;
+
+    return 0;
+}
+
+int
+netsnmp_container_btree_remove(netsnmp_container *c, const void *key,
+                               void **save)
+{
+    if (save)
+        *save = NULL;
+
+    /*
+     * among duplicates, prefer the entry that was passed in
+     */
+    if (_bt_remove_entry(c, key, key, save) == 0)
+        return 0;
+    return _bt_remove_entry(c, key, NULL, save);
+}
+
+netsnmp_factory *
+netsnmp_container_get_btree_factory(void)
+{
+    static netsnmp_factory f = { "btree",
+                                 (netsnmp_factory_produce_f*)
+                                 netsnmp_container_get_btree };
+
+    return &f;
+}
+
+void
+netsnmp_container_btree_init(void)
+{
+    netsnmp_container_register("btree",
+                               netsnmp_container_get_btree_factory());
+}
+
+/**********************************************************************
+ *
+ * iterator
+ *
+ */
+static void *
+_bt_iterator_position(btree_iterator *it)
+{
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    if(it->base.container->sync != it->base.sync) {
+        DEBUGMSGTL(("container:iterator", "out of sync\n"));
+        return NULL;
+    }
+
+    if(NULL == it->leaf || it->pos < 0 || it->pos >= it->leaf->n.count) {
+        DEBUGMSGTL(("container:iterator", "end of container\n"));
+        return NULL;
+    }
+
+    return it->leaf->n.key[it->pos];
+}
+
+static void *
+_bt_iterator_curr(btree_iterator *it)
+{
+    return _bt_iterator_position(it);
+}
+
+static void *
+_bt_iterator_first(btree_iterator *it)
+{
+    btree          *t = (btree *)it->base.container->container_data;
+
+    it->leaf = t->first;
+    it->pos = 0;
+    it->next = NULL;
+
+    return _bt_iterator_position(it);
+}
+
+static void *
+_bt_iterator_next(btree_iterator *it)
+{
+    if(NULL == it || NULL == it->leaf) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    if (it->next) {
+        /* find our way back after a remove */
+        if (_bt_locate(it->base.container, it->next, &it->leaf,
+                       &it->pos) != 0)
+            it->leaf = NULL;
+        it->next = NULL;
+    } else if (++it->pos >= it->leaf->n.count && it->leaf->next) {
+        it->leaf = it->leaf->next;
+        it->pos = 0;
+    }
+
+    return _bt_iterator_position(it);
+}
+
+static void *
+_bt_iterator_last(btree_iterator *it)
+{
+    btree          *t = (btree *)it->base.container->container_data;
+
+    it->leaf = t->last;
+    it->pos = t->last->n.count - 1;
+    it->next = NULL;
+
+    return _bt_iterator_position(it);
+}
+
+static int
+_bt_iterator_remove(btree_iterator *it)
+{
+    void           *entry = _bt_iterator_position(it);
+    void           *next = NULL;
+    int             rc;
+
+    if (NULL == entry)
+        return -1;
+
+    if (it->pos + 1 < it->leaf->n.count)
+        next = it->leaf->n.key[it->pos + 1];
+    else if (it->leaf->next)
+        next = it->leaf->next->n.key[0];
+
+    rc = _bt_remove_entry(it->base.container, entry, entry, NULL);
+
+    /*
+     * since this iterator was used for the remove, keep it in sync with
+     * the container, and remember where next should continue.
+     */
+    it->base.sync = it->base.container->sync;
+    if (next)
+        it->next = next;
+    else
+        it->leaf = NULL;
+
+    return rc;
+}
+
+static int
+_bt_iterator_reset(btree_iterator *it)
+{
+    /*
+     * save sync count, to make sure container doesn't change while
+     * iterator is in use.
+     */
+    it->base.sync = it->base.container->sync;
+
+    _bt_iterator_first(it);
+
+    return 0;
+}
+
+static int
+_bt_iterator_release(netsnmp_iterator *it)
+{
+    free(it);
+
+    return 0;
+}
+
+static netsnmp_iterator *
+_bt_iterator_get(netsnmp_container *c)
+{
+    btree_iterator *it;
+
+    if(NULL == c)
+        return NULL;
+
+    it = SNMP_MALLOC_TYPEDEF(btree_iterator);
+    if(NULL == it)
+        return NULL;
+
+    it->base.container = c;
+
+    it->base.first = (netsnmp_iterator_rtn*)_bt_iterator_first;
+    it->base.next = (netsnmp_iterator_rtn*)_bt_iterator_next;
+    it->base.curr = (netsnmp_iterator_rtn*)_bt_iterator_curr;
+    it->base.last = (netsnmp_iterator_rtn*)_bt_iterator_last;
+    it->base.remove = (netsnmp_iterator_rc*)_bt_iterator_remove;
+    it->base.reset = (netsnmp_iterator_rc*)_bt_iterator_reset;
+    it->base.release = (netsnmp_iterator_rc*)_bt_iterator_release;
+
+    (void)_bt_iterator_reset(it);
+
+    return (netsnmp_iterator *)it;
+}
+
+/**  @} */
@@ -0,0 +1,715 @@
+/*
+ * container_hash.c
+ * $Id$
+ *
+ * see comments in header file.
+ *
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-features.h>
+
+#ifdef HAVE_IO_H
+#include <io.h>
+#endif
+#include <stdio.h>
+#if HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#if HAVE_MALLOC_H
+#include <malloc.h>
+#endif
+#include <sys/types.h>
+#if HAVE_STRING_H
+#include <string.h>
+#else
+#include <strings.h>
+#endif
+
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/types.h>
+#include <net-snmp/library/snmp_api.h>
+#include <net-snmp/library/container.h>
+#include <net-snmp/library/container_hash.h>
+#include <net-snmp/library/tools.h>
+#include <net-snmp/library/snmp_assert.h>
+
+/** @defgroup hash_container hash_container
+ *  An unordered container for exact-match lookups.
+ *  @ingroup container
+ *
+ *  The entries are kept in an open addressing hash table with linear
+ *  probing, which is resized to stay at most half full.  find, insert
+ *  and remove take constant time.  find_next and get_subset have to look
+ *  at every entry, so the hash container is best used as an additional
+ *  index (see netsnmp_container_add_index) next to a sorted primary
+ *  container that answers the ordered lookups.  Exact lookups then
+ *  use CONTAINER_FIND on the index itself (see SUBCONTAINER_FIND).
+ *
+ *  Iterators and for_each visit the entries in no particular order.
+ *
+ *  @{
+ */
+
+#define HT_MIN_SIZE   16
+
+typedef struct hash_table_s {
+    void          **slot;
+    size_t          size;               /* a power of 2, or 0 */
+    size_t          count;              /* entries */
+    size_t          used;               /* entries and removed slots */
+    netsnmp_container_hash_func *hash;
+} hash_table;
+
+typedef struct hash_iterator_s {
+    netsnmp_iterator base;
+    size_t          pos;
+} hash_iterator;
+
+/*
+ * marks a slot whose entry was removed, so that probing continues past it
+ */
+static char     _ht_removed;
+#define HT_REMOVED ((void *)&_ht_removed)
+#define HT_ENTRY(p) ((p) != NULL && (p) != HT_REMOVED)
+
+static netsnmp_iterator *_ht_iterator_get(netsnmp_container *c);
+
+/**********************************************************************
+ *
+ * hash functions
+ *
+ */
+/*
+ * FNV-1a
+ */
+u_int
+netsnmp_hash_mem(const void *buf, size_t len, u_int hash)
+{
+    const u_char   *p = (const u_char *)buf;
+
+    while (len--) {
+        hash ^= *p++;
+        hash *= 16777619;
+    }
+    return hash;
+}
+
+#define HT_SEED    2166136261U
+
+u_int
+netsnmp_hash_netsnmp_index(const void *data)
+{
+    const netsnmp_index *idx = (const netsnmp_index *)data;
+
+    return netsnmp_hash_mem(idx->oids, idx->len * sizeof(oid), HT_SEED);
+}
+
+u_int
+netsnmp_hash_direct_cstring(const void *data)
+{
+    return netsnmp_hash_mem(data, strlen((const char *)data), HT_SEED);
+}
+
+u_int
+netsnmp_hash_cstring(const void *data)
+{
+    /* same layout as netsnmp_compare_cstring expects */
+    const char     *name = *(const char * const *)data;
+
+    return netsnmp_hash_direct_cstring(name);
+}
+
+static netsnmp_container_hash_func *
+_ht_hash_func(netsnmp_container *c)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+
+    if (t->hash)
+        return t->hash;
+
+    if (c->compare == netsnmp_compare_netsnmp_index)
+        t->hash = netsnmp_hash_netsnmp_index;
+    else if (c->compare == netsnmp_compare_cstring)
+        t->hash = netsnmp_hash_cstring;
+    else if (c->compare == netsnmp_compare_direct_cstring)
+        t->hash = netsnmp_hash_direct_cstring;
+    else
+        snmp_log(LOG_ERR, "no hash function set for container '%s'\n",
+                 c->container_name ? c->container_name : "");
+
+    return t->hash;
+}
+
+/**********************************************************************
+ *
+ * table
+ *
+ */
+static hash_table *
+_ht_initialize(void)
+{
+    return SNMP_MALLOC_TYPEDEF(hash_table);
+}
+
+/*
+ * move all entries into a table of the given size, dropping removed slots
+ */
+static int
+_ht_resize(netsnmp_container *c, size_t size)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    void          **slot;
+    size_t          i, j;
+
+    slot = (void **)calloc(size, sizeof(void *));
+    if (NULL == slot) {
+        snmp_log(LOG_ERR, "malloc failed in hash resize\n");
+        return -1;
+    }
+
+    for (i = 0; i < t->size; ++i) {
+        if (!HT_ENTRY(t->slot[i]))
+            continue;
+        for (j = t->hash(t->slot[i]) & (size - 1); slot[j];
+             j = (j + 1) & (size - 1))
+            ;
+        slot[j] = t->slot[i];
+    }
+
+    free(t->slot);
+    t->slot = slot;
+    t->size = size;
+    t->used = t->count;
+
+    return 0;
+}
+
+/*
+ * find the slot holding an entry equal to key. Among duplicates, prefer
+ * the entry that is the key itself.
+ */
+static int
+_ht_lookup(netsnmp_container *c, const void *key, size_t *pos)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    int             found = 0;
+    size_t          i;
+
+    if (0 == t->count || NULL == _ht_hash_func(c))
+        return -1;
+
+    for (i = t->hash(key) & (t->size - 1); t->slot[i];
+         i = (i + 1) & (t->size - 1)) {
+        if (t->slot[i] == HT_REMOVED || c->compare(t->slot[i], key) != 0)
+            continue;
+        if (t->slot[i] == key || !found) {
+            *pos = i;
+            found = 1;
+        }
+        if (t->slot[i] == key ||
+            !(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES))
+            break;
+    }
+
+    return found ? 0 : -1;
+}
+
+static int
+_ht_insert(netsnmp_container *c, const void *entry)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    size_t          i;
+
+    if (NULL == entry || NULL == _ht_hash_func(c))
+        return -1;
+
+    if (!(c->flags & CONTAINER_KEY_ALLOW_DUPLICATES) &&
+        _ht_lookup(c, entry, &i) == 0) {
+        DEBUGMSGTL(("container","not inserting duplicate key\n"));
+        return -1;
+    }
+
+    /*
+     * keep the table at most half full, counting removed slots. If most
+     * of those are removed entries, just clean up at the same size.
+     */
+    if ((t->used + 1) * 2 > t->size) {
+        size_t          size = t->size ? t->size : HT_MIN_SIZE;
+
+        while ((t->count + 1) * 2 > size / 2)
+            size *= 2;
+        if (_ht_resize(c, size) != 0)
+            return -1;
+    }
+
+    for (i = t->hash(entry) & (t->size - 1); HT_ENTRY(t->slot[i]);
+         i = (i + 1) & (t->size - 1))
+        ;
+    if (NULL == t->slot[i])
+        ++t->used;
+    t->slot[i] = NETSNMP_REMOVE_CONST(void *, entry);
+    ++t->count;
+    ++c->sync;
+
+    return 0;
+}
+
+static void
+_ht_remove_slot(netsnmp_container *c, size_t i)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+
+    /*
+     * a removed slot can be emptied if the probe sequence stops after it
+     */
+    if (NULL == t->slot[(i + 1) & (t->size - 1)]) {
+        t->slot[i] = NULL;
+        --t->used;
+    } else
+        t->slot[i] = HT_REMOVED;
+    --t->count;
+    ++c->sync;
+}
+
+static int
+_ht_remove(netsnmp_container *c, const void *data)
+{
+    size_t          i;
+
+    if (NULL == data || _ht_lookup(c, data, &i) != 0)
+        return -1;
+    _ht_remove_slot(c, i);
+
+    return 0;
+}
+
+static void *
+_ht_find(netsnmp_container *c, const void *data)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    size_t          i;
+
+    if (NULL == data || _ht_lookup(c, data, &i) != 0)
+        return NULL;
+    return t->slot[i];
+}
+
+/*
+ * the smallest entry greater than data, or the first entry for NULL. This
+ * looks at every entry.
+ */
+static void *
+_ht_find_next(netsnmp_container *c, const void *data)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    void           *best = NULL;
+    size_t          i;
+
+    for (i = 0; i < t->size; ++i) {
+        if (!HT_ENTRY(t->slot[i]))
+            continue;
+        if (data && c->compare(t->slot[i], data) <= 0)
+            continue;
+        if (NULL == best || c->compare(t->slot[i], best) < 0)
+            best = t->slot[i];
+    }
+
+    return best;
+}
+
+static int
+_ht_free(netsnmp_container *c)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+
+    free(t->slot);
+    free(t);
+    free(c);
+    return 0;
+}
+
+static size_t
+_ht_size(netsnmp_container *c)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+
+    return t ? t->count : 0;
+}
+
+static void
+_ht_for_each(netsnmp_container *c, netsnmp_container_obj_func *f,
+             void *context)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    size_t          i;
+
+    for (i = 0; i < t->size; ++i)
+        if (HT_ENTRY(t->slot[i]))
+            (*f) (t->slot[i], context);
+}
+
+static void
+_ht_clear(netsnmp_container *c, netsnmp_container_obj_func *f,
+          void *context)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+
+    if (NULL != f)
+        _ht_for_each(c, f, context);
+    free(t->slot);
+    t->slot = NULL;
+    t->size = t->count = t->used = 0;
+    ++c->sync;
+}
+
+/*
+ * merge sort the len entries in array with the container's compare
+ */
+static int
+_ht_sort(netsnmp_container *c, void **array, size_t len)
+{
+    void          **tmp, **src, **dst, **swap;
+    size_t          width, lo, mid, hi, i, j, k;
+
+    tmp = (void **)malloc(len * sizeof(void *));
+    if (NULL == tmp)
+        return -1;
+
+    src = array;
+    dst = tmp;
+    for (width = 1; width < len; width *= 2) {
+        for (lo = 0; lo < len; lo += 2 * width) {
+            mid = SNMP_MIN(lo + width, len);
+            hi = SNMP_MIN(lo + 2 * width, len);
+            for (i = lo, j = mid, k = lo; i < mid && j < hi; )
+                dst[k++] = c->compare(src[j], src[i]) < 0 ? src[j++] : src[i++];
+            while (i < mid)
+                dst[k++] = src[i++];
+            while (j < hi)
+                dst[k++] = src[j++];
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != array)
+        memcpy(array, src, len * sizeof(void *));
+    free(tmp);
+
+    return 0;
+}
+
+/*
+ * all entries matching the partial key, in order. This looks at every
+ * entry.
+ */
+static netsnmp_void_array *
+_ht_get_subset(netsnmp_container *c, void *data)
+{
+    hash_table     *t = (hash_table *)c->container_data;
+    netsnmp_void_array *va;
+    void          **array;
+    size_t          i, len = 0;
+
+    if (!data || !t->count)
+        return NULL;
+    netsnmp_assert(c->ncompare);
+    if (!c->ncompare)
+        return NULL;
+
+    array = (void **)malloc(t->count * sizeof(void *));
+    if (NULL == array)
+        return NULL;
+    for (i = 0; i < t->size; ++i)
+        if (HT_ENTRY(t->slot[i]) && c->ncompare(t->slot[i], data) == 0)
+            array[len++] = t->slot[i];
+    if (0 == len) {
+        free(array);
+        return NULL;
+    }
+
+    if (_ht_sort(c, array, len) != 0) {
+        free(array);
+        return NULL;
+    }
+
+    va = SNMP_MALLOC_TYPEDEF(netsnmp_void_array);
+    if (va == NULL) {
+        free(array);
+        return NULL;
+    }
+    va->size = len;
+    va->array = array;
+
+    return va;
+}
+
+static int
+_ht_options(netsnmp_container *c, int set, u_int flags)
+{
+    if (set) {
+        if ((flags & CONTAINER_KEY_ALLOW_DUPLICATES) == flags)
+            c->flags = flags;
+        else
+            flags = (u_int)-1; /* unsupported flag */
+    }
+    else
+        return ((c->flags & flags) == flags);
+    return flags;
+}
+
+static netsnmp_container *
+_ht_duplicate(netsnmp_container *c, void *ctx, u_int flags)
+{
+    netsnmp_container *dup;
+    hash_table     *t = (hash_table *)c->container_data;
+    hash_table     *dupt;
+
+    if (flags) {
+        snmp_log(LOG_ERR, "hash duplicate does not support flags yet\n");
+        return NULL;
+    }
+
+    dup = netsnmp_container_get_hash();
+    if (NULL == dup) {
+        snmp_log(LOG_ERR," no memory for hash duplicate\n");
+        return NULL;
+    }
+    if (netsnmp_container_data_dup(dup, c) != 0) {
+        _ht_free(dup);
+        return NULL;
+    }
+
+    /*
+     * shallow copy
+     */
+    dupt = (hash_table *)dup->container_data;
+    dupt->hash = t->hash;
+    if (t->size) {
+        dupt->slot = (void **)malloc(t->size * sizeof(void *));
+        if (NULL == dupt->slot) {
+            snmp_log(LOG_ERR, "no memory for hash duplicate\n");
+            _ht_free(dup);
+            return NULL;
+        }
+        memcpy(dupt->slot, t->slot, t->size * sizeof(void *));
+        dupt->size = t->size;
+        dupt->count = t->count;
+        dupt->used = t->used;
+    }
+
+    return dup;
+}
+
+netsnmp_container *
+netsnmp_container_get_hash(void)
+{
+    /*
+     * allocate memory
+     */
+    netsnmp_container *c = SNMP_MALLOC_TYPEDEF(netsnmp_container);
+    if (NULL==c) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        return NULL;
+    }
+
+    c->container_data = _ht_initialize();
+    if (NULL == c->container_data) {
+        snmp_log(LOG_ERR, "couldn't allocate memory\n");
+        free(c);
+        return NULL;
+    }
+
+    netsnmp_init_container(c, NULL, _ht_free, _ht_size, NULL, _ht_insert,
+                           _ht_remove, _ht_find);
+    c->find_next = _ht_find_next;
+    c->get_subset = _ht_get_subset;
+    c->get_iterator = _ht_iterator_get;
+    c->for_each = _ht_for_each;
+    c->clear = _ht_clear;
+    c->options = _ht_options;
+    c->duplicate = _ht_duplicate;
+
+    return c;
+}
+
+int
+netsnmp_container_hash_set_func(netsnmp_container *c,
+                                netsnmp_container_hash_func *f)
+{
+    hash_table     *t;
+
+    if (NULL == c || c->get_size != _ht_size)
+        return -1;
+
+    t = (hash_table *)c->container_data;
+    if (t->count)
+        return -1;
+    t->hash = f;
+
+    return 0;
+}
+
+netsnmp_factory *
+netsnmp_container_get_hash_factory(void)
+{
+    static netsnmp_factory f = { "hash",
+                                 (netsnmp_factory_produce_f*)
+                                 netsnmp_container_get_hash };
+
+    return &f;
+}
+
+void
+netsnmp_container_hash_init(void)
+{
+    netsnmp_container_register("hash",
+                               netsnmp_container_get_hash_factory());
+}
+
+/**********************************************************************
+ *
+ * iterator
+ *
+ */
+static void *
+_ht_iterator_position(hash_iterator *it)
+{
+    hash_table     *t;
+
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    if(it->base.container->sync != it->base.sync) {
+        DEBUGMSGTL(("container:iterator", "out of sync\n"));
+        return NULL;
+    }
+
+    t = (hash_table *)it->base.container->container_data;
+    for (; it->pos < t->size; ++it->pos)
+        if (HT_ENTRY(t->slot[it->pos]))
+            return t->slot[it->pos];
+
+    DEBUGMSGTL(("container:iterator", "end of container\n"));
+    return NULL;
+}
+
+static void *
+_ht_iterator_curr(hash_iterator *it)
+{
+    return _ht_iterator_position(it);
+}
+
+static void *
+_ht_iterator_first(hash_iterator *it)
+{
+    it->pos = 0;
+
+    return _ht_iterator_position(it);
+}
+
+static void *
+_ht_iterator_next(hash_iterator *it)
+{
+    if(NULL == it) {
+        netsnmp_assert(NULL != it);
+        return NULL;
+    }
+
+    ++it->pos;
+
+    return _ht_iterator_position(it);
+}
+
+static void *
+_ht_iterator_last(hash_iterator *it)
+{
+    hash_table     *t = (hash_table *)it->base.container->container_data;
+    size_t          i;
+
+    for (i = t->size; i > 0; --i)
+        if (HT_ENTRY(t->slot[i - 1]))
+            break;
+    it->pos = i ? i - 1 : t->size;
+
+    return _ht_iterator_position(it);
+}
+
+static int
+_ht_iterator_remove(hash_iterator *it)
+{
+    hash_table     *t = (hash_table *)it->base.container->container_data;
+
+    if (NULL == _ht_iterator_position(it))
+        return -1;
+
+    /*
+     * always leave a removed marker, so that the entries after this one
+     * stay where the iterator expects them.
+     */
+    t->slot[it->pos] = HT_REMOVED;
+    --t->count;
+    ++it->base.container->sync;
+
+    /*
+     * since this iterator was used for the remove, keep it in sync with
+     * the container.
+     */
+    it->base.sync = it->base.container->sync;
+
+    return 0;
+}
+
+static int
+_ht_iterator_reset(hash_iterator *it)
+{
+    /*
+     * save sync count, to make sure container doesn't change while
+     * iterator is in use.
+     */
+    it->base.sync = it->base.container->sync;
+
+    it->pos = 0;
+
+    return 0;
+}
+
+static int
+_ht_iterator_release(netsnmp_iterator *it)
+{
+    free(it);
+
+    return 0;
+}
+
+static netsnmp_iterator *
+_ht_iterator_get(netsnmp_container *c)
+{
+    hash_iterator  *it;
+
+    if(NULL == c)
+        return NULL;
+
+    it = SNMP_MALLOC_TYPEDEF(hash_iterator);
+    if(NULL == it)
+        return NULL;
+
+    it->base.container = c;
+
+    it->base.first = (netsnmp_iterator_rtn*)_ht_iterator_first;
+    it->base.next = (netsnmp_iterator_rtn*)_ht_iterator_next;
+    it->base.curr = (netsnmp_iterator_rtn*)_ht_iterator_curr;
+    it->base.last = (netsnmp_iterator_rtn*)_ht_iterator_last;
+    it->base.remove = (netsnmp_iterator_rc*)_ht_iterator_remove;
+    it->base.reset = (netsnmp_iterator_rc*)_ht_iterator_reset;
+    it->base.release = (netsnmp_iterator_rc*)_ht_iterator_release;
+
+    (void)_ht_iterator_reset(it);
+
+    return (netsnmp_iterator *)it;
+}
+
+/**  @} */
@@ -23,18 +23,15 @@ netsnmp_feature_child_of(oid_stash_no_free, oid_stash_all);
 */
 
 /*
- * xxx-rks: when you have some spare time:
- *
- * b) basically, everything currently creates one node per sub-oid,
- *    which is less than optimal. add code to create nodes with the
- *    longest possible OID per node, and split nodes when necessary
- *    during adds.
- *
- * c) If you are feeling really ambitious, also merge split nodes if
- *    possible on a delete.
- *
- * xxx-wes: uh, right, like I *ever* have that much time.
+ * The tree is path compressed: each node holds the run of sub-identifiers
+ * leading to it from its parent (prefix), so a chain of nodes with a
+ * single child each is stored as one node.  A node exists where data is
+ * stored or where the paths to two children part.  Adds split a node
+ * when a new path leaves in the middle of its prefix.
  *
+ * Children are kept in an array sorted by the first sub-identifier of
+ * their prefix (no two share one), which grows as needed, and found with
+ * a binary search.
  */
 
 /***************************************************************************
@@ -42,31 +39,46 @@ netsnmp_feature_child_of(oid_stash_no_free, oid_stash_all);
  *
  ***************************************************************************/
 
+static netsnmp_oid_stash_node *
+_stash_new_node(const oid *prefix, size_t prefix_len, size_t children)
+{
+    netsnmp_oid_stash_node *ret;
+
+    ret = (netsnmp_oid_stash_node *)
+        calloc(1, sizeof(netsnmp_oid_stash_node) +
+               (prefix_len ? prefix_len - 1 : 0) * sizeof(oid));
+    if (!ret)
+        return NULL;
+    if (children) {
+        ret->children = (netsnmp_oid_stash_node**)
+            calloc(children, sizeof(netsnmp_oid_stash_node *));
+        if (!ret->children) {
+            free(ret);
+            return NULL;
+        }
+        ret->children_size = children;
+    }
+    if (prefix_len)
+        memcpy(ret->prefix, prefix, prefix_len * sizeof(oid));
+    ret->prefix_len = prefix_len;
+    return ret;
+}
+
 /**
  * Create an netsnmp_oid_stash node
  *
- * @param mysize  the size of the child pointer array
+ * @param mysize  the initial size of the child pointer array
  *
  * @return NULL on error, otherwise the newly allocated node
  */
 netsnmp_oid_stash_node *
 netsnmp_oid_stash_create_sized_node(size_t mysize)
 {
-    netsnmp_oid_stash_node *ret;
-    ret = SNMP_MALLOC_TYPEDEF(netsnmp_oid_stash_node);
-    if (!ret)
-        return NULL;
-    ret->children = (netsnmp_oid_stash_node**) calloc(mysize, sizeof(netsnmp_oid_stash_node *));
-    if (!ret->children) {
-        free(ret);
-        return NULL;
-    }
-    ret->children_size = mysize;
-    return ret;
+    return _stash_new_node(NULL, 0, mysize);
 }
 
 /** Creates a netsnmp_oid_stash_node.
- * Assumes you want the default OID_STASH_CHILDREN_SIZE hash size for the node.
+ * Assumes you want the default OID_STASH_CHILDREN_SIZE child array size.
  * @return NULL on error, otherwise the newly allocated node
  */
 NETSNMP_INLINE netsnmp_oid_stash_node *
@@ -75,8 +87,102 @@ netsnmp_oid_stash_create_node(void)
     return netsnmp_oid_stash_create_sized_node(OID_STASH_CHILDREN_SIZE);
 }
 
+/*
+ * the position of the child whose prefix starts with subid, or where one
+ * would be inserted.
+ */
+static size_t
+_stash_child_pos(const netsnmp_oid_stash_node *node, oid subid)
+{
+    size_t          lo = 0, hi = node->children_count, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (node->children[mid]->prefix[0] < subid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static netsnmp_oid_stash_node *
+_stash_child(const netsnmp_oid_stash_node *node, oid subid)
+{
+    size_t          pos = _stash_child_pos(node, subid);
+
+    if (pos < node->children_count &&
+        node->children[pos]->prefix[0] == subid)
+        return node->children[pos];
+    return NULL;
+}
+
+static int
+_stash_insert_child(netsnmp_oid_stash_node *node, size_t pos,
+                    netsnmp_oid_stash_node *child)
+{
+    if (node->children_count == node->children_size) {
+        size_t          size = node->children_size ?
+            2 * node->children_size : OID_STASH_CHILDREN_SIZE;
+        netsnmp_oid_stash_node **children = (netsnmp_oid_stash_node **)
+            realloc(node->children, size * sizeof(netsnmp_oid_stash_node *));
+
+        if (!children)
+            return SNMPERR_MALLOC;
+        node->children = children;
+        node->children_size = size;
+    }
+    memmove(&node->children[pos + 1], &node->children[pos],
+            (node->children_count - pos) * sizeof(netsnmp_oid_stash_node *));
+    node->children[pos] = child;
+    node->children_count++;
+    child->parent = node;
+    return SNMPERR_SUCCESS;
+}
+
+/*
+ * the number of leading sub-identifiers of the node's prefix found in
+ * lookup.
+ */
+static size_t
+_stash_match(const netsnmp_oid_stash_node *node, const oid *lookup,
+             size_t lookup_len)
+{
+    size_t          i;
+
+    for (i = 0; i < node->prefix_len && i < lookup_len; i++)
+        if (node->prefix[i] != lookup[i])
+            break;
+    return i;
+}
+
 netsnmp_feature_child_of(oid_stash_add_data, oid_stash_all);
 #ifndef NETSNMP_FEATURE_REMOVE_OID_STASH_ADD_DATA
+/*
+ * split node after the first len sub-identifiers of its prefix, and
+ * return the new node holding those.
+ */
+static netsnmp_oid_stash_node *
+_stash_split(netsnmp_oid_stash_node *node, size_t len)
+{
+    netsnmp_oid_stash_node *parent = node->parent, *top;
+
+    top = _stash_new_node(node->prefix, len, OID_STASH_CHILDREN_SIZE);
+    if (!top)
+        return NULL;
+
+    parent->children[_stash_child_pos(parent, node->prefix[0])] = top;
+    top->parent = parent;
+
+    node->prefix_len -= len;
+    memmove(node->prefix, &node->prefix[len], node->prefix_len * sizeof(oid));
+    top->children[0] = node;
+    top->children_count = 1;
+    node->parent = top;
+
+    return top;
+}
+
 /** adds data to the stash at a given oid.
 
  * @param root the top of the stash tree
@@ -92,8 +198,8 @@ int
 netsnmp_oid_stash_add_data(netsnmp_oid_stash_node **root,
                            const oid * lookup, size_t lookup_len, void *mydata)
 {
-    netsnmp_oid_stash_node *curnode, *tmpp, *loopp;
-    unsigned int    i;
+    netsnmp_oid_stash_node *curnode, *tmpp;
+    size_t          i, matched;
 
     if (!root || !lookup || lookup_len == 0)
         return SNMPERR_GENERR;
@@ -106,56 +212,49 @@ netsnmp_oid_stash_add_data(netsnmp_oid_stash_node **root,
     DEBUGMSGTL(( "oid_stash", "stash_add_data "));
     DEBUGMSGOID(("oid_stash", lookup, lookup_len));
     DEBUGMSG((   "oid_stash", "\n"));
-    tmpp = NULL;
-    for (curnode = *root, i = 0; i < lookup_len; i++) {
-        tmpp = curnode->children[lookup[i] % curnode->children_size];
+    for (curnode = *root, i = 0; i < lookup_len; i += matched) {
+        tmpp = _stash_child(curnode, lookup[i]);
         if (!tmpp) {
             /*
-             * no child in array at all 
+             * nothing down this way yet; one node holds the rest
              */
-            tmpp = curnode->children[lookup[i] % curnode->children_size] =
-                netsnmp_oid_stash_create_node();
-            tmpp->value = lookup[i];
-            tmpp->parent = curnode;
-        } else {
-            for (loopp = tmpp; loopp; loopp = loopp->next_sibling) {
-                if (loopp->value == lookup[i])
-                    break;
-            }
-            if (loopp) {
-                tmpp = loopp;
-            } else {
-                /*
-                 * none exists.  Create it 
-                 */
-                loopp = netsnmp_oid_stash_create_node();
-                loopp->value = lookup[i];
-                loopp->next_sibling = tmpp;
-                loopp->parent = curnode;
-                tmpp->prev_sibling = loopp;
-                curnode->children[lookup[i] % curnode->children_size] =
-                    loopp;
-                tmpp = loopp;
+            tmpp = _stash_new_node(&lookup[i], lookup_len - i, 0);
+            if (!tmpp)
+                return SNMPERR_MALLOC;
+            if (_stash_insert_child(curnode,
+                                    _stash_child_pos(curnode, lookup[i]),
+                                    tmpp) != SNMPERR_SUCCESS) {
+                free(tmpp);
+                return SNMPERR_MALLOC;
             }
+            tmpp->thedata = mydata;
+            return SNMPERR_SUCCESS;
+        }
+
+        matched = _stash_match(tmpp, &lookup[i], lookup_len - i);
+        if (matched < tmpp->prefix_len) {
             /*
-             * tmpp now points to the proper node 
+             * the lookup ends or leaves in the middle of this node
              */
+            tmpp = _stash_split(tmpp, matched);
+            if (!tmpp)
+                return SNMPERR_MALLOC;
         }
         curnode = tmpp;
     }
     /*
-     * tmpp now points to the exact match 
+     * curnode now points to the exact match 
      */
     if (curnode->thedata)
         return SNMPERR_GENERR;
-    if (NULL == tmpp)
-        return SNMPERR_GENERR;
-    tmpp->thedata = mydata;
+    curnode->thedata = mydata;
     return SNMPERR_SUCCESS;
 }
 #endif /* NETSNMP_FEATURE_REMOVE_OID_STASH_ADD_DATA */
 
 /** returns a node associated with a given OID.
+ * Only OIDs that data was stored at, or where stored OIDs part, have a
+ * node of their own.
  * @param root the top of the stash tree
  * @param lookup the oid to look up a node for.
  * @param lookup_len the length of the lookup oid
@@ -164,121 +263,104 @@ netsnmp_oid_stash_node *
 netsnmp_oid_stash_get_node(netsnmp_oid_stash_node *root,
                            const oid * lookup, size_t lookup_len)
 {
-    netsnmp_oid_stash_node *curnode, *tmpp, *loopp;
-    unsigned int    i;
+    netsnmp_oid_stash_node *curnode;
+    size_t          i;
 
-    if (!root)
+    if (!root || lookup_len == 0)
         return NULL;
-    tmpp = NULL;
-    for (curnode = root, i = 0; i < lookup_len; i++) {
-        tmpp = curnode->children[lookup[i] % curnode->children_size];
-        if (!tmpp) {
+    for (curnode = root, i = 0; i < lookup_len; i += curnode->prefix_len) {
+        curnode = _stash_child(curnode, lookup[i]);
+        if (!curnode || curnode->prefix_len > lookup_len - i ||
+            _stash_match(curnode, &lookup[i], lookup_len - i) !=
+            curnode->prefix_len)
             return NULL;
-        } else {
-            for (loopp = tmpp; loopp; loopp = loopp->next_sibling) {
-                if (loopp->value == lookup[i])
-                    break;
-            }
-            if (loopp) {
-                tmpp = loopp;
-            } else {
-                return NULL;
-            }
-        }
-        curnode = tmpp;
     }
-    return tmpp;
+    return curnode;
 }
 
-/** returns the next node associated with a given OID. INCOMPLETE.
+netsnmp_feature_child_of(oid_stash_iterate, oid_stash_all);
+#ifndef NETSNMP_FEATURE_REMOVE_OID_STASH_ITERATE
+/*
+ * the first node holding data in the subtree of node's children, starting
+ * at child pos.
+ */
+static netsnmp_oid_stash_node *
+_stash_first_below(netsnmp_oid_stash_node *node, size_t pos)
+{
+    netsnmp_oid_stash_node *ret;
+
+    for (; pos < node->children_count; pos++) {
+        if (node->children[pos]->thedata)
+            return node->children[pos];
+        ret = _stash_first_below(node->children[pos], 0);
+        if (ret)
+            return ret;
+    }
+    return NULL;
+}
+
+/*
+ * the first node holding data after node's whole subtree.
+ */
+static netsnmp_oid_stash_node *
+_stash_first_after(netsnmp_oid_stash_node *node)
+{
+    netsnmp_oid_stash_node *ret;
+
+    for (; node->parent; node = node->parent) {
+        ret = _stash_first_below(node->parent,
+                                 _stash_child_pos(node->parent,
+                                                  node->prefix[0]) + 1);
+        if (ret)
+            return ret;
+    }
+    return NULL;
+}
+
+/** returns the next node holding data after a given OID.
     This is equivelent to a GETNEXT operation.
  * @internal
  * @param root the top of the stash tree
  * @param lookup the oid to look up a node for.
  * @param lookup_len the length of the lookup oid
  */
-netsnmp_feature_child_of(oid_stash_iterate, oid_stash_all);
-#ifndef NETSNMP_FEATURE_REMOVE_OID_STASH_ITERATE
 netsnmp_oid_stash_node *
 netsnmp_oid_stash_getnext_node(netsnmp_oid_stash_node *root,
                                oid * lookup, size_t lookup_len)
 {
-    netsnmp_oid_stash_node *curnode, *tmpp, *loopp;
-    unsigned int    i, j, bigger_than = 0, do_bigger = 0;
+    netsnmp_oid_stash_node *curnode, *tmpp;
+    size_t          i, pos, matched;
 
     if (!root)
         return NULL;
-    tmpp = NULL;
 
-    /* get closest matching node */
-    for (curnode = root, i = 0; i < lookup_len; i++) {
-        tmpp = curnode->children[lookup[i] % curnode->children_size];
-        if (!tmpp) {
-            break;
-        } else {
-            for (loopp = tmpp; loopp; loopp = loopp->next_sibling) {
-                if (loopp->value == lookup[i])
-                    break;
-            }
-            if (loopp) {
-                tmpp = loopp;
-            } else {
-                break;
-            }
+    for (curnode = root, i = 0; i < lookup_len; i += matched) {
+        pos = _stash_child_pos(curnode, lookup[i]);
+        if (pos == curnode->children_count ||
+            curnode->children[pos]->prefix[0] != lookup[i])
+            /* everything from this child on is greater */
+            goto below;
+
+        tmpp = curnode->children[pos];
+        matched = _stash_match(tmpp, &lookup[i], lookup_len - i);
+        if (matched < tmpp->prefix_len) {
+            if (i + matched == lookup_len ||
+                tmpp->prefix[matched] > lookup[i + matched])
+                /* the whole of this child is greater */
+                goto below;
+            /* and the whole of this child is less */
+            pos++;
+            goto below;
         }
         curnode = tmpp;
     }
 
-    /* find the *next* node lexographically greater */
-    if (!curnode)
-        return NULL; /* ack! */
-
-    if (i+1 < lookup_len) {
-        bigger_than = lookup[i+1];
-        do_bigger = 1;
-    }
-
-    do {
-        /* check the children first */
-        tmpp = NULL;
-        /* next child must be (next) greater than our next search node */
-        /* XXX: should start this loop at best_nums[i]%... and wrap */
-        for(j = 0; j < curnode->children_size; j++) {
-            for (loopp = curnode->children[j];
-                 loopp; loopp = loopp->next_sibling) {
-                if ((!do_bigger || loopp->value > bigger_than) &&
-                    (!tmpp || tmpp->value > loopp->value)) {
-                    tmpp = loopp;
-                    /* XXX: can do better and include min_nums[i] */
-                    if (tmpp->value <= curnode->children_size-1) {
-                        /* best we can do. */
-                        goto done_this_loop;
-                    }
-                }
-            }
-        }
+    /* an exact match: the next is in its subtree, or after it */
+    pos = 0;
 
-      done_this_loop:
-        if (tmpp && tmpp->thedata)
-            /* found a node with data.  Go with it. */
-            return tmpp;
-
-        if (tmpp) {
-            /* found a child node without data, maybe find a grandchild? */
-            do_bigger = 0;
-            curnode = tmpp;
-        } else {
-            /* no respectable children (the bums), we'll have to go up.
-               But to do so, they must be better than our current best_num + 1.
-            */
-            do_bigger = 1;
-            bigger_than = curnode->value;
-            curnode = curnode->parent;
-        }
-    } while (curnode);
-
-    /* fell off the top */
-    return NULL;
+  below:
+    tmpp = _stash_first_below(curnode, pos);
+    return tmpp ? tmpp : _stash_first_after(curnode);
 }
 #endif /* NETSNMP_FEATURE_REMOVE_OID_STASH_ITERATE */
 
@@ -359,29 +441,28 @@ netsnmp_oid_stash_store(netsnmp_oid_stash_node *root,
     char *cp;
     char *appname = netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID, 
                                           NETSNMP_DS_LIB_APPTYPE);
-    int i;
+    size_t i, len;
     
     if (!tokenname || !root || !curoid || !dumpfn)
         return;
 
-    for (i = 0; i < (int)root->children_size; i++) {
-        if (root->children[i]) {
-            for (tmpp = root->children[i]; tmpp; tmpp = tmpp->next_sibling) {
-                curoid[curoid_len] = tmpp->value;
-                if (tmpp->thedata) {
-                    snprintf(buf, sizeof(buf), "%s ", tokenname);
-                    cp = read_config_save_objid(buf+strlen(buf), curoid,
-                                                curoid_len+1);
-                    *cp++ = ' ';
-                    *cp = '\0';
-                    if ((*dumpfn)(cp, sizeof(buf) - strlen(buf),
-                                  tmpp->thedata, tmpp))
-                        read_config_store(appname, buf);
-                }
-                netsnmp_oid_stash_store(tmpp, tokenname, dumpfn,
-                                        curoid, curoid_len+1);
-            }
+    for (i = 0; i < root->children_count; i++) {
+        tmpp = root->children[i];
+        len = curoid_len + tmpp->prefix_len;
+        if (len > MAX_OID_LEN)
+            continue;
+        memcpy(&curoid[curoid_len], tmpp->prefix,
+               tmpp->prefix_len * sizeof(oid));
+        if (tmpp->thedata) {
+            snprintf(buf, sizeof(buf), "%s ", tokenname);
+            cp = read_config_save_objid(buf+strlen(buf), curoid, len);
+            *cp++ = ' ';
+            *cp = '\0';
+            if ((*dumpfn)(cp, sizeof(buf) - strlen(buf),
+                          tmpp->thedata, tmpp))
+                read_config_store(appname, buf);
         }
+        netsnmp_oid_stash_store(tmpp, tokenname, dumpfn, curoid, len);
     }
 }
 
@@ -395,19 +476,18 @@ oid_stash_dump(netsnmp_oid_stash_node *root, char *prefix)
     char            myprefix[MAX_OID_LEN * 4];
     netsnmp_oid_stash_node *tmpp;
     int             prefix_len = strlen(prefix) + 1;    /* actually it's +2 */
-    unsigned int    i;
+    size_t          i, j;
 
     memset(myprefix, ' ', MAX_OID_LEN * 4);
     myprefix[prefix_len] = '\0';
 
-    for (i = 0; i < root->children_size; i++) {
-        if (root->children[i]) {
-            for (tmpp = root->children[i]; tmpp; tmpp = tmpp->next_sibling) {
-                printf("%s%" NETSNMP_PRIo "d@%d: %s\n", prefix, tmpp->value, i,
-                       (tmpp->thedata) ? "DATA" : "");
-                oid_stash_dump(tmpp, myprefix);
-            }
-        }
+    for (i = 0; i < root->children_count; i++) {
+        tmpp = root->children[i];
+        printf("%s", prefix);
+        for (j = 0; j < tmpp->prefix_len; j++)
+            printf("%s%" NETSNMP_PRIo "d", j ? "." : "", tmpp->prefix[j]);
+        printf("@%d: %s\n", (int)i, (tmpp->thedata) ? "DATA" : "");
+        oid_stash_dump(tmpp, myprefix);
     }
 }
 
@@ -420,26 +500,22 @@ void
 netsnmp_oid_stash_free(netsnmp_oid_stash_node **root,
                        NetSNMPStashFreeNode *freefn) {
 
-    netsnmp_oid_stash_node *curnode, *tmpp;
-    unsigned int    i;
+    netsnmp_oid_stash_node *tmpp;
+    size_t          i;
 
     if (!root || !*root)
         return;
 
     /* loop through all our children and free each node */
-    for (i = 0; i < (*root)->children_size; i++) {
-        if ((*root)->children[i]) {
-            for(tmpp = (*root)->children[i]; tmpp; tmpp = curnode) {
-                if (tmpp->thedata) {
-                    if (freefn)
-                        (*freefn)(tmpp->thedata);
-                    else
-                        free(tmpp->thedata);
-                }
-                curnode = tmpp->next_sibling;
-                netsnmp_oid_stash_free(&tmpp, freefn);
-            }
+    for (i = 0; i < (*root)->children_count; i++) {
+        tmpp = (*root)->children[i];
+        if (tmpp->thedata) {
+            if (freefn)
+                (*freefn)(tmpp->thedata);
+            else
+                free(tmpp->thedata);
         }
+        netsnmp_oid_stash_free(&tmpp, freefn);
     }
     free((*root)->children);
     free (*root);
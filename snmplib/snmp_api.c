@@ -857,6 +857,10 @@ register_default_handlers(void)
 		               NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_RETRIES);
     netsnmp_ds_register_config(ASN_OCTET_STR, "snmp", "outputPrecision",
                                NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_OUTPUT_PRECISION);
+    netsnmp_ds_register_config(ASN_INTEGER, "snmp",
+                               "tableContainerBtreeThreshold",
+                               NETSNMP_DS_LIBRARY_ID,
+                               NETSNMP_DS_LIB_TABLE_BTREE_THRESHOLD);
 
 
     netsnmp_register_service_handlers();
@@ -5723,6 +5727,22 @@ _sess_process_packet_handle_pdu(struct session_list *slp, netsnmp_session * sp,
 	}
       }
 
+#ifdef NETSNMP_SECMOD_USM
+      /*
+       * A stale engineID from the discovery cache: switch to the one the
+       * agent reported and resend, instead of failing the request.
+       */
+      if (pdu->command == SNMP_MSG_REPORT &&
+          (sp->flags & SNMP_FLAGS_ENGINEID_CACHED) &&
+          rp->retries <= sp->retries &&
+          snmpv3_get_report_type(pdu) == SNMPERR_UNKNOWN_ENG_ID &&
+          usm_rediscover_engineid(sp, rp->pdu, pdu) == SNMPERR_SUCCESS) {
+        handled = 1;
+        snmp_resend_request(slp, orp, rp, TRUE);
+        break;
+      }
+#endif /* NETSNMP_SECMOD_USM */
+
       if (rp->callback) {
 	callback = rp->callback;
 	magic = rp->cb_data;
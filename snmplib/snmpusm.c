@@ -229,6 +229,30 @@ static struct usmUser *noNameUser = NULL;
  */
 static struct usmUser *userList = NULL;
 
+/*
+ * Remote engines discovered by earlier runs, keyed by peername, so that
+ * clients can skip the engineID probe.  Only the engineID and the last
+ * authenticated boots/time are kept; keys are relocalized from the
+ * session as usual.
+ */
+struct usm_engineid_cache {
+    char           *peername;
+    u_char         *engineID;
+    size_t          engineIDLen;
+    u_int           boots, time;        /* 0/0 until authenticated */
+    time_t          stamp;              /* when boots/time (or the
+                                         * engineID) was last confirmed */
+    struct usm_engineid_cache *next;
+};
+#define USM_ENGINEID_CACHE_FILE     "snmpengineid"
+#define USM_ENGINEID_CACHE_MAX_AGE  (7 * 24 * 60 * 60)
+
+static struct usm_engineid_cache *engineIDCache = NULL;
+static int      engineIDCacheEnabled = 0;
+
+static void     usm_engineid_cache_timesync(const u_char *engineID,
+                                            size_t engineIDLen);
+
 /*
  * Set a given field of the secStateRef.
  *
@@ -2805,6 +2829,7 @@ usm_check_and_update_timeliness(u_char * secEngineID,
             *error = SNMPERR_USM_GENERICERROR;
             return -1;
         }
+        usm_engineid_cache_timesync(secEngineID, secEngineIDLen);
 
         *error = SNMPERR_SUCCESS;
         return 0;               /* Fresh message and time updated */
@@ -3056,7 +3081,16 @@ usm_process_in_msg(int msgProcModel,    /* (UNUSED) */
                                        (((sess && sess->isAuthoritative ==
                                           SNMP_SESS_AUTHORITATIVE) ||
                                          (!sess)) ? 0 : 1)))
-        == NULL) {
+        == NULL && sess && (sess->flags & SNMP_FLAGS_ENGINEID_CACHED) &&
+        secLevel == SNMP_SEC_LEVEL_NOAUTH) {
+        /*
+         * An agent refusing a cached engineID reports with its own
+         * engineID, for which we have no user yet; take the report as
+         * we would the one answering a probe.
+         */
+        user = noNameUser;
+    }
+    if (user == NULL) {
         DEBUGMSGTL(("usm", "Unknown User(%s)\n", secName));
         snmp_increment_statistic(STAT_USMSTATSUNKNOWNUSERNAMES);
         error = SNMPERR_USM_UNKNOWNSECURITYNAME;
@@ -3790,12 +3824,318 @@ usm_build_probe_pdu(netsnmp_pdu **pdu)
     return 0;
 }
 
+static struct usm_engineid_cache *
+usm_engineid_cache_find(const char *peername)
+{
+    struct usm_engineid_cache *ec;
+
+    for (ec = engineIDCache; ec; ec = ec->next)
+        if (strcmp(ec->peername, peername) == 0)
+            return ec;
+    return NULL;
+}
+
+static void
+usm_engineid_cache_free(void)
+{
+    struct usm_engineid_cache *ec;
+
+    while ((ec = engineIDCache) != NULL) {
+        engineIDCache = ec->next;
+        SNMP_FREE(ec->peername);
+        SNMP_FREE(ec->engineID);
+        free(ec);
+    }
+}
+
+/*
+ * Records (or replaces) the engineID found for peername.  Any boots/time
+ * recorded for the previous engineID no longer applies.
+ */
+static struct usm_engineid_cache *
+usm_engineid_cache_set(const char *peername, const u_char *engineID,
+                       size_t engineIDLen)
+{
+    struct usm_engineid_cache *ec;
+    u_char         *copy;
+
+    if (!peername || !engineID || !engineIDLen)
+        return NULL;
+
+    copy = netsnmp_memdup(engineID, engineIDLen);
+    if (!copy)
+        return NULL;
+
+    ec = usm_engineid_cache_find(peername);
+    if (!ec) {
+        ec = SNMP_MALLOC_STRUCT(usm_engineid_cache);
+        if (ec)
+            ec->peername = strdup(peername);
+        if (!ec || !ec->peername) {
+            SNMP_FREE(ec);
+            free(copy);
+            return NULL;
+        }
+        ec->next = engineIDCache;
+        engineIDCache = ec;
+    }
+    SNMP_FREE(ec->engineID);
+    ec->engineID = copy;
+    ec->engineIDLen = engineIDLen;
+    ec->boots = ec->time = 0;
+    ec->stamp = time(NULL);
+    return ec;
+}
+
+/*
+ * Refreshes the boots/time of an entry from the LCD, but only from
+ * values that came with an authenticated message.
+ */
+static int
+usm_engineid_cache_refresh(struct usm_engineid_cache *ec)
+{
+    u_int           boots, etime;
+
+    if (get_enginetime(ec->engineID, ec->engineIDLen, &boots, &etime,
+                       TRUE) != SNMPERR_SUCCESS || (!boots && !etime))
+        return 0;
+    ec->boots = boots;
+    ec->time = etime;
+    ec->stamp = time(NULL);
+    return 1;
+}
+
+static void
+usm_engineid_cache_save(void)
+{
+    struct usm_engineid_cache *ec;
+    char            line[SNMP_MAXBUF_MEDIUM];
+    char           *cptr;
+
+    snmp_save_persistent(USM_ENGINEID_CACHE_FILE);
+    for (ec = engineIDCache; ec; ec = ec->next) {
+        /* peername, engineID and three numbers must fit, hex encoded */
+        if (2 * (strlen(ec->peername) + ec->engineIDLen) + 64 > sizeof(line))
+            continue;
+        cptr = line + sprintf(line, "engineIDCacheEntry ");
+        cptr = read_config_save_octet_string(cptr, (u_char *) ec->peername,
+                                             strlen(ec->peername));
+        *cptr++ = ' ';
+        cptr = read_config_save_octet_string(cptr, ec->engineID,
+                                             ec->engineIDLen);
+        sprintf(cptr, " %u %u %lu", ec->boots, ec->time,
+                (unsigned long) ec->stamp);
+        read_config_store(USM_ENGINEID_CACHE_FILE, line);
+    }
+    snmp_clean_persistent(USM_ENGINEID_CACHE_FILE);
+}
+
+/*
+ * format: engineIDCacheEntry PEERNAME ENGINEID BOOTS TIME STAMP
+ */
+static void
+usm_parse_engineid_cache_entry(const char *token, char *line)
+{
+    struct usm_engineid_cache *ec;
+    char           *peername = NULL;
+    u_char         *engineID = NULL;
+    size_t          len = 0, engineIDLen = 0;
+    unsigned long   boots, etime, stamp;
+    time_t          now = time(NULL);
+
+    line = read_config_read_octet_string(line, (u_char **) &peername, &len);
+    line = read_config_read_octet_string(line, &engineID, &engineIDLen);
+    if (!line || sscanf(line, "%lu %lu %lu", &boots, &etime, &stamp) != 3 ||
+        !peername || !len || !engineIDLen) {
+        config_perror("invalid engineIDCacheEntry");
+    } else if ((unsigned long) now > stamp + USM_ENGINEID_CACHE_MAX_AGE ||
+               (unsigned long) now < stamp) {
+        DEBUGMSGTL(("usm:engineIDCache", "dropping stale entry for %s\n",
+                    peername));
+    } else if ((ec = usm_engineid_cache_set(peername, engineID,
+                                            engineIDLen)) != NULL) {
+        ec->boots = boots;
+        ec->time = etime;
+        ec->stamp = stamp;
+    }
+    SNMP_FREE(peername);
+    SNMP_FREE(engineID);
+}
+
+static void
+usm_parse_engineid_cache_conf(const char *token, char *line)
+{
+    int             enabled = netsnmp_ds_parse_boolean(line);
+
+    if (enabled >= 0)
+        engineIDCacheEnabled = enabled;
+}
+
+static void
+usm_release_engineid_cache_conf(void)
+{
+    engineIDCacheEnabled = 0;
+}
+
+static int
+usm_store_engineid_cache(int majorID, int minorID, void *serverarg,
+                         void *clientarg)
+{
+    struct usm_engineid_cache *ec;
+
+    if (!engineIDCacheEnabled || !engineIDCache)
+        return SNMPERR_SUCCESS;
+    for (ec = engineIDCache; ec; ec = ec->next)
+        usm_engineid_cache_refresh(ec);
+    usm_engineid_cache_save();
+    return SNMPERR_SUCCESS;
+}
+
+static int
+usm_free_engineid_cache(int majorID, int minorID, void *serverarg,
+                        void *clientarg)
+{
+    usm_engineid_cache_free();
+    return SNMPERR_SUCCESS;
+}
+
+/*
+ * Called once a remote engine's time has been authenticated: the first
+ * time this happens for a cached engine, save it so that the next run
+ * starts out in the time window.  Applications that never call
+ * snmp_store() would otherwise only ever save the engineID.
+ */
+static void
+usm_engineid_cache_timesync(const u_char *engineID, size_t engineIDLen)
+{
+    struct usm_engineid_cache *ec;
+    int             changed = 0;
+
+    if (!engineIDCacheEnabled)
+        return;
+    for (ec = engineIDCache; ec; ec = ec->next)
+        if (!ec->boots && !ec->time && ec->engineIDLen == engineIDLen &&
+            memcmp(ec->engineID, engineID, engineIDLen) == 0)
+            changed |= usm_engineid_cache_refresh(ec);
+    if (changed)
+        usm_engineid_cache_save();
+}
+
+/*
+ * Sets up a session from the cache instead of probing.  The engine time
+ * is advanced by the time elapsed since it was saved; should the guess
+ * be wrong the agent answers notInTimeWindow, which is retried as usual.
+ */
+static int
+usm_engineid_cache_apply(netsnmp_session *session)
+{
+    struct usm_engineid_cache *ec;
+    time_t          now;
+
+    if (!engineIDCacheEnabled || !session->peername ||
+        session->securityEngineIDLen)
+        return SNMPERR_GENERR;
+    ec = usm_engineid_cache_find(session->peername);
+    if (!ec)
+        return SNMPERR_GENERR;
+
+    session->securityEngineID = netsnmp_memdup(ec->engineID, ec->engineIDLen);
+    if (!session->securityEngineID)
+        return SNMPERR_GENERR;
+    session->securityEngineIDLen = ec->engineIDLen;
+    if (!session->contextEngineIDLen) {
+        session->contextEngineID = netsnmp_memdup(ec->engineID,
+                                                  ec->engineIDLen);
+        if (session->contextEngineID)
+            session->contextEngineIDLen = ec->engineIDLen;
+    }
+    if (ec->boots || ec->time) {
+        now = time(NULL);
+        set_enginetime(ec->engineID, ec->engineIDLen, ec->boots,
+                       ec->time + (u_int) (now > ec->stamp ?
+                                           now - ec->stamp : 0), TRUE);
+    }
+    session->flags |= SNMP_FLAGS_ENGINEID_CACHED;
+
+    DEBUGMSGTL(("usm:engineIDCache", "using cached engineID for %s: ",
+                session->peername));
+    DEBUGMSGHEX(("usm:engineIDCache", ec->engineID, ec->engineIDLen));
+    DEBUGMSG(("usm:engineIDCache", " boots=%u time=%u\n", ec->boots,
+              ec->time));
+    return SNMPERR_SUCCESS;
+}
+
+/*
+ * The agent refused a cached engineID with an unknownEngineID report:
+ * switch the session and the outstanding request over to the engineID
+ * it reported, so that the request can be resent.
+ */
+int
+usm_rediscover_engineid(netsnmp_session *session, netsnmp_pdu *reqpdu,
+                        netsnmp_pdu *report)
+{
+    u_char         *old = session->securityEngineID;
+    size_t          oldLen = session->securityEngineIDLen;
+    u_char         *engineID;
+
+    if (!(session->flags & SNMP_FLAGS_ENGINEID_CACHED) ||
+        !report->securityEngineIDLen ||
+        (report->securityEngineIDLen == oldLen &&
+         memcmp(report->securityEngineID, old, oldLen) == 0))
+        return SNMPERR_GENERR;
+
+    engineID = netsnmp_memdup(report->securityEngineID,
+                              report->securityEngineIDLen);
+    if (!engineID)
+        return SNMPERR_GENERR;
+
+    DEBUGMSGTL(("usm:engineIDCache", "cached engineID for %s is stale\n",
+                session->peername ? session->peername : "(none)"));
+
+    if (session->contextEngineIDLen == oldLen &&
+        memcmp(session->contextEngineID, old, oldLen) == 0) {
+        u_char         *ctx = netsnmp_memdup(engineID,
+                                             report->securityEngineIDLen);
+        if (ctx) {
+            free(session->contextEngineID);
+            session->contextEngineID = ctx;
+            session->contextEngineIDLen = report->securityEngineIDLen;
+        }
+    }
+    /* let the rebuild fill these in from the session again */
+    if (reqpdu->securityEngineIDLen == oldLen &&
+        memcmp(reqpdu->securityEngineID, old, oldLen) == 0) {
+        SNMP_FREE(reqpdu->securityEngineID);
+        reqpdu->securityEngineIDLen = 0;
+    }
+    if (reqpdu->contextEngineIDLen == oldLen &&
+        memcmp(reqpdu->contextEngineID, old, oldLen) == 0) {
+        SNMP_FREE(reqpdu->contextEngineID);
+        reqpdu->contextEngineIDLen = 0;
+    }
+
+    session->securityEngineID = engineID;
+    session->securityEngineIDLen = report->securityEngineIDLen;
+    free(old);
+    session->flags &= ~(SNMP_FLAGS_ENGINEID_CACHED | SNMP_FLAGS_USER_CREATED);
+
+    if (session->peername &&
+        usm_engineid_cache_set(session->peername, engineID,
+                               session->securityEngineIDLen))
+        usm_engineid_cache_save();
+
+    return usm_create_user_from_session(session);
+}
+
 static int usm_discover_engineid(struct session_list *slp,
                                  netsnmp_session *session)
 {
     netsnmp_pdu    *pdu = NULL, *response = NULL;
     int status, i;
 
+    if (usm_engineid_cache_apply(slp->session) == SNMPERR_SUCCESS)
+        return SNMPERR_SUCCESS;
+
     if (usm_build_probe_pdu(&pdu) != 0) {
         DEBUGMSGTL(("snmp_api", "unable to create probe PDU\n"));
         return SNMP_ERR_GENERR;
@@ -3857,6 +4197,12 @@ static int usm_discover_engineid(struct session_list *slp,
                        session->engineBoots, session->engineTime,
                        TRUE);
     }
+
+    if (engineIDCacheEnabled && slp->session->peername &&
+        usm_engineid_cache_set(slp->session->peername,
+                               slp->session->securityEngineID,
+                               slp->session->securityEngineIDLen))
+        usm_engineid_cache_save();
     return SNMPERR_SUCCESS;
 }
 
@@ -4113,19 +4459,13 @@ usm_create_initial_user(const char *name,
 }
 
 /*
- * usm_save_user(): saves a user to the persistent cache 
+ * usm_format_user(): writes a user out in the form read by usm_read_user()
+ * and returns the end of the string.
  */
-static void
-usm_save_user(struct usmUser *user, const char *token, const char *type)
+static char *
+usm_format_user(char *cptr, struct usmUser *user)
 {
-    char            line[4096];
-    char           *cptr;
-
-    memset(line, 0, sizeof(line));
-
-    sprintf(line, "%s %d %d ", token, user->userStatus,
-            user->userStorageType);
-    cptr = &line[strlen(line)]; /* the NULL */
+    cptr += sprintf(cptr, "%d %d ", user->userStatus, user->userStorageType);
     cptr =
         read_config_save_octet_string(cptr, user->engineID,
                                       user->engineIDLen);
@@ -4157,6 +4497,20 @@ usm_save_user(struct usmUser *user, const char *token, const char *type)
     *cptr++ = ' ';
     cptr = read_config_save_octet_string(cptr, user->userPublicString,
                                          user->userPublicStringLen);
+    return cptr;
+}
+
+/*
+ * usm_save_user(): saves a user to the persistent cache 
+ */
+static void
+usm_save_user(struct usmUser *user, const char *token, const char *type)
+{
+    char            line[4096];
+
+    memset(line, 0, sizeof(line));
+
+    usm_format_user(line + sprintf(line, "%s ", token), user);
 
     read_config_store(type, line);
 }
@@ -4902,13 +5256,357 @@ usm_create_usmUser_from_string(char *line, const char **errorMsg)
     return NULL;
 }
 
+/*
+ * Users created by createUser lines are kept in the usmKeys snapshot
+ * (APPTYPE-USM_KEY_SNAPSHOT_FILE in the persistent directory, as snmpd and
+ * snmptrapd share the directory) together with their localized keys, so that the next run does not have to derive the keys
+ * from the pass phrases again, which costs a 1MB hash per key.  An entry
+ * is found by a digest of the createUser line and of everything else the
+ * keys depend on (the default engineID and protocols), salted per file,
+ * and so is only used as long as none of these have changed.
+ */
+struct usm_key_snapshot {
+    u_char         *digest;
+    size_t          digestLen;
+    char           *user;           /* as formatted by usm_format_user() */
+    int             used;
+    struct usm_key_snapshot *next;
+};
+#define USM_KEY_SNAPSHOT_FILE     "usmkeys"
+#define USM_KEY_SNAPSHOT_VERSION  1
+#define USM_KEY_SNAPSHOT_SALT_LEN 16
+
+static struct usm_key_snapshot *keySnapshot = NULL;
+static struct usm_key_snapshot *keySnapshotTail = NULL;
+static struct usm_key_snapshot *keySnapshotNext = NULL; /* search start */
+static u_char   keySnapshotSalt[USM_KEY_SNAPSHOT_SALT_LEN];
+static int      keySnapshotEnabled = 0;
+static int      keySnapshotLoaded = 0;  /* read for this configuration */
+static int      keySnapshotValid = 0;   /* the file has a usable salt */
+static int      keySnapshotChanged = 0;
+
+static void
+usm_key_snapshot_free(void)
+{
+    struct usm_key_snapshot *ks;
+
+    while ((ks = keySnapshot) != NULL) {
+        keySnapshot = ks->next;
+        SNMP_FREE(ks->digest);
+        SNMP_FREE(ks->user);
+        free(ks);
+    }
+    keySnapshotTail = keySnapshotNext = NULL;
+}
+
+static struct usm_key_snapshot *
+usm_key_snapshot_add(const u_char *digest, size_t digestLen,
+                     const char *user)
+{
+    struct usm_key_snapshot *ks = SNMP_MALLOC_STRUCT(usm_key_snapshot);
+
+    if (!ks)
+        return NULL;
+    ks->digest = netsnmp_memdup(digest, digestLen);
+    ks->digestLen = digestLen;
+    ks->user = strdup(user);
+    if (!ks->digest || !ks->user) {
+        SNMP_FREE(ks->digest);
+        SNMP_FREE(ks->user);
+        free(ks);
+        return NULL;
+    }
+    if (keySnapshotTail)
+        keySnapshotTail->next = ks;
+    else
+        keySnapshot = ks;
+    keySnapshotTail = ks;
+    return ks;
+}
+
+/*
+ * Entries are normally looked up in the order they were saved in, so the
+ * search starts after the previous match.
+ */
+static struct usm_key_snapshot *
+usm_key_snapshot_find(const u_char *digest, size_t digestLen)
+{
+    struct usm_key_snapshot *ks, *start = keySnapshotNext;
+
+    for (ks = start; ks; ks = ks->next)
+        if (ks->digestLen == digestLen &&
+            memcmp(ks->digest, digest, digestLen) == 0)
+            goto found;
+    for (ks = keySnapshot; ks != start; ks = ks->next)
+        if (ks->digestLen == digestLen &&
+            memcmp(ks->digest, digest, digestLen) == 0)
+            goto found;
+    return NULL;
+
+  found:
+    keySnapshotNext = ks->next;
+    return ks;
+}
+
+/*
+ * format: usmKeySnapshotVersion VERSION SALT
+ */
+static void
+usm_parse_key_snapshot_version(const char *token, char *line)
+{
+    u_char          buf[USM_KEY_SNAPSHOT_SALT_LEN + 1], *salt = buf;
+    size_t          len = sizeof(buf);
+
+    keySnapshotValid = 0;
+    if (atoi(line) != USM_KEY_SNAPSHOT_VERSION) {
+        DEBUGMSGTL(("usm:keySnapshot", "ignoring snapshot version %s\n",
+                    line));
+        return;
+    }
+    read_config_read_octet_string(skip_token(line), &salt, &len);
+    if (len != USM_KEY_SNAPSHOT_SALT_LEN) {
+        config_perror("invalid usmKeySnapshotVersion");
+        return;
+    }
+    memcpy(keySnapshotSalt, buf, len);
+    keySnapshotValid = 1;
+}
+
+/*
+ * format: usmKeySnapshotEntry DIGEST USER
+ */
+static void
+usm_parse_key_snapshot_entry(const char *token, char *line)
+{
+    u_char         *digest = NULL;
+    size_t          digestLen = 0;
+
+    if (!keySnapshotValid)
+        return;
+    line = read_config_read_octet_string(line, &digest, &digestLen);
+    if (!line || !digestLen)
+        config_perror("invalid usmKeySnapshotEntry");
+    else
+        usm_key_snapshot_add(digest, digestLen, line);
+    SNMP_FREE(digest);
+}
+
+static const char *
+usm_key_snapshot_type(char *type, size_t len)
+{
+    const char     *app = netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID,
+                                                NETSNMP_DS_LIB_APPTYPE);
+
+    snprintf(type, len, "%s-%s", app ? app : "snmp", USM_KEY_SNAPSHOT_FILE);
+    type[len - 1] = '\0';
+    return type;
+}
+
+static int
+usm_key_snapshot_path(char *path, size_t len)
+{
+    char            type[SNMP_MAXBUF_SMALL];
+
+    /*
+     * read_config_store() would write everything to the one file
+     */
+    if (netsnmp_getenv("SNMP_PERSISTENT_FILE") ||
+        netsnmp_ds_get_boolean(NETSNMP_DS_LIBRARY_ID,
+                               NETSNMP_DS_LIB_DONT_PERSIST_STATE) ||
+        netsnmp_ds_get_boolean(NETSNMP_DS_LIBRARY_ID,
+                               NETSNMP_DS_LIB_DISABLE_PERSISTENT_LOAD))
+        return 0;
+    snprintf(path, len, "%s/%s.conf", get_persistent_directory(),
+             usm_key_snapshot_type(type, sizeof(type)));
+    path[len - 1] = '\0';
+    return 1;
+}
+
+/*
+ * Reads the snapshot, the first time a createUser line is met while the
+ * configuration is read with usmKeySnapshot enabled.  It is not a registered configuration type, so
+ * that it is read exactly this once.
+ */
+static void
+usm_key_snapshot_load(void)
+{
+    struct config_line handlers[2];
+    char            path[SNMP_MAXPATH];
+    size_t          len = sizeof(keySnapshotSalt);
+
+    keySnapshotLoaded = 1;
+    if (usm_key_snapshot_path(path, sizeof(path))) {
+        memset(handlers, 0, sizeof(handlers));
+        handlers[0].config_token = NETSNMP_REMOVE_CONST(char *,
+                                                "usmKeySnapshotVersion");
+        handlers[0].parse_line = usm_parse_key_snapshot_version;
+        handlers[0].config_time = NORMAL_CONFIG;
+        handlers[0].next = &handlers[1];
+        handlers[1].config_token = NETSNMP_REMOVE_CONST(char *,
+                                                "usmKeySnapshotEntry");
+        handlers[1].parse_line = usm_parse_key_snapshot_entry;
+        handlers[1].config_time = NORMAL_CONFIG;
+        read_config(path, handlers, EITHER_CONFIG);
+    }
+    keySnapshotNext = keySnapshot;
+    DEBUGMSGTL(("usm:keySnapshot", "loaded %d\n", keySnapshotValid));
+
+    if (!keySnapshotValid) {
+        usm_key_snapshot_free();
+        if (sc_random(keySnapshotSalt, &len) != SNMPERR_SUCCESS ||
+            len != sizeof(keySnapshotSalt))
+            return;
+        keySnapshotValid = 1;
+        keySnapshotChanged = 1;
+    }
+}
+
+/*
+ * Digest of everything a createUser line's keys are derived from.
+ */
+static int
+usm_key_snapshot_digest(const char *line, u_char *digest,
+                        size_t *digestLen)
+{
+    const oid      *auth, *priv;
+    size_t          authLen, privLen, engineIDLen, len;
+    u_char         *engineID, *buf, *cp;
+    int             rc;
+
+    if (!keySnapshotEnabled)
+        return SNMPERR_GENERR;
+    if (!keySnapshotLoaded)
+        usm_key_snapshot_load();
+    if (!keySnapshotValid)
+        return SNMPERR_GENERR;
+
+    engineID = snmpv3_generate_engineID(&engineIDLen);
+    auth = get_default_authtype(&authLen);
+    priv = get_default_privtype(&privLen);
+    len = sizeof(keySnapshotSalt) + strlen(line) + 1 + engineIDLen +
+        (authLen + privLen) * sizeof(oid);
+    buf = cp = (u_char *) malloc(len);
+    if (!buf) {
+        SNMP_FREE(engineID);
+        return SNMPERR_GENERR;
+    }
+    memcpy(cp, keySnapshotSalt, sizeof(keySnapshotSalt));
+    cp += sizeof(keySnapshotSalt);
+    memcpy(cp, line, strlen(line) + 1);
+    cp += strlen(line) + 1;
+    if (engineIDLen)
+        memcpy(cp, engineID, engineIDLen);
+    cp += engineIDLen;
+    memcpy(cp, auth, authLen * sizeof(oid));
+    cp += authLen * sizeof(oid);
+    memcpy(cp, priv, privLen * sizeof(oid));
+
+    rc = sc_hash(usmHMACSHA1AuthProtocol,
+                 OID_LENGTH(usmHMACSHA1AuthProtocol), buf, len,
+                 digest, digestLen);
+    memset(buf, 0, len);        /* it holds the pass phrases */
+    free(buf);
+    SNMP_FREE(engineID);
+    return rc;
+}
+
+/*
+ * Once the configuration has been read, saves the entries that were used
+ * if anything changed.  Entries not used this time are dropped.  The file
+ * is left alone while usmKeySnapshot is disabled.
+ */
+static int
+usm_store_key_snapshot(int majorID, int minorID, void *serverarg,
+                       void *clientarg)
+{
+    struct usm_key_snapshot *ks;
+    char            line[4096 + 64], type[SNMP_MAXBUF_SMALL];
+    char           *cptr;
+
+    if (!keySnapshotLoaded)
+        return SNMPERR_SUCCESS;
+
+    for (ks = keySnapshot; ks; ks = ks->next)
+        if (!ks->used)
+            keySnapshotChanged = 1;
+
+    if (keySnapshotEnabled && keySnapshotChanged && keySnapshotValid) {
+        usm_key_snapshot_type(type, sizeof(type));
+        snmp_save_persistent(type);
+        cptr = line + sprintf(line, "usmKeySnapshotVersion %d ",
+                              USM_KEY_SNAPSHOT_VERSION);
+        read_config_save_octet_string(cptr, keySnapshotSalt,
+                                      sizeof(keySnapshotSalt));
+        read_config_store(type, line);
+        for (ks = keySnapshot; ks; ks = ks->next) {
+            if (!ks->used || strlen(ks->user) + 2 * ks->digestLen + 32 >
+                sizeof(line))
+                continue;
+            cptr = line + sprintf(line, "usmKeySnapshotEntry ");
+            cptr = read_config_save_octet_string(cptr, ks->digest,
+                                                 ks->digestLen);
+            sprintf(cptr, " %s", ks->user);
+            read_config_store(type, line);
+        }
+        snmp_clean_persistent(type);
+        DEBUGMSGTL(("usm:keySnapshot", "saved\n"));
+    }
+
+    usm_key_snapshot_free();
+    memset(keySnapshotSalt, 0, sizeof(keySnapshotSalt));
+    keySnapshotLoaded = keySnapshotValid = keySnapshotChanged = 0;
+    return SNMPERR_SUCCESS;
+}
+
+static void
+usm_parse_key_snapshot_conf(const char *token, char *line)
+{
+    int             enabled = netsnmp_ds_parse_boolean(line);
+
+    if (enabled >= 0)
+        keySnapshotEnabled = enabled;
+}
+
+static void
+usm_release_key_snapshot_conf(void)
+{
+    keySnapshotEnabled = 0;
+}
+
 void
 usm_parse_create_usmUser(const char *token, char *line)
 {
     const char *error = NULL;
-    usm_create_usmUser_from_string(line, &error);
+    struct usm_key_snapshot *ks = NULL;
+    struct usmUser *user;
+    u_char          digest[SNMP_MAXBUF_SMALL];
+    size_t          digestLen = sizeof(digest);
+    char            buf[4096];
+
+    if (usm_key_snapshot_digest(line, digest, &digestLen) != SNMPERR_SUCCESS)
+        digestLen = 0;
+    else if ((ks = usm_key_snapshot_find(digest, digestLen)) != NULL &&
+             (user = usm_read_user(ks->user)) != NULL) {
+        DEBUGMSGTL(("usm:keySnapshot", "reusing keys for %s\n",
+                    user->secName));
+        ks->used = 1;
+        usm_add_user(user);
+        return;
+    }
+
+    user = usm_create_usmUser_from_string(line, &error);
     if (error)
         config_perror(error);
+    else if (user && digestLen &&
+             !(user->flags & USMUSER_FLAG_KEEP_MASTER_KEY)) {
+        /* the master keys would not be saved */
+        memset(buf, 0, sizeof(buf));
+        usm_format_user(buf, user);
+        if ((ks = usm_key_snapshot_add(digest, digestLen, buf)) != NULL) {
+            ks->used = 1;
+            keySnapshotChanged = 1;
+        }
+    }
 }
 
 static void
@@ -4964,11 +5662,18 @@ init_usm_conf(const char *app)
                                   usm_parse_create_usmUser, NULL,
                                   "username [-e ENGINEID] (MD5|SHA|SHA-512|SHA-384|SHA-256|SHA-224|default) authpassphrase [(DES|AES|default) [privpassphrase]]");
 
+    register_config_handler(app, "usmKeySnapshot",
+                            usm_parse_key_snapshot_conf,
+                            usm_release_key_snapshot_conf, "yes|no");
+
     /*
      * we need to be called back later
      */
     snmp_register_callback(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_STORE_DATA,
                            usm_store_users, NULL);
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_POST_READ_CONFIG,
+                           usm_store_key_snapshot, NULL);
 }
 
 /*
@@ -5108,6 +5813,17 @@ init_usm(void)
                            SNMP_CALLBACK_SHUTDOWN,
                            free_enginetime_on_shutdown, NULL);
 
+    register_config_handler("snmp", "engineIDCache",
+                            usm_parse_engineid_cache_conf,
+                            usm_release_engineid_cache_conf, "yes|no");
+    register_config_handler(USM_ENGINEID_CACHE_FILE, "engineIDCacheEntry",
+                            usm_parse_engineid_cache_entry,
+                            usm_engineid_cache_free, NULL);
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_STORE_DATA,
+                           usm_store_engineid_cache, NULL);
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_SHUTDOWN,
+                           usm_free_engineid_cache, NULL);
+
 
     type = netsnmp_ds_get_string(NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_APPTYPE);
 
@@ -5130,4 +5846,5 @@ shutdown_usm(void)
 {
     free_etimelist();
     clear_user_list();
+    usm_key_snapshot_free();
 }
@@ -106,7 +106,7 @@ typedef struct bio_cache_s {
    BIO *write_bio; /* OpenSSL will write its outgoing SSL packets to here */
    netsnmp_sockaddr_storage sas;
    u_int flags;
-   struct bio_cache_s *next;
+   struct bio_cache_s *next;  /* next entry in the same hash bucket */
    int msgnum;
    char *write_cache;
    size_t write_cache_len;
@@ -118,7 +118,35 @@ typedef struct bio_cache_s {
 #define NETSNMP_BIO_CONNECTED          0x0002 /* received decoded data */
 #define NETSNMP_BIO_DISCONNECTED       0x0004 /* peer shutdown */
 
-static bio_cache *biocache = NULL;
+/*
+ * Connections are indexed by remote address so that finding the state
+ * for an incoming datagram doesn't depend on the number of peers.
+ */
+#define BIO_CACHE_HASH_SIZE 256 /* must be a power of two */
+static bio_cache *biocache[BIO_CACHE_HASH_SIZE];
+
+/*
+ * Client side: the (D)TLS sessions of closed connections, by remote
+ * address, so that a later connection to the same peer can resume the
+ * session instead of performing a full handshake.
+ */
+typedef struct dtls_client_session_s {
+   netsnmp_sockaddr_storage sas;
+   char *our_identity;
+   char *their_identity;
+   SSL_SESSION *session;
+   struct dtls_client_session_s *next;
+} dtls_client_session;
+
+static dtls_client_session *client_sessions[BIO_CACHE_HASH_SIZE];
+
+/*
+ * Server side: one context shared by all incoming connections, which
+ * holds the session cache used for resumption.  It is rebuilt after the
+ * configuration (and thus the certificates) is reread.
+ */
+static SSL_CTX *dtls_server_ctx = NULL;
+static const unsigned char dtls_session_id_context[] = "netsnmp-dtlsudp";
 
 static int openssl_addr_index = 0;
 
@@ -129,37 +157,63 @@ static int netsnmp_dtls_verify_cookie(SSL *ssl,
 static int netsnmp_dtls_gen_cookie(SSL *ssl, unsigned char *cookie,
                                    unsigned int *cookie_len);
 
-/* this stores remote connections in a list to search through */
-/* XXX: optimize for searching */
+static unsigned int
+_bio_cache_hash(const netsnmp_sockaddr_storage *addr)
+{
+    const u_char *cp = NULL;
+    unsigned int hash = 2166136261U, len = 0, i;
+
+    if (addr->sa.sa_family == AF_INET) {
+        cp = (const u_char *) &addr->sin.sin_addr;
+        len = sizeof(addr->sin.sin_addr);
+        hash = (hash ^ addr->sin.sin_port) * 16777619U;
+    }
+#ifdef NETSNMP_TRANSPORT_UDPIPV6_DOMAIN
+    else if (addr->sa.sa_family == AF_INET6) {
+        cp = (const u_char *) &addr->sin6.sin6_addr;
+        len = sizeof(addr->sin6.sin6_addr);
+        hash = (hash ^ addr->sin6.sin6_port) * 16777619U;
+    }
+#endif
+    for (i = 0; i < len; i++)
+        hash = (hash ^ cp[i]) * 16777619U;
+
+    return hash & (BIO_CACHE_HASH_SIZE - 1);
+}
+
+static int
+_bio_cache_addr_equal(const netsnmp_sockaddr_storage *a,
+                      const netsnmp_sockaddr_storage *b)
+{
+    if (a->sa.sa_family != b->sa.sa_family)
+        return 0;
+
+    if (b->sa.sa_family == AF_INET)
+        return a->sin.sin_addr.s_addr == b->sin.sin_addr.s_addr &&
+            a->sin.sin_port == b->sin.sin_port;
+#ifdef NETSNMP_TRANSPORT_UDPIPV6_DOMAIN
+    if (b->sa.sa_family == AF_INET6)
+        return a->sin6.sin6_port == b->sin6.sin6_port &&
+            a->sin6.sin6_scope_id == b->sin6.sin6_scope_id &&
+            memcmp(a->sin6.sin6_addr.s6_addr, b->sin6.sin6_addr.s6_addr,
+                   sizeof(b->sin6.sin6_addr.s6_addr)) == 0;
+#endif
+    return 1;
+}
+
+/* this stores remote connections in a hash table to search through */
 /* XXX: handle state issues for new connections to reduce DOS issues */
 /*      (TLS should do this, but openssl can't do more than one ctx per sock */
 /* XXX: put a timer on the cache for expirary purposes */
 static bio_cache *find_bio_cache(const netsnmp_sockaddr_storage *from_addr)
 {
     bio_cache *cachep = NULL;
-    
-    for (cachep = biocache; cachep; cachep = cachep->next) {
-
-        if (cachep->sas.sa.sa_family != from_addr->sa.sa_family)
-            continue;
 
-        if ((from_addr->sa.sa_family == AF_INET) &&
-            ((cachep->sas.sin.sin_addr.s_addr !=
-              from_addr->sin.sin_addr.s_addr) ||
-             (cachep->sas.sin.sin_port != from_addr->sin.sin_port)))
-                continue;
-#ifdef NETSNMP_TRANSPORT_UDPIPV6_DOMAIN
-        else if ((from_addr->sa.sa_family == AF_INET6) &&
-                 ((cachep->sas.sin6.sin6_port != from_addr->sin6.sin6_port) ||
-                  (cachep->sas.sin6.sin6_scope_id !=
-                   from_addr->sin6.sin6_scope_id) ||
-                  (memcmp(cachep->sas.sin6.sin6_addr.s6_addr,
-                          from_addr->sin6.sin6_addr.s6_addr,
-                          sizeof(from_addr->sin6.sin6_addr.s6_addr)) != 0)))
-            continue;
-#endif
-        /* found an existing connection */
-        break;
+    for (cachep = biocache[_bio_cache_hash(from_addr)]; cachep;
+         cachep = cachep->next) {
+        if (_bio_cache_addr_equal(&cachep->sas, from_addr))
+            /* found an existing connection */
+            break;
     }
     return cachep;
 }
@@ -168,28 +222,176 @@ static bio_cache *find_bio_cache(const netsnmp_sockaddr_storage *from_addr)
    removing it. */
 static int remove_bio_cache(bio_cache *thiscache)
 {
-    bio_cache *cachep = NULL, *prevcache = NULL;
-
-    cachep = biocache;
-    while (cachep) {
-        if (cachep == thiscache) {
-
-            /* remove it from the list */
-            if (NULL == prevcache) {
-                /* at the first cache in the list */
-                biocache = thiscache->next;
-            } else {
-                prevcache->next = thiscache->next;
-            }
+    bio_cache **cachepp;
 
+    for (cachepp = &biocache[_bio_cache_hash(&thiscache->sas)]; *cachepp;
+         cachepp = &(*cachepp)->next) {
+        if (*cachepp == thiscache) {
+            /* remove it from the hash chain */
+            *cachepp = thiscache->next;
             return SNMPERR_SUCCESS;
         }
-        prevcache = cachep;
-        cachep = cachep->next;
     }
     return SNMPERR_GENERR;
 }
 
+static int
+_dtls_identity_equal(const char *a, const char *b)
+{
+    if (a == NULL || b == NULL)
+        return a == b;
+    return strcmp(a, b) == 0;
+}
+
+static void
+_dtls_client_session_free(dtls_client_session *sessp)
+{
+    if (sessp->session)
+        SSL_SESSION_free(sessp->session);
+    SNMP_FREE(sessp->our_identity);
+    SNMP_FREE(sessp->their_identity);
+    free(sessp);
+}
+
+/*
+ * Returns a resumable session for a new client connection to remote_addr
+ * with the given identities, or NULL.  Expired sessions are dropped.
+ */
+static SSL_SESSION *
+_dtls_client_session_find(const netsnmp_sockaddr_storage *remote_addr,
+                          const _netsnmpTLSBaseData *tlsdata)
+{
+    dtls_client_session **sesspp, *sessp;
+    long now = (long) time(NULL);
+
+    sesspp = &client_sessions[_bio_cache_hash(remote_addr)];
+    while ((sessp = *sesspp) != NULL) {
+        if (SSL_SESSION_get_time(sessp->session) +
+            SSL_SESSION_get_timeout(sessp->session) < now) {
+            DEBUGMSGTL(("dtlsudp:resume", "expiring cached session\n"));
+            *sesspp = sessp->next;
+            _dtls_client_session_free(sessp);
+            continue;
+        }
+        if (_bio_cache_addr_equal(&sessp->sas, remote_addr) &&
+            _dtls_identity_equal(sessp->our_identity,
+                                 tlsdata->our_identity) &&
+            _dtls_identity_equal(sessp->their_identity,
+                                 tlsdata->their_identity))
+            return sessp->session;
+        sesspp = &sessp->next;
+    }
+    return NULL;
+}
+
+/*
+ * Remembers the session of an established client connection so that the
+ * next connection to the same peer can resume it.
+ */
+static void
+_dtls_client_session_save(bio_cache *cachep)
+{
+    dtls_client_session **sesspp, *sessp;
+    _netsnmpTLSBaseData *tlsdata = cachep->tlsdata;
+    SSL_SESSION *session;
+
+    if (!tlsdata || !tlsdata->ssl ||
+        !(tlsdata->flags & NETSNMP_TLSBASE_IS_CLIENT) ||
+        !(tlsdata->flags & NETSNMP_TLSBASE_CERT_FP_VERIFIED))
+        return;
+
+    session = SSL_get1_session(tlsdata->ssl);
+    if (!session)
+        return;
+
+    sesspp = &client_sessions[_bio_cache_hash(&cachep->sas)];
+    for (sessp = *sesspp; sessp; sessp = sessp->next) {
+        if (_bio_cache_addr_equal(&sessp->sas, &cachep->sas) &&
+            _dtls_identity_equal(sessp->our_identity,
+                                 tlsdata->our_identity) &&
+            _dtls_identity_equal(sessp->their_identity,
+                                 tlsdata->their_identity))
+            break;
+    }
+
+    if (!sessp) {
+        sessp = SNMP_MALLOC_TYPEDEF(dtls_client_session);
+        if (!sessp) {
+            SSL_SESSION_free(session);
+            return;
+        }
+        memcpy(&sessp->sas, &cachep->sas, sizeof(sessp->sas));
+        if (tlsdata->our_identity)
+            sessp->our_identity = strdup(tlsdata->our_identity);
+        if (tlsdata->their_identity)
+            sessp->their_identity = strdup(tlsdata->their_identity);
+        sessp->next = *sesspp;
+        *sesspp = sessp;
+    } else if (sessp->session) {
+        SSL_SESSION_free(sessp->session);
+    }
+    sessp->session = session;
+    DEBUGMSGTL(("dtlsudp:resume", "saved session for later resumption\n"));
+}
+
+/*
+ * Returns the shared server context, creating it if needed.
+ */
+static SSL_CTX *
+_dtls_get_server_ctx(void)
+{
+    if (dtls_server_ctx)
+        return dtls_server_ctx;
+
+    dtls_server_ctx = sslctx_server_setup(DTLS_method());
+    if (!dtls_server_ctx)
+        return NULL;
+
+    /* turn on cookie exchange */
+    /* Set DTLS cookie generation and verification callbacks */
+    SSL_CTX_set_cookie_generate_cb(dtls_server_ctx, netsnmp_dtls_gen_cookie);
+    SSL_CTX_set_cookie_verify_cb(dtls_server_ctx, netsnmp_dtls_verify_cookie);
+
+    /*
+     * allow clients to resume earlier sessions by id, but not by ticket:
+     * a session restored from a ticket has lost the client's certificate
+     * chain, and certSecName mappings by CA fingerprint need it
+     */
+    SSL_CTX_set_session_cache_mode(dtls_server_ctx, SSL_SESS_CACHE_SERVER);
+    SSL_CTX_set_options(dtls_server_ctx, SSL_OP_NO_TICKET);
+    SSL_CTX_set_session_id_context(dtls_server_ctx, dtls_session_id_context,
+                                   sizeof(dtls_session_id_context) - 1);
+
+    return dtls_server_ctx;
+}
+
+/*
+ * Drops the shared server context and the saved client sessions; called
+ * when the configuration is reread and at shutdown.
+ */
+static int
+_dtls_release_contexts(int majorID, int minorID, void *serverarg,
+                       void *clientarg)
+{
+    dtls_client_session *sessp;
+    int i;
+
+    DEBUGMSGTL(("dtlsudp:resume", "releasing shared contexts\n"));
+    /* connections still using it hold their own reference */
+    if (dtls_server_ctx) {
+        SSL_CTX_free(dtls_server_ctx);
+        dtls_server_ctx = NULL;
+    }
+
+    for (i = 0; i < BIO_CACHE_HASH_SIZE; i++) {
+        while ((sessp = client_sessions[i]) != NULL) {
+            client_sessions[i] = sessp->next;
+            _dtls_client_session_free(sessp);
+        }
+    }
+    return SNMPERR_SUCCESS;
+}
+
 /* frees the contents of a bio_cache */
 static void free_bio_cache(bio_cache *cachep)
 {
@@ -291,8 +493,6 @@ start_new_cached_connection(netsnmp_transport *t,
     }
     
     DEBUGMSGTL(("dtlsudp", "starting a new connection\n"));
-    cachep->next = biocache;
-    biocache = cachep;
 
     if (remote_addr->sa.sa_family == AF_INET)
         memcpy(&cachep->sas.sin, &remote_addr->sin, sizeof(remote_addr->sin));
@@ -303,6 +503,12 @@ start_new_cached_connection(netsnmp_transport *t,
     else
         DIEHERE("unknown address family");
 
+    {
+        unsigned int bucket = _bio_cache_hash(&cachep->sas);
+        cachep->next = biocache[bucket];
+        biocache[bucket] = cachep;
+    }
+
     /* create caching memory bios for OpenSSL to read and write to */
 
     cachep->read_bio = BIO_new(BIO_s_mem()); /* openssl reads from */
@@ -324,12 +530,21 @@ start_new_cached_connection(netsnmp_transport *t,
         DEBUGMSGTL(("dtlsudp",
                     "starting a new connection as a client to sock: %d\n",
                     t->sock));
-        tlsdata->ssl = SSL_new(sslctx_client_setup(DTLS_method(), tlsdata));
-
-        /* XXX: session setting 735 */
+        tlsdata->ssl_context = sslctx_client_setup(DTLS_method(), tlsdata);
+        if (tlsdata->ssl_context)
+            tlsdata->ssl = SSL_new(tlsdata->ssl_context);
+
+        /* offer the session of an earlier connection to this peer */
+        if (tlsdata->ssl) {
+            SSL_SESSION *session =
+                _dtls_client_session_find(remote_addr, tlsdata);
+            if (session && SSL_set_session(tlsdata->ssl, session) == 1)
+                DEBUGMSGTL(("dtlsudp:resume",
+                            "attempting to resume an earlier session\n"));
+        }
     } else {
         /* we're the server */
-        SSL_CTX *ctx = sslctx_server_setup(DTLS_method());
+        SSL_CTX *ctx = _dtls_get_server_ctx();
         if (!ctx) {
             BIO_free(cachep->read_bio);
             BIO_free(cachep->write_bio);
@@ -338,11 +553,6 @@ start_new_cached_connection(netsnmp_transport *t,
             DIEHERE("failed to create the SSL Context");
         }
 
-        /* turn on cookie exchange */
-        /* Set DTLS cookie generation and verification callbacks */
-        SSL_CTX_set_cookie_generate_cb(ctx, netsnmp_dtls_gen_cookie);
-        SSL_CTX_set_cookie_verify_cb(ctx, netsnmp_dtls_verify_cookie);
-
         tlsdata->ssl = SSL_new(ctx);
     }
 
@@ -852,6 +1062,12 @@ netsnmp_dtlsudp_recv(netsnmp_transport *t, void *buf, int size,
 
     if ((0 == rc) && (SSL_get_shutdown(tlsdata->ssl) & SSL_RECEIVED_SHUTDOWN)) {
         DEBUGMSGTL(("dtlsudp", "peer disconnected\n"));
+        /*
+         * the peer closed cleanly; say so, or freeing the connection
+         * drops its session from the cache and it can't be resumed.
+         */
+        SSL_set_shutdown(tlsdata->ssl,
+                         SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
         cachep->flags |= NETSNMP_BIO_DISCONNECTED;
         remove_and_free_bio_cache(cachep);
         SNMP_FREE(tmStateRef);
@@ -966,7 +1182,10 @@ netsnmp_dtlsudp_recv(netsnmp_transport *t, void *buf, int size,
                 }
             }
             tlsdata->flags |= NETSNMP_TLSBASE_CERT_FP_VERIFIED;
-            DEBUGMSGTL(("dtlsudp", "Verified the server's certificate\n"));
+            DEBUGMSGTL(("dtlsudp", "Verified the server's certificate%s\n",
+                        SSL_session_reused(tlsdata->ssl) ?
+                        " (resumed session)" : ""));
+            _dtls_client_session_save(cachep);
         } else {
 #ifndef NETSNMP_NO_LISTEN_SUPPORT
             /* verify that the client's certificate is the correct one */
@@ -991,7 +1210,9 @@ netsnmp_dtlsudp_recv(netsnmp_transport *t, void *buf, int size,
                 }
             }
             tlsdata->flags |= NETSNMP_TLSBASE_CERT_FP_VERIFIED;
-            DEBUGMSGTL(("dtlsudp", "Verified the client's certificate\n"));
+            DEBUGMSGTL(("dtlsudp", "Verified the client's certificate%s\n",
+                        SSL_session_reused(tlsdata->ssl) ?
+                        " (resumed session)" : ""));
 #else /* NETSNMP_NO_LISTEN_SUPPORT */
             return NULL;
 #endif /* NETSNMP_NO_LISTEN_SUPPORT */
@@ -1382,6 +1603,9 @@ netsnmp_dtlsudp_close(netsnmp_transport *t)
     */
     if (NULL != cachep->tlsdata && NULL != cachep->tlsdata->ssl) {
 
+        /* keep the (possibly renewed) session for the next connection */
+        _dtls_client_session_save(cachep);
+
         DEBUGMSGTL(("dtlsudp:close", "closing SSL socket\n"));
         SSL_shutdown(cachep->tlsdata->ssl);
 
@@ -1683,6 +1907,12 @@ netsnmp_dtlsudp_ctor(void)
                                  NULL, NULL, NULL);
 
     netsnmp_tdomain_register(&dtlsudpDomain);
+
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY,
+                           SNMP_CALLBACK_PRE_READ_CONFIG,
+                           _dtls_release_contexts, NULL);
+    snmp_register_callback(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_SHUTDOWN,
+                           _dtls_release_contexts, NULL);
 }
 
 /*
@@ -397,6 +397,7 @@ netsnmp_tlsbase_extract_security_name(SSL *ssl, _netsnmpTLSBaseData *tlsdata) {
     netsnmp_container  *chain_maps;
     netsnmp_cert_map   *cert_map, *peer_cert;
     netsnmp_iterator  *itr;
+    char               *chain_fp;
     int                 rc;
 
     netsnmp_assert_or_return(ssl != NULL, SNMPERR_GENERR);
@@ -404,11 +405,24 @@ netsnmp_tlsbase_extract_security_name(SSL *ssl, _netsnmpTLSBaseData *tlsdata) {
 
     if (NULL == (chain_maps = netsnmp_openssl_get_cert_chain(ssl)))
         return SNMPERR_GENERR;
+
+    /*
+     * a peer presenting a chain we've already mapped gets the same name
+     */
+    chain_fp = netsnmp_cert_chain_fingerprint(chain_maps);
+    tlsdata->securityName = netsnmp_cert_secname_cache_find(chain_fp);
+    if (tlsdata->securityName) {
+        free(chain_fp);
+        netsnmp_cert_map_container_free(chain_maps);
+        return SNMPERR_SUCCESS;
+    }
+
     /*
      * map fingerprints to mapping entries
      */
     rc = netsnmp_cert_get_secname_maps(chain_maps);
     if ((-1 == rc) || (CONTAINER_SIZE(chain_maps) == 0)) {
+        free(chain_fp);
         netsnmp_cert_map_container_free(chain_maps);
         return SNMPERR_GENERR;
     }
@@ -421,6 +435,7 @@ netsnmp_tlsbase_extract_security_name(SSL *ssl, _netsnmpTLSBaseData *tlsdata) {
     itr = CONTAINER_ITERATOR(chain_maps);
     if (NULL == itr) {
         snmp_log(LOG_ERR, "could not get iterator for secname fingerprints\n");
+        free(chain_fp);
         netsnmp_cert_map_container_free(chain_maps);
         return SNMPERR_GENERR;
     }
@@ -431,7 +446,11 @@ netsnmp_tlsbase_extract_security_name(SSL *ssl, _netsnmpTLSBaseData *tlsdata) {
     ITERATOR_RELEASE(itr);
 
     netsnmp_cert_map_container_free(chain_maps);
-       
+
+    if (tlsdata->securityName)
+        netsnmp_cert_secname_cache_add(chain_fp, tlsdata->securityName);
+    free(chain_fp);
+
     return (tlsdata->securityName ? SNMPERR_SUCCESS : SNMPERR_GENERR);
 }
 
@@ -596,9 +615,18 @@ sslctx_client_setup(const SSL_METHOD *method, _netsnmpTLSBaseData *tlsbase) {
         LOGANDDIE("client public and private keys incompatible");
 
     while (id_cert->issuer_cert) {
+        X509 *chain_cert;
+
         id_cert = id_cert->issuer_cert;
-        if (!SSL_CTX_add_extra_chain_cert(the_ctx, id_cert->ocert))
+        /*
+         * the context takes ownership of extra chain certificates, but
+         * ocert belongs to the certificate cache, so hand it a copy.
+         */
+        chain_cert = X509_dup(id_cert->ocert);
+        if (!chain_cert || !SSL_CTX_add_extra_chain_cert(the_ctx, chain_cert)) {
+            X509_free(chain_cert);
             LOGANDDIE("failed to add intermediate client certificate");
+        }
     }
 
     if (tlsbase->their_identity)
@@ -662,9 +690,18 @@ sslctx_server_setup(const SSL_METHOD *method) {
         LOGANDDIE("server public and private keys incompatible");
 
     while (id_cert->issuer_cert) {
+        X509 *chain_cert;
+
         id_cert = id_cert->issuer_cert;
-        if (!SSL_CTX_add_extra_chain_cert(the_ctx, id_cert->ocert))
+        /*
+         * the context takes ownership of extra chain certificates, but
+         * ocert belongs to the certificate cache, so hand it a copy.
+         */
+        chain_cert = X509_dup(id_cert->ocert);
+        if (!chain_cert || !SSL_CTX_add_extra_chain_cert(the_ctx, chain_cert)) {
+            X509_free(chain_cert);
             LOGANDDIE("failed to add intermediate server certificate");
+        }
     }
 
     SSL_CTX_set_read_ahead(the_ctx, 1); /* XXX: DTLS only? */
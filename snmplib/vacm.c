@@ -67,6 +67,36 @@ static struct vacm_viewEntry *viewList = NULL, *viewScanPtr = NULL;
 static struct vacm_accessEntry *accessList = NULL, *accessScanPtr = NULL;
 static struct vacm_groupEntry *groupList = NULL, *groupScanPtr = NULL;
 
+/*
+ * Bumped whenever view, group or access entries are added or removed (or
+ * modified in place, see vacm_mark_changed()), so that derived lookup
+ * structures know when they are stale.
+ */
+static u_int    vacm_generation = 1;
+
+/*
+ * The views in viewList, compiled into one OID tree per view name for
+ * VACM_MODE_FIND lookups.  A sub-identifier that is wildcarded by the
+ * view mask is stored as a wildcard branch, so a lookup only visits the
+ * subtrees that can possibly match instead of every entry of the view.
+ */
+typedef struct vacm_view_node_s {
+    oid             subid;
+    struct vacm_view_node_s *children;  /* sorted by subid */
+    size_t          children_len;
+    struct vacm_view_node_s *wildcard;
+    struct vacm_viewEntry *entry;       /* best entry ending here */
+} vacm_view_node;
+
+typedef struct vacm_view_index_s {
+    char            viewName[VACMSTRINGLEN];
+    vacm_view_node  root;
+    struct vacm_view_index_s *next;
+} vacm_view_index;
+
+static vacm_view_index *viewIndex = NULL;
+static u_int    viewIndexGeneration = 0;
+
 /*
  * Macro to extend view masks with 1 bits when shorter than subtree lengths
  * REF: vacmViewTreeFamilyMask [RFC3415], snmpNotifyFilterMask [RFC3413]
@@ -838,6 +868,7 @@ vacm_createGroupEntry(int securityModel, const char *securityName)
     struct vacm_groupEntry *gp, *lg, *og;
     int             cmp, glen;
 
+    vacm_mark_changed();
     glen = (int) strlen(securityName);
     if (glen < 0 || glen > VACM_MAX_STRING)
         return NULL;
@@ -885,6 +916,7 @@ vacm_destroyGroupEntry(int securityModel, const char *securityName)
 {
     struct vacm_groupEntry *vp, *lastvp = NULL;
 
+    vacm_mark_changed();
     if (groupList && groupList->securityModel == securityModel
         && !strcmp(groupList->securityName + 1, securityName)) {
         vp = groupList;
@@ -911,6 +943,8 @@ void
 vacm_destroyAllGroupEntries(void)
 {
     struct vacm_groupEntry *gp;
+
+    vacm_mark_changed();
     while ((gp = groupList)) {
         groupList = gp->next;
         if (gp->reserved)
@@ -1020,6 +1054,7 @@ vacm_createAccessEntry(const char *groupName,
     struct vacm_accessEntry *vp, *lp, *op = NULL;
     int             cmp, glen, clen;
 
+    vacm_mark_changed();
     glen = (int) strlen(groupName);
     if (glen < 0 || glen > VACM_MAX_STRING)
         return NULL;
@@ -1085,6 +1120,7 @@ vacm_destroyAccessEntry(const char *groupName,
 {
     struct vacm_accessEntry *vp, *lastvp = NULL;
 
+    vacm_mark_changed();
     if (accessList && accessList->securityModel == securityModel
         && accessList->securityLevel == securityLevel
         && !strcmp(accessList->groupName + 1, groupName)
@@ -1114,6 +1150,8 @@ void
 vacm_destroyAllAccessEntries(void)
 {
     struct vacm_accessEntry *ap;
+
+    vacm_mark_changed();
     while ((ap = accessList)) {
         accessList = ap->next;
         if (ap->reserved)
@@ -1155,6 +1193,197 @@ vacm_is_configured(void)
     return 1;
 }
 
+/*
+ * Must be called after changing the subtree or mask of an existing view
+ * entry in place; adding or removing entries is noticed automatically.
+ */
+void
+vacm_mark_changed(void)
+{
+    if (++vacm_generation == 0)
+        vacm_generation = 1;
+}
+
+u_int
+vacm_get_generation(void)
+{
+    return vacm_generation;
+}
+
+/*
+ * returns non-zero if candidate should be preferred to current, using
+ * the same rules as netsnmp_view_get()
+ */
+static int
+_view_entry_better(struct vacm_viewEntry *candidate,
+                   struct vacm_viewEntry *current)
+{
+    return current == NULL
+        || candidate->viewSubtreeLen > current->viewSubtreeLen
+        || (candidate->viewSubtreeLen == current->viewSubtreeLen
+            && snmp_oid_compare(candidate->viewSubtree + 1,
+                                candidate->viewSubtreeLen - 1,
+                                current->viewSubtree + 1,
+                                current->viewSubtreeLen - 1) > 0);
+}
+
+static void
+_view_node_free(vacm_view_node *node)
+{
+    size_t          i;
+
+    for (i = 0; i < node->children_len; i++)
+        _view_node_free(&node->children[i]);
+    free(node->children);
+    if (node->wildcard) {
+        _view_node_free(node->wildcard);
+        free(node->wildcard);
+    }
+}
+
+static void
+_view_index_free(void)
+{
+    vacm_view_index *vi;
+
+    while ((vi = viewIndex) != NULL) {
+        viewIndex = vi->next;
+        _view_node_free(&vi->root);
+        free(vi);
+    }
+    viewIndexGeneration = 0;
+}
+
+/*
+ * returns the child of node for subid, creating it if needed
+ */
+static vacm_view_node *
+_view_node_child(vacm_view_node *node, oid subid)
+{
+    vacm_view_node *tmp;
+    size_t          lo = 0, hi = node->children_len, mid;
+
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (node->children[mid].subid == subid)
+            return &node->children[mid];
+        if (node->children[mid].subid < subid)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    tmp = (vacm_view_node *) realloc(node->children,
+                                     (node->children_len + 1) *
+                                     sizeof(vacm_view_node));
+    if (tmp == NULL)
+        return NULL;
+    node->children = tmp;
+    memmove(&node->children[lo + 1], &node->children[lo],
+            (node->children_len - lo) * sizeof(vacm_view_node));
+    node->children_len++;
+    memset(&node->children[lo], 0, sizeof(vacm_view_node));
+    node->children[lo].subid = subid;
+    return &node->children[lo];
+}
+
+static int
+_view_node_add(vacm_view_node *root, struct vacm_viewEntry *vp)
+{
+    vacm_view_node *node = root;
+    int             mask = 0x80;
+    unsigned int    oidpos, maskpos = 0;
+
+    for (oidpos = 0; node && oidpos < vp->viewSubtreeLen - 1; oidpos++) {
+        if (VIEW_MASK(vp, maskpos, mask) != 0) {
+            node = _view_node_child(node, vp->viewSubtree[oidpos + 1]);
+        } else {
+            if (node->wildcard == NULL)
+                node->wildcard = SNMP_MALLOC_TYPEDEF(vacm_view_node);
+            node = node->wildcard;
+        }
+        if (mask == 1) {
+            mask = 0x80;
+            maskpos++;
+        } else
+            mask >>= 1;
+    }
+    if (node == NULL)
+        return -1;
+    if (_view_entry_better(vp, node->entry))
+        node->entry = vp;
+    return 0;
+}
+
+/*
+ * (re)compiles viewList into viewIndex if it changed since last time.
+ * Returns 0 on success.
+ */
+static int
+_view_index_update(void)
+{
+    struct vacm_viewEntry *vp;
+    vacm_view_index *vi = NULL, **vipp = &viewIndex;
+
+    if (viewIndexGeneration == vacm_generation)
+        return 0;
+
+    _view_index_free();
+    DEBUGMSGTL(("vacm:viewIndex", "compiling views\n"));
+
+    /* viewList is sorted by view name */
+    for (vp = viewList; vp; vp = vp->next) {
+        if (vi == NULL ||
+            memcmp(vi->viewName, vp->viewName, vp->viewName[0] + 1) != 0) {
+            vi = SNMP_MALLOC_TYPEDEF(vacm_view_index);
+            if (vi == NULL)
+                goto fail;
+            memcpy(vi->viewName, vp->viewName, sizeof(vi->viewName));
+            *vipp = vi;
+            vipp = &vi->next;
+        }
+        if (_view_node_add(&vi->root, vp) != 0)
+            goto fail;
+    }
+
+    viewIndexGeneration = vacm_generation;
+    return 0;
+
+  fail:
+    snmp_log(LOG_ERR, "vacm: could not compile views\n");
+    _view_index_free();
+    return -1;
+}
+
+static void
+_view_node_find(vacm_view_node *node, const oid *name, size_t namelen,
+                size_t depth, struct vacm_viewEntry **best)
+{
+    size_t          lo, hi, mid;
+
+    if (node->entry && _view_entry_better(node->entry, *best))
+        *best = node->entry;
+    if (depth >= namelen)
+        return;
+
+    lo = 0;
+    hi = node->children_len;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (node->children[mid].subid == name[depth]) {
+            _view_node_find(&node->children[mid], name, namelen,
+                            depth + 1, best);
+            break;
+        }
+        if (node->children[mid].subid < name[depth])
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (node->wildcard)
+        _view_node_find(node->wildcard, name, namelen, depth + 1, best);
+}
+
 /*
  * backwards compatability
  */
@@ -1162,8 +1391,27 @@ struct vacm_viewEntry *
 vacm_getViewEntry(const char *viewName,
                   oid * viewSubtree, size_t viewSubtreeLen, int mode)
 {
-    return netsnmp_view_get( viewList, viewName, viewSubtree, viewSubtreeLen,
-                             mode);
+    struct vacm_viewEntry *vpret = NULL;
+    vacm_view_index *vi;
+    int             glen;
+
+    if (mode != VACM_MODE_FIND || _view_index_update() != 0)
+        return netsnmp_view_get( viewList, viewName, viewSubtree,
+                                 viewSubtreeLen, mode);
+
+    glen = (int) strlen(viewName);
+    if (glen < 0 || glen > VACM_MAX_STRING)
+        return NULL;
+    for (vi = viewIndex; vi; vi = vi->next) {
+        if (vi->viewName[0] == glen &&
+            memcmp(vi->viewName + 1, viewName, glen) == 0) {
+            _view_node_find(&vi->root, viewSubtree, viewSubtreeLen, 0,
+                            &vpret);
+            break;
+        }
+    }
+    DEBUGMSGTL(("vacm:getView", ", %s\n", (vpret) ? "found" : "none"));
+    return vpret;
 }
 
 int
@@ -1178,6 +1426,7 @@ struct vacm_viewEntry *
 vacm_createViewEntry(const char *viewName,
                      oid * viewSubtree, size_t viewSubtreeLen)
 {
+    vacm_mark_changed();
     return netsnmp_view_create( &viewList, viewName, viewSubtree,
                                 viewSubtreeLen);
 }
@@ -1186,12 +1435,15 @@ void
 vacm_destroyViewEntry(const char *viewName,
                       oid * viewSubtree, size_t viewSubtreeLen)
 {
+    vacm_mark_changed();
     netsnmp_view_destroy( &viewList, viewName, viewSubtree, viewSubtreeLen);
 }
 
 void
 vacm_destroyAllViewEntries(void)
 {
+    vacm_mark_changed();
+    _view_index_free();
     netsnmp_view_clear( &viewList );
 }
 
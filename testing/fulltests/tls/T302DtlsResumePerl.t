@@ -0,0 +1,51 @@
+#!/usr/bin/perl
+
+# HEADER Perl DTLS/UDP session resumption test
+
+use NetSNMPTest;
+use Test;
+use SNMP;
+
+my $test = new NetSNMPTest(agentaddress => "dtlsudp:localhost:9876");
+
+$test->require_feature("NETSNMP_TRANSPORT_DTLSUDP_DOMAIN");
+
+my $netsnmpcert = "$ENV{'srcdir'}/local/net-snmp-cert -I -C $test->{'dir'}";
+
+# the client is only known through the CA that signed its certificate
+system("$netsnmpcert gencert -I -t snmpd > /dev/null 2>&1");
+system("$netsnmpcert genca -I --cn ca-net-snmp.org > /dev/null 2>&1");
+system("$netsnmpcert gencert -I -t perl --with-ca ca-net-snmp.org --san email:perl\@test.net-snmp.org --email perl\@test.net-snmp.org > /dev/null 2>&1");
+
+my $cafp = `$netsnmpcert showcas --fingerprint --brief ca-net-snmp.org`;
+chomp($cafp);
+print "# using CA fp: $cafp\n";
+
+plan(tests => 5);
+$test->config_agent("syscontact itworked");
+$test->config_agent("rwuser -s tsm perl\@test.net-snmp.org");
+$test->config_agent("[snmp] trustCert $cafp");
+$test->config_agent("certSecName 100 $cafp --rfc822");
+
+$test->DIE("failed to start the agent") if (!$test->start_agent(" -Ddtlsudp,tsm,cert:map"));
+
+######################################################################
+# every session is a new connection; the second one resumes the session
+# of the first, and the agent must still map it through the CA
+foreach my $round (1, 2) {
+    my $session = new SNMP::Session(DestHost => $test->{'agentaddress'},
+				    TheirIdentity => 'snmpd',
+				    OurIdentity => 'perl');
+
+    ok(ref($session), 'SNMP::Session', "created session $round");
+    if (ref($session) eq 'SNMP::Session') {
+	my $value = $session->get('sysContact.0');
+	ok($value, 'itworked');
+    }
+}
+
+ok($test->wait_for($test->{'snmpd.log'}, 'resumed session', 2), 1);
+
+######################################################################
+# cleanup
+$test->stop_agent();
@@ -0,0 +1,98 @@
+/* HEADER Testing compiled VACM view lookups */
+
+static const char test_name[] = "vacm-view-lookup-test";
+static oid      system_oid[] = { 1, 3, 6, 1, 2, 1, 1 };
+static oid      if_oid[] = { 1, 3, 6, 1, 2, 1, 2, 2, 1, 0, 3 };
+static oid      if_excl_oid[] = { 1, 3, 6, 1, 2, 1, 2, 2, 1, 0, 5 };
+static oid      mib2_oid[] = { 1, 3, 6, 1, 2, 1 };
+static oid      probes[][12] = {
+    { 1, 3, 6, 1, 2, 1, 1, 1, 0 },
+    { 1, 3, 6, 1, 2, 1, 2, 2, 1, 2, 3 },
+    { 1, 3, 6, 1, 2, 1, 2, 2, 1, 7, 3 },
+    { 1, 3, 6, 1, 2, 1, 2, 2, 1, 7, 5 },
+    { 1, 3, 6, 1, 2, 1, 2, 2, 1, 7, 4 },
+    { 1, 3, 6, 1, 2, 1, 4 },
+    { 1, 3, 6, 1, 4, 1 },
+    { 1, 3 },
+};
+static size_t   probe_len[] = { 9, 11, 11, 11, 11, 7, 6, 2 };
+struct vacm_viewEntry *vp, *list = NULL, *lp;
+int             i;
+u_int           gen;
+
+init_snmp(test_name);
+
+/*
+ * "all" includes mib-2 and excludes the ifTable row for ifIndex 5 in
+ * every column; "if" includes every column of the row for ifIndex 3.
+ */
+vp = vacm_createViewEntry("all", mib2_oid, OID_LENGTH(mib2_oid));
+vp->viewType = SNMP_VIEW_INCLUDED;
+vp = vacm_createViewEntry("all", if_excl_oid, OID_LENGTH(if_excl_oid));
+vp->viewType = SNMP_VIEW_EXCLUDED;
+vp->viewMask[0] = 0xff;
+vp->viewMask[1] = 0xa0;    /* ignore the column */
+vp->viewMaskLen = 2;
+vp = vacm_createViewEntry("if", if_oid, OID_LENGTH(if_oid));
+vp->viewType = SNMP_VIEW_INCLUDED;
+vp->viewMask[0] = 0xff;
+vp->viewMask[1] = 0xa0;
+vp->viewMaskLen = 2;
+vp = vacm_createViewEntry("sys", system_oid, OID_LENGTH(system_oid));
+vp->viewType = SNMP_VIEW_INCLUDED;
+
+/* the same views as a private list, looked up by a linear scan */
+for (vacm_scanViewInit(); (vp = vacm_scanViewNext()) != NULL; ) {
+    lp = malloc(sizeof(*lp));
+    memcpy(lp, vp, sizeof(*lp));
+    lp->next = list;
+    list = lp;
+}
+
+for (i = 0; i < sizeof(probe_len) / sizeof(probe_len[0]); i++) {
+    const char *views[] = { "all", "if", "sys", "none" };
+    int j;
+
+    for (j = 0; j < sizeof(views) / sizeof(views[0]); j++) {
+        struct vacm_viewEntry *found, *expected;
+
+        found = vacm_getViewEntry(views[j], probes[i], probe_len[i],
+                                  VACM_MODE_FIND);
+        expected = netsnmp_view_get(list, views[j], probes[i], probe_len[i],
+                                    VACM_MODE_FIND);
+        OKF((found == NULL) == (expected == NULL) &&
+            (found == NULL ||
+             (found->viewType == expected->viewType &&
+              snmp_oid_compare(found->viewSubtree, found->viewSubtreeLen,
+                               expected->viewSubtree,
+                               expected->viewSubtreeLen) == 0)),
+            ("view %s, probe %d: %s", views[j], i,
+             expected ? (expected->viewType == SNMP_VIEW_INCLUDED ?
+                         "included" : "excluded") : "no match"));
+    }
+}
+
+/* changing a mask in place is picked up after vacm_mark_changed() */
+gen = vacm_get_generation();
+vp = vacm_getViewEntry("if", if_oid, OID_LENGTH(if_oid), VACM_MODE_FIND);
+OKF(vp != NULL, ("found the if view entry"));
+vp->viewMaskLen = 0;       /* now matches only column 0 */
+vacm_mark_changed();
+OKF(gen != vacm_get_generation(), ("generation changed"));
+OKF(vacm_getViewEntry("if", probes[1], probe_len[1], VACM_MODE_FIND) == NULL,
+    ("column 2 no longer in the if view"));
+
+vp = vacm_getViewEntry("sys", system_oid, OID_LENGTH(system_oid),
+                       VACM_MODE_FIND);
+OKF(vp != NULL, ("found the sys view entry"));
+/* takes the subtree in the stored, length prefixed form */
+vacm_destroyViewEntry("sys", vp->viewSubtree, vp->viewSubtreeLen);
+OKF(vacm_getViewEntry("sys", probes[0], probe_len[0], VACM_MODE_FIND) == NULL,
+    ("destroyed view no longer matches"));
+
+while ((lp = list) != NULL) {
+    list = lp->next;
+    free(lp);
+}
+vacm_destroyAllViewEntries();
+snmp_shutdown(test_name);
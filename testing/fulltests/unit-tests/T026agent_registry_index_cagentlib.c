@@ -0,0 +1,73 @@
+/* HEADER Testing indexed subtree lookups against a walk of the list */
+
+static oid      base[] = { 1, 3, 6, 1, 3, 328 };   /* experimental.328 */
+netsnmp_handler_registration *regs[64];
+oid             name[9];
+int             i, j, mismatches;
+netsnmp_subtree *found;
+
+init_snmp("snmp");
+
+memcpy(name, base, sizeof(base));
+for (i = 0; i < 64; i++) {
+    name[6] = 2 * i + 1;
+    regs[i] = netsnmp_create_handler_registration("experimental.328", NULL,
+                                                  name, 7, HANDLER_CAN_RONLY);
+    if (netsnmp_register_instance(regs[i]) != MIB_REGISTERED_OK)
+        regs[i] = NULL;
+}
+OK(regs[0] && regs[63], "registered the instances");
+
+/* and drop every third one again, so that the lists get rejoined */
+for (i = 0; i < 64; i += 3) {
+    if (regs[i])
+        netsnmp_unregister_handler(regs[i]);
+    regs[i] = NULL;
+}
+
+for (j = 0, mismatches = 0; j < 3 * 130; j++) {
+    netsnmp_subtree *p1, *p2, *n1, *n2, *f1, *f2;
+    size_t len = 6 + j % 3;
+
+    name[6] = j / 3;
+    name[7] = 0;
+    name[8] = j;
+
+    netsnmp_set_lookup_cache_size(0);
+    p1 = netsnmp_subtree_find_prev(name, len, NULL, "");
+    n1 = netsnmp_subtree_find_next(name, len, NULL, "");
+    f1 = netsnmp_subtree_find(name, len, NULL, "");
+
+    netsnmp_set_lookup_cache_size(-1);
+    p2 = netsnmp_subtree_find_prev(name, len, NULL, "");
+    n2 = netsnmp_subtree_find_next(name, len, NULL, "");
+    f2 = netsnmp_subtree_find(name, len, NULL, "");
+
+    if (p1 != p2 || n1 != n2 || f1 != f2)
+        mismatches++;
+}
+OKF(mismatches == 0, ("indexed and listed lookups agree (%d mismatches)",
+                      mismatches));
+
+/* a registration made while the index is enabled is found at once */
+name[6] = 200;
+regs[0] = netsnmp_create_handler_registration("experimental.328", NULL,
+                                              name, 7, HANDLER_CAN_RONLY);
+OK(netsnmp_register_instance(regs[0]) == MIB_REGISTERED_OK,
+   "late registration");
+netsnmp_set_lookup_cache_size(-1);
+found = netsnmp_subtree_find(name, 7, NULL, "");
+OK(found && found->reginfo &&
+   snmp_oid_compare(found->reginfo->rootoid, found->reginfo->rootoid_len,
+                    name, 7) == 0,
+   "late registration found through the index");
+
+OK(netsnmp_unregister_handler(regs[0]) == SNMPERR_SUCCESS,
+   "late unregistration");
+found = netsnmp_subtree_find(name, 7, NULL, "");
+OK(found == NULL || found->reginfo == NULL ||
+   snmp_oid_compare(found->reginfo->rootoid, found->reginfo->rootoid_len,
+                    name, 7) != 0,
+   "unregistered subtree no longer found");
+
+snmp_shutdown("snmp");
@@ -0,0 +1,44 @@
+/* HEADER Testing recycling of agent sessions and request arrays */
+
+extern int      handle_pdu(netsnmp_agent_session *asp);
+
+static oid      sysUpTime_oid[] = { 1, 3, 6, 1, 2, 1, 1, 3, 0 };
+static oid      sysDescr_oid[] = { 1, 3, 6, 1, 2, 1, 1, 1, 0 };
+u_char          community[] = "public";
+netsnmp_session session;
+netsnmp_agent_session *asp;
+netsnmp_pdu    *pdu;
+u_long          allocs = 0;
+int             i, n, created;
+
+init_snmp("snmp");
+
+snmp_sess_init(&session);
+session.version = SNMP_VERSION_2c;
+session.community = community;
+session.community_len = sizeof(community) - 1;
+
+for (i = 0, created = 0; i < 20; i++) {
+    pdu = snmp_pdu_create(i & 1 ? SNMP_MSG_GETNEXT : SNMP_MSG_GET);
+    pdu->version = SNMP_VERSION_2c;
+    for (n = 0; n < 1 + i % 4; n++) {
+        snmp_add_null_var(pdu, sysUpTime_oid, OID_LENGTH(sysUpTime_oid));
+        snmp_add_null_var(pdu, sysDescr_oid, OID_LENGTH(sysDescr_oid));
+    }
+    asp = init_agent_snmp_session(&session, pdu);
+    snmp_free_pdu(pdu);
+    if (asp) {
+        created++;
+        handle_pdu(asp);
+        free_agent_snmp_session(asp);
+    }
+    /* by now the largest request array has been seen once */
+    if (i == 3)
+        allocs = netsnmp_get_agent_session_allocs();
+}
+OKF(created == 20, ("created %d agent sessions", created));
+OKF(allocs == netsnmp_get_agent_session_allocs(),
+    ("no allocations after warm-up (%lu, now %lu)", allocs,
+     netsnmp_get_agent_session_allocs()));
+
+snmp_shutdown("snmp");
@@ -0,0 +1,57 @@
+/* HEADER Testing handler call statistics */
+
+static oid      name[] = { 1, 3, 6, 1, 3, 329, 0 };   /* experimental.329 */
+netsnmp_handler_registration *reginfo;
+netsnmp_agent_request_info reqinfo;
+netsnmp_request_info request;
+netsnmp_variable_list var;
+netsnmp_handler_stats *stats;
+u_long          total;
+int             i;
+
+init_snmp("snmp");
+
+/* a registration without a handler routine answers straight away */
+reginfo = netsnmp_create_handler_registration("experimental.329", NULL,
+                                              name, OID_LENGTH(name),
+                                              HANDLER_CAN_RWRITE);
+OK(reginfo != NULL, "created the registration");
+OK(reginfo->stats == NULL, "no statistics before the first call");
+
+memset(&reqinfo, 0, sizeof(reqinfo));
+memset(&request, 0, sizeof(request));
+memset(&var, 0, sizeof(var));
+request.requestvb = &var;
+
+reqinfo.mode = MODE_GET;
+for (i = 0; i < 3; i++)
+    netsnmp_call_handlers(reginfo, &reqinfo, &request);
+reqinfo.mode = MODE_GETNEXT;
+netsnmp_call_handlers(reginfo, &reqinfo, &request);
+reqinfo.mode = MODE_SET_RESERVE1;
+netsnmp_call_handlers(reginfo, &reqinfo, &request);
+reqinfo.mode = MODE_SET_FREE;
+netsnmp_call_handlers(reginfo, &reqinfo, &request);
+
+stats = reginfo->stats;
+OK(stats != NULL, "statistics allocated");
+OKF(stats && stats->calls[NETSNMP_HANDLER_STATS_GET] == 3 &&
+    stats->calls[NETSNMP_HANDLER_STATS_GETNEXT] == 1 &&
+    stats->calls[NETSNMP_HANDLER_STATS_GETBULK] == 0 &&
+    stats->calls[NETSNMP_HANDLER_STATS_SET] == 2,
+    ("calls counted per type of request"));
+
+for (i = 0, total = 0; stats && i < NETSNMP_HANDLER_STATS_BUCKETS; i++)
+    total += stats->buckets[NETSNMP_HANDLER_STATS_GET][i];
+OKF(total == 3, ("every call is in the histogram (%lu)", total));
+
+/* and nothing is collected when disabled */
+netsnmp_ds_set_boolean(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_NO_HANDLER_STATS, 1);
+reqinfo.mode = MODE_GET;
+netsnmp_call_handlers(reginfo, &reqinfo, &request);
+OK(stats && stats->calls[NETSNMP_HANDLER_STATS_GET] == 3,
+   "calls not counted when disabled");
+
+netsnmp_handler_registration_free(reginfo);
+snmp_shutdown("snmp");
@@ -0,0 +1,192 @@
+/* HEADER Testing the btree container against a binary array */
+
+static const char test_name[] = "btree-container-test";
+#define N_ENTRIES 5000
+oid            *oids;
+netsnmp_index  *idx, key, *a, *b;
+netsnmp_container *bt, *ba, *tc, *dup;
+netsnmp_iterator *it;
+netsnmp_void_array *va1, *va2;
+void          **subset;
+oid             probe[2];
+int             i, j, mismatches, seen;
+unsigned int    seed = 1;
+
+init_snmp(test_name);
+
+/* entries 0.0 to 499.9, in a scrambled order */
+oids = calloc(2 * N_ENTRIES, sizeof(oid));
+idx = calloc(N_ENTRIES, sizeof(netsnmp_index));
+for (i = 0; i < N_ENTRIES; i++) {
+    j = (i * 7919) % N_ENTRIES;
+    oids[2 * i] = j / 10;
+    oids[2 * i + 1] = j % 10;
+    idx[i].oids = &oids[2 * i];
+    idx[i].len = 2;
+}
+
+bt = netsnmp_container_find("btree");
+ba = netsnmp_container_get_binary_array();
+OK(bt != NULL && ba != NULL, "created the containers");
+bt->compare = ba->compare = netsnmp_compare_netsnmp_index;
+bt->ncompare = ba->ncompare = netsnmp_ncompare_netsnmp_index;
+
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++)
+    if (CONTAINER_INSERT(bt, &idx[i]) != CONTAINER_INSERT(ba, &idx[i]))
+        mismatches++;
+OKF(mismatches == 0 && CONTAINER_SIZE(bt) == N_ENTRIES,
+    ("inserted %" NETSNMP_PRIz "u entries", CONTAINER_SIZE(bt)));
+OK(CONTAINER_INSERT(bt, &idx[17]) != 0, "duplicate insert refused");
+
+/* remove a pseudo-random third of the entries */
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++) {
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 3 == 0 &&
+        CONTAINER_REMOVE(bt, &idx[i]) != CONTAINER_REMOVE(ba, &idx[i]))
+        mismatches++;
+}
+OKF(mismatches == 0 && CONTAINER_SIZE(bt) == CONTAINER_SIZE(ba),
+    ("removed down to %" NETSNMP_PRIz "u entries", CONTAINER_SIZE(bt)));
+
+/* find and find_next agree for present, missing and partial keys */
+key.oids = probe;
+for (i = 0, mismatches = 0; i <= 501 * 10; i++) {
+    probe[0] = i / 10;
+    probe[1] = i % 10;
+    for (key.len = 1; key.len <= 2; key.len++) {
+        if (CONTAINER_FIND(bt, &key) != CONTAINER_FIND(ba, &key) ||
+            CONTAINER_NEXT(bt, &key) != CONTAINER_NEXT(ba, &key))
+            mismatches++;
+    }
+}
+OKF(mismatches == 0, ("lookups agree (%d mismatches)", mismatches));
+
+/* subsets */
+key.len = 1;
+for (i = 0, mismatches = 0; i <= 500; i += 7) {
+    probe[0] = i;
+    va1 = CONTAINER_GET_SUBSET(bt, &key);
+    va2 = CONTAINER_GET_SUBSET(ba, &key);
+    if ((va1 == NULL) != (va2 == NULL) ||
+        (va1 && (va1->size != va2->size ||
+                 memcmp(va1->array, va2->array,
+                        va1->size * sizeof(void *)) != 0)))
+        mismatches++;
+    if (va1) {
+        free(va1->array);
+        free(va1);
+    }
+    if (va2) {
+        free(va2->array);
+        free(va2);
+    }
+}
+OKF(mismatches == 0, ("subsets agree (%d mismatches)", mismatches));
+
+/* iterating, and removing every other entry through the iterator */
+it = CONTAINER_ITERATOR(bt);
+for (a = ITERATOR_FIRST(it), b = CONTAINER_FIRST(ba), mismatches = 0;
+     a || b; a = ITERATOR_NEXT(it), b = CONTAINER_NEXT(ba, b))
+    if (a != b)
+        mismatches++;
+OKF(mismatches == 0, ("iterator order agrees (%d mismatches)", mismatches));
+for (a = ITERATOR_FIRST(it), seen = 0; a; a = ITERATOR_NEXT(it))
+    if (seen++ % 2 == 0) {
+        ITERATOR_REMOVE(it);
+        CONTAINER_REMOVE(ba, a);
+    }
+ITERATOR_RELEASE(it);
+for (a = CONTAINER_FIRST(bt), b = CONTAINER_FIRST(ba), mismatches = 0;
+     a || b; a = CONTAINER_NEXT(bt, a), b = CONTAINER_NEXT(ba, b))
+    if (a != b)
+        mismatches++;
+OKF(mismatches == 0 && CONTAINER_SIZE(bt) == CONTAINER_SIZE(ba),
+    ("iterator removes agree (%d mismatches)", mismatches));
+
+dup = CONTAINER_DUP(bt, NULL, 0);
+for (a = CONTAINER_FIRST(dup), b = CONTAINER_FIRST(bt), mismatches = 0;
+     a || b; a = CONTAINER_NEXT(dup, a), b = CONTAINER_NEXT(bt, b))
+    if (a != b)
+        mismatches++;
+OKF(dup && mismatches == 0, ("duplicate agrees (%d mismatches)",
+                             mismatches));
+CONTAINER_FREE(dup);
+
+/* emptying the tree shrinks it back to a single leaf */
+while ((a = CONTAINER_FIRST(bt)))
+    CONTAINER_REMOVE(bt, a);
+OK(CONTAINER_SIZE(bt) == 0 && CONTAINER_FIRST(bt) == NULL, "emptied");
+CONTAINER_INSERT(bt, &idx[3]);
+OK(CONTAINER_FIRST(bt) == &idx[3], "reusable after emptying");
+CONTAINER_FREE(bt);
+CONTAINER_FREE(ba);
+
+/* duplicate keys */
+bt = netsnmp_container_find("btree");
+bt->compare = netsnmp_compare_netsnmp_index;
+CONTAINER_SET_OPTIONS(bt, CONTAINER_KEY_ALLOW_DUPLICATES, i);
+for (i = 0; i < 300; i++)
+    CONTAINER_INSERT(bt, &idx[i % 2 ? 0 : 1]);
+OK(CONTAINER_SIZE(bt) == 300, "inserted duplicates");
+a = CONTAINER_NEXT(bt, &idx[0]);
+b = CONTAINER_NEXT(bt, &idx[1]);
+OK((a == &idx[1] && b == NULL) || (b == &idx[0] && a == NULL),
+   "find_next skips duplicates");
+CONTAINER_FREE(bt);
+
+/* a table_container stays an array; a large_table switches to a btree */
+netsnmp_ds_set_int(NETSNMP_DS_LIBRARY_ID,
+                   NETSNMP_DS_LIB_TABLE_BTREE_THRESHOLD, 100);
+tc = netsnmp_container_find("table_container");
+tc->compare = netsnmp_compare_netsnmp_index;
+for (i = 0; i < 1000; i++)
+    CONTAINER_INSERT(tc, &idx[i]);
+OK(tc->get_at != NULL && CONTAINER_SIZE(tc) == 1000,
+   "table_container is still an array");
+CONTAINER_FREE(tc);
+
+tc = netsnmp_container_find("large_table");
+tc->compare = netsnmp_compare_netsnmp_index;
+tc->ncompare = netsnmp_ncompare_netsnmp_index;
+for (i = 0; i < 99; i++)
+    CONTAINER_INSERT(tc, &idx[i]);
+OK(tc->get_at != NULL, "large_table starts as an array");
+for (; i < 1000; i++)
+    CONTAINER_INSERT(tc, &idx[i]);
+OK(tc->get_at == NULL && CONTAINER_SIZE(tc) == 1000,
+   "large_table switched to a btree");
+for (i = 0, mismatches = 0; i < 1000; i++)
+    if (CONTAINER_FIND(tc, &idx[i]) != &idx[i])
+        mismatches++;
+OKF(mismatches == 0, ("entries kept across the switch (%d missing)",
+                      mismatches));
+OK(CONTAINER_GET_AT(tc, 0, (void **)&a) != 0,
+   "positional calls fail after the switch");
+
+/* the exported binary_array functions follow the switch */
+OK(netsnmp_binary_array_options_set(tc, 1,
+                                    CONTAINER_KEY_ALLOW_DUPLICATES) ==
+   CONTAINER_KEY_ALLOW_DUPLICATES, "options set after the switch");
+CONTAINER_INSERT(tc, &idx[5]);
+a = NULL;
+OK(netsnmp_binary_array_remove(tc, &idx[5], (void **)&a) == 0 &&
+   a == &idx[5] && CONTAINER_SIZE(tc) == 1000 &&
+   CONTAINER_FIND(tc, &idx[5]) == &idx[5],
+   "remove after the switch");
+OK(netsnmp_binary_array_remove(tc, &idx[1500], (void **)&a) != 0 &&
+   a == NULL, "remove of a missing entry after the switch");
+key.oids = probe;
+key.len = 1;
+probe[0] = idx[7].oids[0];
+for (i = 0, seen = 0; i < 1000; i++)
+    if (idx[i].oids[0] == probe[0])
+        seen++;
+subset = netsnmp_binary_array_get_subset(tc, &key, &j);
+OKF(subset != NULL && j == seen, ("subset after the switch (%d of %d)",
+                                  subset ? j : 0, seen));
+free(subset);
+netsnmp_binary_array_release(tc);
+
+free(idx);
+free(oids);
+snmp_shutdown(test_name);
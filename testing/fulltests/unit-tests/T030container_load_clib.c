@@ -0,0 +1,74 @@
+/* HEADER Testing bulk loads into binary array containers */
+
+static const char test_name[] = "container-load-test";
+#define N_ENTRIES 2000
+oid            *oids;
+netsnmp_index  *idx, *a, *b;
+netsnmp_container *c, *by_len, *ref;
+int             i, j, mismatches;
+
+init_snmp(test_name);
+
+/* entries 0 to 999, each twice and in a scrambled order */
+oids = calloc(N_ENTRIES, sizeof(oid));
+idx = calloc(N_ENTRIES, sizeof(netsnmp_index));
+for (i = 0; i < N_ENTRIES; i++) {
+    j = (i * 7919) % N_ENTRIES;
+    oids[i] = j / 2;
+    idx[i].oids = &oids[i];
+    idx[i].len = 1;
+}
+
+c = netsnmp_container_get_binary_array();
+ref = netsnmp_container_find("btree");
+c->compare = ref->compare = netsnmp_compare_netsnmp_index;
+c->ncompare = ref->ncompare = netsnmp_ncompare_netsnmp_index;
+
+CONTAINER_LOAD_BEGIN(c);
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++) {
+    if (CONTAINER_INSERT(c, &idx[i]) != 0)
+        mismatches++;
+    CONTAINER_INSERT(ref, &idx[i]);
+}
+OKF(mismatches == 0 && CONTAINER_SIZE(c) == N_ENTRIES,
+    ("appended %" NETSNMP_PRIz "u entries", CONTAINER_SIZE(c)));
+CONTAINER_LOAD_END(c, NULL, NULL);
+OKF(CONTAINER_SIZE(c) == CONTAINER_SIZE(ref),
+    ("duplicates dropped, %" NETSNMP_PRIz "u left", CONTAINER_SIZE(c)));
+
+/* the same entries as inserting one by one, so the first of each key */
+for (a = CONTAINER_FIRST(c), b = CONTAINER_FIRST(ref), mismatches = 0;
+     a || b; a = CONTAINER_NEXT(c, a), b = CONTAINER_NEXT(ref, b))
+    if (a != b)
+        mismatches++;
+OKF(mismatches == 0, ("loaded order agrees (%d mismatches)", mismatches));
+OK(CONTAINER_INSERT(c, &idx[N_ENTRIES / 2]) != 0,
+   "duplicate refused after the load");
+CONTAINER_FREE(c);
+
+/* duplicates dropped by the primary container leave the others too */
+c = netsnmp_container_get_binary_array();
+by_len = netsnmp_container_get_binary_array();
+c->compare = netsnmp_compare_netsnmp_index;
+by_len->compare = netsnmp_compare_netsnmp_index;
+CONTAINER_SET_OPTIONS(by_len, CONTAINER_KEY_ALLOW_DUPLICATES, i);
+netsnmp_container_add_index(c, by_len);
+CONTAINER_LOAD_BEGIN(c);
+for (i = 0; i < N_ENTRIES; i++)
+    CONTAINER_INSERT(c, &idx[i]);
+CONTAINER_LOAD_END(c, NULL, NULL);
+OKF(CONTAINER_SIZE(c) == N_ENTRIES / 2 && CONTAINER_SIZE(by_len) ==
+    N_ENTRIES / 2, ("both containers hold %" NETSNMP_PRIz "u entries",
+                    CONTAINER_SIZE(by_len)));
+for (a = CONTAINER_FIRST(by_len), mismatches = 0; a;
+     a = CONTAINER_NEXT(by_len, a))
+    if (CONTAINER_FIND(c, a) != a)
+        mismatches++;
+OKF(mismatches == 0, ("secondary kept the same entries (%d mismatches)",
+                      mismatches));
+CONTAINER_FREE(c);
+CONTAINER_FREE(ref);
+
+free(idx);
+free(oids);
+snmp_shutdown(test_name);
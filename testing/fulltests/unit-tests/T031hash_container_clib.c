@@ -0,0 +1,140 @@
+/* HEADER Testing the hash container as an additional index */
+
+static const char test_name[] = "hash-container-test";
+#define N_ENTRIES 5000
+oid            *oids;
+netsnmp_index  *idx, key, *a;
+netsnmp_container *primary, *hash, *ht, *dup;
+netsnmp_iterator *it;
+netsnmp_void_array *va1, *va2;
+oid             probe[2];
+int             i, j, mismatches, seen;
+unsigned int    seed = 1;
+
+init_snmp(test_name);
+
+/* entries 0.0 to 499.9, in a scrambled order */
+oids = calloc(2 * N_ENTRIES, sizeof(oid));
+idx = calloc(N_ENTRIES, sizeof(netsnmp_index));
+for (i = 0; i < N_ENTRIES; i++) {
+    j = (i * 7919) % N_ENTRIES;
+    oids[2 * i] = j / 10;
+    oids[2 * i + 1] = j % 10;
+    idx[i].oids = &oids[2 * i];
+    idx[i].len = 2;
+}
+
+primary = netsnmp_container_find("btree");
+hash = netsnmp_container_find("hash");
+OK(primary != NULL && hash != NULL, "created the containers");
+hash->container_name = strdup("hash index");
+hash->ncompare = primary->ncompare = netsnmp_ncompare_netsnmp_index;
+netsnmp_container_add_index(primary, hash);
+
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++)
+    if (CONTAINER_INSERT(primary, &idx[i]) != 0)
+        mismatches++;
+OKF(mismatches == 0 && CONTAINER_SIZE(hash) == N_ENTRIES,
+    ("inserted %" NETSNMP_PRIz "u entries", CONTAINER_SIZE(hash)));
+OK(hash->insert(hash, &idx[17]) != 0, "duplicate insert refused");
+
+/* remove a pseudo-random third of the entries through the chain */
+for (i = 0; i < N_ENTRIES; i++) {
+    seed = seed * 1103515245 + 12345;
+    if ((seed >> 16) % 3 == 0)
+        CONTAINER_REMOVE(primary, &idx[i]);
+}
+OKF(CONTAINER_SIZE(hash) == CONTAINER_SIZE(primary),
+    ("removed down to %" NETSNMP_PRIz "u entries", CONTAINER_SIZE(hash)));
+
+/* exact lookups agree, find_next and get_subset too (if slowly) */
+key.oids = probe;
+key.len = 2;
+for (i = 0, mismatches = 0; i <= 501 * 10; i++) {
+    probe[0] = i / 10;
+    probe[1] = i % 10;
+    if (CONTAINER_FIND(hash, &key) != CONTAINER_FIND(primary, &key) ||
+        CONTAINER_FIND(SUBCONTAINER_FIND(primary, "hash index"), &key) !=
+        CONTAINER_FIND(primary, &key))
+        mismatches++;
+    if (i % 97 == 0 && CONTAINER_NEXT(hash, &key) !=
+        CONTAINER_NEXT(primary, &key))
+        mismatches++;
+}
+OKF(mismatches == 0, ("lookups agree (%d mismatches)", mismatches));
+
+key.len = 1;
+for (i = 0, mismatches = 0; i <= 500; i += 7) {
+    probe[0] = i;
+    va1 = CONTAINER_GET_SUBSET(hash, &key);
+    va2 = CONTAINER_GET_SUBSET(primary, &key);
+    if ((va1 == NULL) != (va2 == NULL) ||
+        (va1 && (va1->size != va2->size ||
+                 memcmp(va1->array, va2->array,
+                        va1->size * sizeof(void *)) != 0)))
+        mismatches++;
+    if (va1) {
+        free(va1->array);
+        free(va1);
+    }
+    if (va2) {
+        free(va2->array);
+        free(va2);
+    }
+}
+OKF(mismatches == 0, ("subsets agree (%d mismatches)", mismatches));
+
+/* iterating visits every entry once; remove every other one through it */
+it = CONTAINER_ITERATOR(hash);
+for (a = ITERATOR_FIRST(it), seen = 0, mismatches = 0; a;
+     a = ITERATOR_NEXT(it), seen++)
+    if (CONTAINER_FIND(primary, a) != a)
+        mismatches++;
+OKF(mismatches == 0 && seen == CONTAINER_SIZE(primary),
+    ("iterated over %d entries", seen));
+for (a = ITERATOR_FIRST(it), seen = 0; a; a = ITERATOR_NEXT(it))
+    if (seen++ % 2 == 0) {
+        ITERATOR_REMOVE(it);
+        primary->remove(primary, a);
+    }
+ITERATOR_RELEASE(it);
+for (a = CONTAINER_FIRST(primary), mismatches = 0; a;
+     a = CONTAINER_NEXT(primary, a))
+    if (CONTAINER_FIND(hash, a) != a)
+        mismatches++;
+OKF(mismatches == 0 && CONTAINER_SIZE(hash) == CONTAINER_SIZE(primary),
+    ("iterator removes agree (%d mismatches)", mismatches));
+
+dup = CONTAINER_DUP(hash, NULL, 0);
+for (a = CONTAINER_FIRST(primary), mismatches = 0; a;
+     a = CONTAINER_NEXT(primary, a))
+    if (CONTAINER_FIND(dup, a) != a)
+        mismatches++;
+OKF(dup && mismatches == 0 && CONTAINER_SIZE(dup) == CONTAINER_SIZE(hash),
+    ("duplicate agrees (%d mismatches)", mismatches));
+CONTAINER_FREE(dup);
+CONTAINER_FREE(primary);
+
+/* duplicate keys, and string keys */
+ht = netsnmp_container_find("hash");
+CONTAINER_SET_OPTIONS(ht, CONTAINER_KEY_ALLOW_DUPLICATES, i);
+for (i = 0; i < 300; i++)
+    CONTAINER_INSERT(ht, &idx[i % 2 ? 0 : 1]);
+OK(CONTAINER_SIZE(ht) == 300, "inserted duplicates");
+for (i = 0; i < 300; i++)
+    CONTAINER_REMOVE(ht, &idx[i % 2 ? 0 : 1]);
+OK(CONTAINER_SIZE(ht) == 0 && CONTAINER_FIRST(ht) == NULL,
+   "removed duplicates");
+CONTAINER_FREE(ht);
+
+ht = netsnmp_container_find("hash");
+ht->compare = netsnmp_compare_direct_cstring;
+CONTAINER_INSERT(ht, "eth0");
+CONTAINER_INSERT(ht, "lo");
+OK(CONTAINER_FIND(ht, "lo") != NULL && CONTAINER_FIND(ht, "eth1") == NULL,
+   "string keys");
+CONTAINER_FREE(ht);
+
+free(idx);
+free(oids);
+snmp_shutdown(test_name);
@@ -0,0 +1,99 @@
+/* HEADER Testing oid_stash lookups against a linear search */
+
+static const char test_name[] = "oid-stash-test";
+#define N_ENTRIES 2000
+#define MAX_LEN   12
+oid             oids[N_ENTRIES][MAX_LEN], probe[MAX_LEN + 1];
+size_t          lens[N_ENTRIES], probe_len;
+int             added[N_ENTRIES];
+netsnmp_oid_stash_node *root = NULL, *node;
+int             i, j, k, best, mismatches, rc;
+unsigned int    seed = 1;
+
+init_snmp(test_name);
+
+/*
+ * OIDs of 1 to MAX_LEN sub-identifiers from a small alphabet, so that
+ * they share prefixes and some are prefixes of others. The same OID may
+ * come up twice: only the first add succeeds.
+ */
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++) {
+    seed = seed * 1103515245 + 12345;
+    lens[i] = 1 + (seed >> 16) % MAX_LEN;
+    for (j = 0; j < lens[i]; j++) {
+        seed = seed * 1103515245 + 12345;
+        oids[i][j] = j < 3 ? 1 + j : (seed >> 16) % (j < 6 ? 3 : 40);
+    }
+    for (k = 0; k < i; k++)
+        if (added[k] && snmp_oid_compare(oids[k], lens[k], oids[i],
+                                         lens[i]) == 0)
+            break;
+    added[i] = (k == i);
+    rc = netsnmp_oid_stash_add_data(&root, oids[i], lens[i], &added[i]);
+    if ((rc == SNMPERR_SUCCESS) != added[i])
+        mismatches++;
+}
+OKF(mismatches == 0, ("added the entries (%d mismatches)", mismatches));
+
+/* every added OID finds its own data */
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++)
+    if (added[i] &&
+        netsnmp_oid_stash_get_data(root, oids[i], lens[i]) != &added[i])
+        mismatches++;
+OKF(mismatches == 0, ("exact lookups (%d mismatches)", mismatches));
+
+/* getnext returns the smallest stored OID greater than the probe */
+for (i = 0, mismatches = 0; i < 3 * N_ENTRIES; i++) {
+    seed = seed * 1103515245 + 12345;
+    k = (seed >> 16) % N_ENTRIES;
+    probe_len = lens[k];
+    memcpy(probe, oids[k], probe_len * sizeof(oid));
+    switch (i % 3) {
+    case 1:                    /* a bit further along */
+        probe[probe_len - 1]++;
+        break;
+    case 2:                    /* somewhere below */
+        probe[probe_len++] = (seed >> 8) % 40;
+        break;
+    }
+    for (j = 0, best = -1; j < N_ENTRIES; j++)
+        if (added[j] &&
+            snmp_oid_compare(oids[j], lens[j], probe, probe_len) > 0 &&
+            (best < 0 || snmp_oid_compare(oids[j], lens[j], oids[best],
+                                          lens[best]) < 0))
+            best = j;
+    if (i % 3 == 0 && netsnmp_oid_stash_get_data(root, probe, probe_len) !=
+        &added[k] && added[k])
+        mismatches++;
+    node = netsnmp_oid_stash_getnext_node(root, probe, probe_len);
+    if (best < 0 ? node != NULL :
+        (node == NULL || node->thedata != &added[best]))
+        mismatches++;
+}
+OKF(mismatches == 0, ("next lookups (%d mismatches)", mismatches));
+
+/* walking with getnext visits each entry once, in order */
+node = netsnmp_oid_stash_getnext_node(root, probe, 0);
+for (j = 0; node && j <= N_ENTRIES; j++) {
+    k = (int *)node->thedata - added;
+    node = netsnmp_oid_stash_getnext_node(root, oids[k], lens[k]);
+}
+for (i = 0, k = 0; i < N_ENTRIES; i++)
+    k += added[i];
+OKF(j == k, ("walked %d of %d entries", j, k));
+
+/* OIDs that were never added have no data */
+for (i = 0, mismatches = 0; i < N_ENTRIES; i++) {
+    if (lens[i] == MAX_LEN)
+        continue;
+    memcpy(probe, oids[i], lens[i] * sizeof(oid));
+    probe[lens[i]] = 40;
+    if (netsnmp_oid_stash_get_data(root, probe, lens[i] + 1) != NULL)
+        mismatches++;
+}
+OKF(mismatches == 0, ("missing lookups (%d mismatches)", mismatches));
+
+netsnmp_oid_stash_free(&root, netsnmp_oid_stash_no_free);
+OK(root == NULL, "freed");
+
+snmp_shutdown(test_name);
@@ -0,0 +1,69 @@
+/* HEADER Testing table_data row lookups */
+
+#define N_ROWS 1000
+netsnmp_table_data *table;
+netsnmp_table_row *rows[N_ROWS], *row, *prev;
+oid             idx[2];
+long            val;
+int             i, j, mismatches;
+/* not declared in table_data.h */
+netsnmp_table_row *netsnmp_table_data_row_next_byoid(netsnmp_table_data *,
+                                                     oid *, size_t);
+
+init_snmp("snmp");
+
+table = netsnmp_create_table_data("test");
+OK(table != NULL, "created the table");
+
+/* rows 0 to 2 * (N_ROWS - 1) step 2, added in a scrambled order */
+for (i = 0, mismatches = 0; i < N_ROWS; i++) {
+    j = (i * 7919) % N_ROWS;
+    val = 2 * j;
+    rows[j] = netsnmp_create_table_data_row();
+    netsnmp_table_row_add_index(rows[j], ASN_INTEGER, &val, sizeof(val));
+    if (netsnmp_table_data_add_row(table, rows[j]) != SNMPERR_SUCCESS)
+        mismatches++;
+}
+OKF(mismatches == 0 && netsnmp_table_data_num_rows(table) == N_ROWS,
+    ("added %d rows", netsnmp_table_data_num_rows(table)));
+
+row = netsnmp_create_table_data_row();
+val = 10;
+netsnmp_table_row_add_index(row, ASN_INTEGER, &val, sizeof(val));
+OK(netsnmp_table_data_add_row(table, row) != SNMPERR_SUCCESS,
+   "duplicate row refused");
+netsnmp_table_data_delete_row(row);
+
+/* remove every third row */
+for (i = 0; i < N_ROWS; i += 3) {
+    netsnmp_table_data_remove_and_delete_row(table, rows[i]);
+    rows[i] = NULL;
+}
+
+/* the list is in order, and linked both ways */
+for (row = table->first_row, prev = NULL, i = 0, mismatches = 0; row;
+     prev = row, row = row->next, i++)
+    if (row->prev != prev ||
+        (prev && snmp_oid_compare(prev->index_oid, prev->index_oid_len,
+                                  row->index_oid, row->index_oid_len) >= 0))
+        mismatches++;
+OKF(mismatches == 0 && table->last_row == prev &&
+    i == netsnmp_table_data_num_rows(table),
+    ("row list in order (%d rows, %d mismatches)", i, mismatches));
+
+/* exact and next lookups, for present and missing indexes */
+for (i = -1, mismatches = 0; i <= 2 * N_ROWS; i++) {
+    idx[0] = i;
+    row = i >= 0 ? netsnmp_table_data_get_from_oid(table, idx, 1) : NULL;
+    if (i >= 0 && row != (i % 2 ? NULL : rows[i / 2]))
+        mismatches++;
+    row = netsnmp_table_data_row_next_byoid(table, idx, i >= 0 ? 1 : 0);
+    for (j = i < 0 ? 0 : i / 2 + 1; j < N_ROWS && !rows[j]; j++)
+        ;
+    if (row != (j < N_ROWS ? rows[j] : NULL))
+        mismatches++;
+}
+OKF(mismatches == 0, ("lookups agree (%d mismatches)", mismatches));
+
+netsnmp_table_data_delete_table(table);
+snmp_shutdown("snmp");
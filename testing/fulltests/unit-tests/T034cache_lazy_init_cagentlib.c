@@ -0,0 +1,47 @@
+/* HEADER Testing deferred cache preloads */
+
+static oid      name[] = { 1, 3, 6, 1, 3, 330 };   /* experimental.330 */
+netsnmp_cache  *cache;
+netsnmp_mib_handler *handler;
+
+init_snmp("snmp");
+netsnmp_init_cache_handler();
+
+/* without lazyInit, a preload once the configuration is read is immediate */
+cache = netsnmp_cache_create(30, NULL, NULL, name, OID_LENGTH(name));
+OK(cache != NULL, "created the cache");
+cache->flags = NETSNMP_CACHE_PRELOAD | NETSNMP_CACHE_AUTO_RELOAD;
+handler = netsnmp_cache_handler_get(cache);
+OK(handler != NULL, "created the handler");
+OK(!(cache->flags & NETSNMP_CACHE_PRELOAD_PENDING), "preload not held back");
+OK(cache->timer_id != 0, "reload timer started");
+netsnmp_handler_free(handler);
+netsnmp_cache_remove(cache);
+netsnmp_cache_free(cache);
+
+/* with lazyInit, the first load is left to a request */
+netsnmp_ds_set_boolean(NETSNMP_DS_APPLICATION_ID,
+                       NETSNMP_DS_AGENT_LAZY_INIT, 1);
+cache = netsnmp_cache_create(30, NULL, NULL, name, OID_LENGTH(name));
+cache->flags = NETSNMP_CACHE_PRELOAD | NETSNMP_CACHE_AUTO_RELOAD;
+handler = netsnmp_cache_handler_get(cache);
+OK(cache->flags & NETSNMP_CACHE_PRELOAD_PENDING, "preload held back");
+OK(cache->timer_id == 0, "reload timer not started yet");
+netsnmp_cache_check_and_reload(cache);
+OK(!(cache->flags & NETSNMP_CACHE_PRELOAD_PENDING),
+   "first load clears the pending preload");
+OK(cache->timer_id != 0, "first load starts the reload timer");
+netsnmp_handler_free(handler);
+netsnmp_cache_remove(cache);
+netsnmp_cache_free(cache);
+
+/* caches that cannot be found again are still loaded straight away */
+cache = netsnmp_cache_create(30, NULL, NULL, NULL, 0);
+cache->flags = NETSNMP_CACHE_PRELOAD;
+handler = netsnmp_cache_handler_get(cache);
+OK(!(cache->flags & NETSNMP_CACHE_PRELOAD_PENDING),
+   "preload of an unlisted cache not held back");
+netsnmp_handler_free(handler);
+netsnmp_cache_free(cache);
+
+snmp_shutdown("snmp");
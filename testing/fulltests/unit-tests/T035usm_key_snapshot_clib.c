@@ -0,0 +1,133 @@
+/* HEADER Testing the USM key snapshot */
+
+static const char test_name[] = "usm-key-snapshot-test";
+static u_char   engineID[] = { 0x80, 0, 0, 0, 1, 2, 3, 4 };
+char            dir[] = "/tmp/usmkeys-XXXXXX";
+char            path[SNMP_MAXPATH], other[SNMP_MAXPATH], line[256], hex[64];
+char            buf[8192];
+struct usmUser *user;
+u_char          authKey[64], authKey2[64];
+size_t          authKeyLen, i, len;
+char           *cp;
+FILE           *f;
+
+OK(mkdtemp(dir) != NULL, "created the persistent directory");
+netsnmp_ds_set_string(NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_PERSISTENT_DIR,
+                      dir);
+snprintf(path, sizeof(path), "%s/%s-usmkeys.conf", dir, test_name);
+init_snmp(test_name);
+init_usm_conf(NULL);
+netsnmp_config(strcpy(line, "usmKeySnapshot yes"));
+
+/* the first time round the keys are derived, and saved */
+usm_parse_create_usmUser("createUser", strcpy(line,
+        "-e 0x8000000001020304 ksuser SHA authpass1 AES privpass1"));
+user = usm_get_user(engineID, sizeof(engineID), "ksuser");
+OK(user != NULL && user->authKeyLen == 20, "created the user");
+authKeyLen = user->authKeyLen;
+memcpy(authKey, user->authKey, authKeyLen);
+snmp_call_callbacks(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_POST_READ_CONFIG,
+                    NULL);
+OK(access(path, F_OK) == 0, "saved the snapshot");
+usm_free_user(usm_remove_user(user));
+
+/*
+ * mark the saved auth key, so that it shows whether the next user gets
+ * its keys from the snapshot
+ */
+for (i = 0, cp = hex; i < authKeyLen; i++)
+    cp += sprintf(cp, "%02x", authKey[i]);
+f = fopen(path, "r");
+len = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+if (f)
+    fclose(f);
+buf[len] = '\0';
+cp = strstr(buf, hex);
+OK(cp != NULL, "the snapshot holds the localized key");
+if (cp) {
+    authKey[0] = (authKey[0] & 0x0f) | (*cp == '0' ? 0x10 : 0);
+    *cp = *cp == '0' ? '1' : '0';
+    f = fopen(path, "w");
+    if (f) {
+        fwrite(buf, 1, len, f);
+        fclose(f);
+    }
+}
+
+usm_parse_create_usmUser("createUser", strcpy(line,
+        "-e 0x8000000001020304 ksuser SHA authpass1 AES privpass1"));
+user = usm_get_user(engineID, sizeof(engineID), "ksuser");
+OK(user != NULL && user->authKeyLen == authKeyLen &&
+   memcmp(user->authKey, authKey, authKeyLen) == 0,
+   "an unchanged line reuses the saved keys");
+snmp_call_callbacks(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_POST_READ_CONFIG,
+                    NULL);
+usm_free_user(usm_remove_user(user));
+
+/* a changed pass phrase is not matched */
+usm_parse_create_usmUser("createUser", strcpy(line,
+        "-e 0x8000000001020304 ksuser SHA authpass2 AES privpass1"));
+user = usm_get_user(engineID, sizeof(engineID), "ksuser");
+OK(user != NULL && memcmp(user->authKey, authKey, authKeyLen) != 0,
+   "a changed line derives new keys");
+memcpy(authKey2, user->authKey, authKeyLen);
+snmp_call_callbacks(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_POST_READ_CONFIG,
+                    NULL);
+usm_free_user(usm_remove_user(user));
+f = fopen(path, "r");
+len = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+if (f)
+    fclose(f);
+buf[len] = '\0';
+for (i = 0, cp = buf; (cp = strstr(cp, "usmKeySnapshotEntry")) != NULL;
+     cp++)
+    i++;
+OK(i == 1, "the entry no longer used was dropped");
+
+/* other applications keep their own snapshot */
+netsnmp_ds_set_string(NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_APPTYPE,
+                      "othertrapd");
+snprintf(other, sizeof(other), "%s/othertrapd-usmkeys.conf", dir);
+usm_parse_create_usmUser("createUser", strcpy(line,
+        "-e 0x8000000001020304 otheruser SHA authpass3"));
+snmp_call_callbacks(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_POST_READ_CONFIG,
+                    NULL);
+user = usm_get_user(engineID, sizeof(engineID), "otheruser");
+if (user)
+    usm_free_user(usm_remove_user(user));
+f = fopen(path, "r");
+len = f ? fread(buf, 1, sizeof(buf) - 1, f) : 0;
+if (f)
+    fclose(f);
+buf[len] = '\0';
+OK(access(other, F_OK) == 0 && strstr(buf, "usmKeySnapshotEntry") != NULL,
+   "another application saved its own snapshot alongside");
+netsnmp_ds_set_string(NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_APPTYPE,
+                      test_name);
+
+/* turning it off neither reads nor removes the snapshot */
+for (i = 0, cp = hex; i < authKeyLen; i++)
+    cp += sprintf(cp, "%02x", authKey2[i]);
+cp = strstr(buf, hex);
+if (cp) {
+    *cp = *cp == '0' ? '1' : '0';
+    f = fopen(path, "w");
+    if (f) {
+        fwrite(buf, 1, len, f);
+        fclose(f);
+    }
+}
+netsnmp_config(strcpy(line, "usmKeySnapshot no"));
+usm_parse_create_usmUser("createUser", strcpy(line,
+        "-e 0x8000000001020304 ksuser SHA authpass2 AES privpass1"));
+user = usm_get_user(engineID, sizeof(engineID), "ksuser");
+OK(cp != NULL && user != NULL &&
+   memcmp(user->authKey, authKey2, authKeyLen) == 0,
+   "a disabled snapshot is not read");
+snmp_call_callbacks(SNMP_CALLBACK_LIBRARY, SNMP_CALLBACK_POST_READ_CONFIG,
+                    NULL);
+OK(access(path, F_OK) == 0, "a disabled snapshot is not removed");
+
+snmp_shutdown(test_name);
+snprintf(path, sizeof(path), "rm -rf %s", dir);
+system(path);
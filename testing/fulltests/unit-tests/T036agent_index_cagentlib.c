@@ -0,0 +1,109 @@
+/* HEADER Testing index allocation */
+
+#include <net-snmp/agent/agent_index.h>
+
+static oid      int_oid[] = { 1, 3, 6, 1, 3, 331, 1 };
+static oid      str_oid[] = { 1, 3, 6, 1, 3, 331, 2 };
+netsnmp_session s1, s2;
+netsnmp_variable_list vb, *res;
+long            val;
+int             i, ok;
+
+init_snmp("snmp");
+
+memset(&vb, 0, sizeof(vb));
+vb.type = ASN_INTEGER;
+snmp_set_var_objid(&vb, int_oid, OID_LENGTH(int_oid));
+
+/* arbitrary values are handed out in order */
+for (i = 1, ok = 1; i <= 2000; i++) {
+    res = register_index(&vb, ALLOCATE_ANY_INDEX, &s1);
+    if (!res || *res->val.integer != i)
+        ok = 0;
+    snmp_free_varbind(res);
+}
+OK(ok, "allocated 2000 arbitrary indexes in order");
+OK(count_indexes(int_oid, OID_LENGTH(int_oid), 0) == 2000,
+   "counted the allocations");
+
+val = 5000;
+snmp_set_var_value(&vb, &val, sizeof(val));
+res = register_index(&vb, ALLOCATE_THIS_INDEX, &s1);
+OK(res && *res->val.integer == 5000, "allocated a given index");
+snmp_free_varbind(res);
+OK(register_index(&vb, ALLOCATE_THIS_INDEX, &s1) == NULL,
+   "a given index cannot be allocated twice");
+res = register_index(&vb, ALLOCATE_NEW_INDEX, &s2);
+OK(res && *res->val.integer == 5001, "a new index follows the last one");
+snmp_free_varbind(res);
+
+/* released indexes are reused by ALLOCATE_ANY_INDEX only */
+val = 7;
+snmp_set_var_value(&vb, &val, sizeof(val));
+OK(unregister_index(&vb, TRUE, &s2) == INDEX_ERR_WRONG_SESSION,
+   "only the owner can release an index");
+OK(unregister_index(&vb, TRUE, &s1) == SNMP_ERR_NOERROR,
+   "released an index");
+OK(count_indexes(int_oid, OID_LENGTH(int_oid), 0) == 2001 &&
+   count_indexes(int_oid, OID_LENGTH(int_oid), 1) == 2002,
+   "the released index is still known");
+res = register_index(&vb, ALLOCATE_NEW_INDEX, &s2);
+OK(res && *res->val.integer == 5002, "a new index does not reuse it");
+snmp_free_varbind(res);
+res = register_index(&vb, ALLOCATE_ANY_INDEX, &s2);
+OK(res && *res->val.integer == 7, "an arbitrary index does");
+snmp_free_varbind(res);
+
+/* closing a session releases just its indexes */
+unregister_index_by_session(&s2);
+OK(count_indexes(int_oid, OID_LENGTH(int_oid), 0) == 2000,
+   "released the indexes of a session");
+res = register_index(&vb, ALLOCATE_ANY_INDEX, &s1);
+OK(res && *res->val.integer == 7, "reused the lowest released index");
+snmp_free_varbind(res);
+val = 5001;
+snmp_set_var_value(&vb, &val, sizeof(val));
+res = register_index(&vb, ALLOCATE_THIS_INDEX, &s1);
+OK(res != NULL, "a released index can be allocated again");
+snmp_free_varbind(res);
+
+/* removing an index forgets it */
+OK(unregister_index(&vb, FALSE, &s1) == SNMP_ERR_NOERROR,
+   "removed an index");
+OK(count_indexes(int_oid, OID_LENGTH(int_oid), 1) == 2002,
+   "the removed index is gone");
+OK(unregister_index(&vb, FALSE, &s1) == INDEX_ERR_NOT_ALLOCATED,
+   "it cannot be removed twice");
+
+/* string indexes, and indexes of the wrong type */
+memset(&vb, 0, sizeof(vb));
+vb.type = ASN_OCTET_STR;
+snmp_set_var_objid(&vb, str_oid, OID_LENGTH(str_oid));
+res = register_index(&vb, ALLOCATE_ANY_INDEX, &s1);
+OK(res && res->val_len == 4 && memcmp(res->val.string, "aaaa", 4) == 0,
+   "the first string index is aaaa");
+snmp_free_varbind(res);
+res = register_index(&vb, ALLOCATE_ANY_INDEX, &s1);
+OK(res && res->val_len == 4 && memcmp(res->val.string, "aaab", 4) == 0,
+   "the next one is aaab");
+snmp_free_varbind(res);
+snmp_set_var_value(&vb, "abc", 3);
+res = register_index(&vb, ALLOCATE_THIS_INDEX, &s1);
+snmp_free_varbind(res);
+snmp_set_var_value(&vb, "abcd", 4);
+res = register_index(&vb, ALLOCATE_THIS_INDEX, &s1);
+OK(res != NULL, "a string index is not taken by its prefix");
+snmp_free_varbind(res);
+OK(count_indexes(str_oid, OID_LENGTH(str_oid), 0) == 4,
+   "counted the string indexes");
+vb.type = ASN_INTEGER;
+OK(register_index(&vb, ALLOCATE_ANY_INDEX, &s1) == NULL,
+   "an index of another type is refused");
+
+unregister_index_by_session(&s1);
+OK(count_indexes(int_oid, OID_LENGTH(int_oid), 0) == 0 &&
+   count_indexes(str_oid, OID_LENGTH(str_oid), 0) == 0,
+   "released everything");
+
+snmp_free_var_internals(&vb);
+snmp_shutdown("snmp");
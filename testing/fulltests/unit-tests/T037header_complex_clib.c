@@ -0,0 +1,62 @@
+/* HEADER Testing header_complex lists with duplicate names */
+
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include "header_complex.h"
+
+struct header_complex_index *list = NULL, *hci, *next;
+static int      data[40];
+oid             name[1];
+size_t          count;
+int             i, sorted;
+
+init_snmp("header-complex-test");
+
+/*
+ * fill the list, then free the front of it, so that the duplicates added
+ * below are likely to reuse those (lower) addresses
+ */
+for (i = 1; i <= 20; i++) {
+    name[0] = i;
+    header_complex_add_data_by_oid(&list, name, 1, &data[i]);
+}
+for (i = 1; i <= 10; i++)
+    header_complex_extract_entry(&list, list);
+
+/* duplicates of the largest name go after each other at the end */
+name[0] = 30;
+for (i = 30; i < 36; i++)
+    header_complex_add_data_by_oid(&list, name, 1, &data[i]);
+name[0] = 25;
+header_complex_add_data_by_oid(&list, name, 1, &data[25]);
+
+count = 0;
+sorted = 1;
+for (hci = list; hci; hci = hci->next) {
+    count++;
+    if (hci->next && (hci->next->prev != hci ||
+                      snmp_oid_compare(hci->name, hci->namelen,
+                                       hci->next->name,
+                                       hci->next->namelen) > 0))
+        sorted = 0;
+}
+OK(count == 17, "every entry is still in the list");
+OK(list && list->index && CONTAINER_SIZE(list->index) == count,
+   "the list and its index agree");
+OK(sorted, "the list is sorted and linked both ways");
+
+for (hci = list, i = 30; hci; hci = hci->next)
+    if (hci->name[0] == 30 && hci->data == &data[i])
+        i++;
+OK(i == 36, "duplicates are kept in insertion order");
+
+name[0] = 25;
+OK(header_complex_get_from_oid(list, name, 1) == &data[25],
+   "an entry added after the duplicates can be found");
+
+for (hci = list; hci; hci = next) {
+    next = hci->next;
+    header_complex_extract_entry(&list, hci);
+}
+OK(list == NULL, "emptied the list");
+
+snmp_shutdown("header-complex-test");
@@ -0,0 +1,137 @@
+/*
+ * HEADER Testing incremental cache changes
+ */
+
+#include <net-snmp/net-snmp-config.h>
+#include <net-snmp/net-snmp-includes.h>
+#include <net-snmp/agent/net-snmp-agent-includes.h>
+#include <net-snmp/library/testing.h>
+
+#include <stdlib.h>
+
+#define ROWS 8
+
+/*
+ * the data the cache is loaded from, and the cached copy of it
+ */
+static int      source[ROWS] = { 0, 10, 20, 30, -1, -1, -1, -1 };
+static int      table[ROWS];
+static int      loads, discards;
+
+struct row_change {
+    int             row;
+    int             value;
+};
+
+static int
+load_table(netsnmp_cache *cache, void *magic)
+{
+    memcpy(table, source, sizeof(table));
+    loads++;
+    return 0;
+}
+
+static void
+free_table(netsnmp_cache *cache, void *magic)
+{
+    memset(table, -1, sizeof(table));
+}
+
+static int
+apply_row(netsnmp_cache *cache, int op, void *data, void *magic)
+{
+    struct row_change *change = (struct row_change *) data;
+    int             rc = 0;
+
+    if (change->row < 0 || change->row >= ROWS)
+        rc = -1;
+    else if (NETSNMP_CACHE_CHANGE_DISCARD == op)
+        discards++;
+    else if (NETSNMP_CACHE_CHANGE_DELETE == op)
+        table[change->row] = -1;
+    else
+        table[change->row] = change->value;
+    free(change);
+    return rc;
+}
+
+static int
+report(netsnmp_cache *cache, int op, int row, int value)
+{
+    struct row_change *change = SNMP_MALLOC_TYPEDEF(struct row_change);
+
+    change->row = row;
+    change->value = value;
+    return netsnmp_cache_report_change(cache, op, change);
+}
+
+int
+main(int argc, char *argv[])
+{
+    netsnmp_cache  *cache;
+    struct row_change unused;
+
+    init_snmp("snmp");
+
+    cache = netsnmp_cache_create(30, load_table, free_table, NULL, 0);
+    OK(cache != NULL, "created the cache");
+    OK(netsnmp_cache_report_change(cache, NETSNMP_CACHE_CHANGE_INSERT,
+                                   &unused) != SNMPERR_SUCCESS,
+       "changes are refused without an apply_change hook");
+    cache->apply_change = apply_row;
+
+    netsnmp_cache_check_and_reload(cache);
+    OK(loads == 1 && memcmp(table, source, sizeof(table)) == 0,
+       "the first use loads the cache");
+
+    /* insert, update and delete are applied in order on the next use */
+    report(cache, NETSNMP_CACHE_CHANGE_INSERT, 5, 50);
+    report(cache, NETSNMP_CACHE_CHANGE_UPDATE, 1, 11);
+    report(cache, NETSNMP_CACHE_CHANGE_DELETE, 2, 0);
+    report(cache, NETSNMP_CACHE_CHANGE_UPDATE, 3, 31);
+    report(cache, NETSNMP_CACHE_CHANGE_UPDATE, 3, 32);
+    OK(table[5] == -1 && table[1] == 10 && table[2] == 20,
+       "reported changes are queued");
+    netsnmp_cache_check_and_reload(cache);
+    OK(loads == 1, "the changes are applied without a reload");
+    OK(table[5] == 50, "a row was inserted");
+    OK(table[1] == 11, "a row was updated");
+    OK(table[2] == -1, "a row was deleted");
+    OK(table[3] == 32, "changes to one row were applied in order");
+    OK(cache->changes == NULL && cache->changes_tail == NULL,
+       "the queue is empty");
+
+    /* a full load makes queued changes redundant */
+    report(cache, NETSNMP_CACHE_CHANGE_INSERT, 6, 60);
+    report(cache, NETSNMP_CACHE_CHANGE_DELETE, 0, 0);
+    cache->expired = 1;
+    netsnmp_cache_check_and_reload(cache);
+    OK(loads == 2, "an expired cache is loaded again");
+    OK(discards == 2, "the queued changes were discarded");
+    OK(memcmp(table, source, sizeof(table)) == 0,
+       "the discarded changes were not applied");
+
+    /* a change that cannot be applied falls back to a full load */
+    report(cache, NETSNMP_CACHE_CHANGE_UPDATE, 1, 12);
+    report(cache, NETSNMP_CACHE_CHANGE_UPDATE, ROWS, 0);
+    report(cache, NETSNMP_CACHE_CHANGE_INSERT, 7, 70);
+    netsnmp_cache_check_and_reload(cache);
+    OK(loads == 3, "a failed change reloads the cache");
+    OK(discards == 3, "the changes after it were discarded");
+    OK(memcmp(table, source, sizeof(table)) == 0,
+       "the cache holds the reloaded data");
+    OK(cache->changes == NULL && cache->changes_tail == NULL,
+       "the queue is empty after the fallback");
+
+    /* changes left over when the cache is freed are released */
+    report(cache, NETSNMP_CACHE_CHANGE_INSERT, 4, 40);
+    netsnmp_cache_free(cache);
+    OK(discards == 4, "freeing the cache discards its queued changes");
+
+    snmp_shutdown("snmp");
+
+    if (__did_plan == 0) {
+        PLAN(__test_counter);
+    }
+    return 0;
+}